@@ -11,11 +11,20 @@
 #include "util/murmur_hash.hh"
 #include "util/probing_hash_table.hh"
 #include "util/scoped.hh"
+#include "util/pcqueue.hh"
 #include "util/stream/chain.hh"
 #include "util/stream/timer.hh"
 #include "util/tokenize_piece.hh"
 
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstring>
 #include <functional>
+#include <limits>
+#include <string>
 
 #include <stdint.h>
 
@@ -65,17 +74,18 @@ const float kProbingMultiplier = 1.5;
 
 typedef util::ProbingHashTable<DedupeEntry, DedupeHash, DedupeEquals> Dedupe;
 
-class Writer {
+// Output is util::stream::Link or Handoff, constructed from position.
+template <class Output> class Writer {
   public:
-    Writer(std::size_t order, const util::stream::ChainPosition &position, void *dedupe_mem, std::size_t dedupe_mem_size)
+    template <class Position> Writer(std::size_t order, const Position &position, std::size_t block_size, void *dedupe_mem, std::size_t dedupe_mem_size, bool special_unigrams = true)
       : block_(position), gram_(block_->Get(), order),
         dedupe_invalid_(order, std::numeric_limits<WordIndex>::max()),
         dedupe_(dedupe_mem, dedupe_mem_size, &dedupe_invalid_[0], DedupeHash(order), DedupeEquals(order)),
         buffer_(new WordIndex[order - 1]),
-        block_size_(position.GetChain().BlockSize()) {
+        block_size_(block_size) {
       dedupe_.Clear();
-      assert(Dedupe::Size(position.GetChain().BlockSize() / position.GetChain().EntrySize(), kProbingMultiplier) == dedupe_mem_size);
-      if (order == 1) {
+      assert(Dedupe::Size(block_size / NGram<BuildingPayload>::TotalSize(order), kProbingMultiplier) == dedupe_mem_size);
+      if (order == 1 && special_unigrams) {
         // Add special words.  AdjustCounts is responsible if order != 1.
         AddUnigramWord(kUNK);
         AddUnigramWord(kBOS);
@@ -134,7 +144,7 @@ class Writer {
       }
     }
 
-    util::stream::Link block_;
+    Output block_;
 
     NGram<BuildingPayload> gram_;
 
@@ -155,15 +165,21 @@ float CorpusCount::DedupeMultiplier(std::size_t order) {
   return kProbingMultiplier * static_cast<float>(sizeof(DedupeEntry)) / static_cast<float>(NGram<BuildingPayload>::TotalSize(order));
 }
 
+float CorpusCount::DedupeMultiplier(std::size_t order, std::size_t threads) {
+  if (threads <= 1) return DedupeMultiplier(order);
+  return static_cast<float>(threads) * (DedupeMultiplier(order) + 1.0) + 1.0;
+}
+
 std::size_t CorpusCount::VocabUsage(std::size_t vocab_estimate) {
   return ngram::GrowableVocab<ngram::WriteUniqueWords>::MemUsage(vocab_estimate);
 }
 
-CorpusCount::CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol)
+CorpusCount::CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol, std::size_t threads)
   : from_(from), vocab_write_(vocab_write), token_count_(token_count), type_count_(type_count),
     prune_words_(prune_words), prune_vocab_filename_(prune_vocab_filename),
+    threads_(threads ? threads : 1),
     dedupe_mem_size_(Dedupe::Size(entries_per_block, kProbingMultiplier)),
-    dedupe_mem_(util::MallocOrThrow(dedupe_mem_size_)),
+    dedupe_mem_(util::MallocOrThrow(dedupe_mem_size_ * threads_)),
     disallowed_symbol_action_(disallowed_symbol) {
 }
 
@@ -180,33 +196,346 @@ namespace {
         UTIL_THROW(FormatLoadException, "Special word " << word << " is not allowed in the corpus.  I plan to support models containing <unk> in the future.  Pass --skip_symbols to convert these symbols to whitespace.");
     }
   }
+
+typedef ngram::GrowableVocab<ngram::WriteUniqueWords> Vocab;
+
+// Stands in for a Link in a counting thread's Writer.  The thread fills
+// blocks of its own, which ParallelCount::Run copies into the chain.
+class Handoff {
+  public:
+    struct Queues {
+      util::PCQueue<util::stream::Block> *empty, *full;
+    };
+
+    explicit Handoff(const Queues &queues) : queues_(queues) {
+      queues_.empty->Consume(current_);
+    }
+
+    util::stream::Block *operator->() { return &current_; }
+
+    Handoff &operator++() {
+      queues_.full->Produce(current_);
+      queues_.empty->Consume(current_);
+      return *this;
+    }
+
+    void Poison() {
+      queues_.full->Produce(util::stream::Block());
+    }
+
+  private:
+    Queues queues_;
+    util::stream::Block current_;
+};
+
+// Lines of the corpus, about kChunkSize bytes of them.
+struct Chunk {
+  explicit Chunk(uint64_t in_sequence) : sequence(in_sequence) {}
+
+  uint64_t sequence;
+  std::string text;
+
+  // Word ids in text, with kEndLine after each line.  Words the thread didn't
+  // know are kNewWord + their index in new_words.
+  std::vector<uint64_t> tokens;
+  std::vector<StringPiece> new_words;
+  std::vector<uint64_t> new_hashes;
+  // Vocabulary ids of new_words.
+  std::vector<WordIndex> new_ids;
+};
+
+const std::size_t kChunkSize = 1 << 20;
+const uint64_t kNewWord = static_cast<uint64_t>(1) << 32;
+const uint64_t kEndLine = std::numeric_limits<uint64_t>::max();
+
+// A counting thread's map from word hash, as in GrowableVocab, to vocabulary
+// id or kNewWord + index.
+struct CachedWord {
+  typedef uint64_t Key;
+  uint64_t key;
+  uint64_t value;
+  uint64_t GetKey() const { return key; }
+  void SetKey(uint64_t to) { key = to; }
+  static CachedWord Make(uint64_t key, uint64_t value) {
+    CachedWord ret;
+    ret.key = key;
+    ret.value = value;
+    return ret;
+  }
+};
+typedef util::AutoProbing<CachedWord, util::IdentityHash> WordCache;
+
+/* Counts with several threads.  One reads the corpus into chunks of lines.
+ * Each counting thread takes a chunk, looks its words up in a cache of its own
+ * and lists the words it hasn't seen.  Then, in chunk order, it looks those up
+ * in the vocabulary, so ids are assigned in order of first appearance as when
+ * counting on one thread.  Last it counts the n-grams into blocks of its own
+ * with a dedupe table of its own.  Run copies the blocks into the chain.
+ *
+ * Blocks are only deduped within a thread, but the sort that follows combines
+ * them anyway, so the counts it outputs are the same.
+ */
+class ParallelCount {
+  public:
+    ParallelCount(util::FilePiece &from, Vocab &vocab, WordIndex end_sentence, WarningAction &disallowed_symbol_action, std::size_t threads, uint8_t *dedupe_mem, std::size_t dedupe_mem_size)
+      : from_(from), vocab_(vocab), end_sentence_(end_sentence), disallowed_symbol_action_(disallowed_symbol_action),
+        threads_(threads), dedupe_mem_(dedupe_mem), dedupe_mem_size_(dedupe_mem_size),
+        chunks_(2 * threads), empty_(threads + 1), full_(threads + 1),
+        linked_(false), next_sequence_(0), failed_(false), token_count_(0) {
+      util::BoolCharacter::Build("\0\t\n\r ", delimiters_);
+    }
+
+    // Like ~Writer, so the caller can finish up first.
+    ~ParallelCount() {
+      if (linked_) out_.Poison();
+    }
+
+    // Returns the number of tokens.
+    uint64_t Run(const util::stream::ChainPosition &position) {
+      order_ = NGram<BuildingPayload>::OrderFromSize(position.GetChain().EntrySize());
+      block_size_ = position.GetChain().BlockSize();
+      util::scoped_malloc blocks(util::MallocOrThrow(block_size_ * (threads_ + 1)));
+      for (std::size_t i = 0; i <= threads_; ++i) {
+        empty_.Produce(util::stream::Block(static_cast<uint8_t*>(blocks.get()) + i * block_size_, block_size_));
+      }
+
+      boost::thread_group workers;
+      workers.create_thread(boost::bind(&ParallelCount::Read, this));
+      for (std::size_t i = 0; i < threads_; ++i) {
+        workers.create_thread(boost::bind(&ParallelCount::Work, this, i));
+      }
+
+      out_.Init(position);
+      linked_ = true;
+      util::stream::Block block;
+      for (std::size_t finished = 0; finished < threads_; ) {
+        full_.Consume(block);
+        if (!block) {
+          ++finished;
+          continue;
+        }
+        if (block.ValidSize()) {
+          memcpy(out_->Get(), block.Get(), block.ValidSize());
+          out_->SetValidSize(block.ValidSize());
+          ++out_;
+        }
+        empty_.Produce(util::stream::Block(block.Get(), block_size_));
+      }
+      workers.join_all();
+
+      if (!disallowed_.empty()) {
+        ComplainDisallowed(disallowed_, disallowed_symbol_action_);
+      }
+      UTIL_THROW_IF(failed_, util::Exception, "Counting failed: " << error_);
+      return token_count_;
+    }
+
+  private:
+    void Read() {
+      try {
+        uint64_t sequence = 0;
+        bool eof = false;
+        while (!eof && !Failed()) {
+          util::scoped_ptr<Chunk> chunk(new Chunk(sequence));
+          chunk->text.reserve(kChunkSize + 1024);
+          try {
+            while (chunk->text.size() < kChunkSize) {
+              StringPiece line(from_.ReadLine());
+              chunk->text.append(line.data(), line.size());
+              chunk->text.push_back('\n');
+            }
+          } catch (const util::EndOfFileException &e) {
+            eof = true;
+          }
+          if (!chunk->text.empty()) {
+            chunks_.Produce(chunk.release());
+            ++sequence;
+          }
+        }
+      } catch (const std::exception &e) {
+        Fail(e.what());
+      }
+      for (std::size_t i = 0; i < threads_; ++i) {
+        chunks_.Produce(NULL);
+      }
+    }
+
+    void Work(std::size_t thread) {
+      Handoff::Queues queues;
+      queues.empty = &empty_;
+      queues.full = &full_;
+      // The first thread adds <unk> and <s> for unigrams.
+      Writer<Handoff> writer(order_, queues, block_size_, dedupe_mem_ + thread * dedupe_mem_size_, dedupe_mem_size_, thread == 0);
+      WordCache cache;
+      uint64_t count = 0;
+      Chunk *chunk;
+      while ((chunk = chunks_.Consume())) {
+        util::scoped_ptr<Chunk> owner(chunk);
+        try {
+          if (!Failed()) Tokenize(*chunk, cache);
+        } catch (const std::exception &e) {
+          Fail(e.what());
+        }
+        if (!AddWords(*chunk)) continue;
+        try {
+          count += Count(*chunk, cache, writer);
+        } catch (const std::exception &e) {
+          Fail(e.what());
+        }
+      }
+      boost::mutex::scoped_lock lock(mutex_);
+      token_count_ += count;
+    }
+
+    void Tokenize(Chunk &chunk, WordCache &cache) const {
+      const char *begin = chunk.text.data(), *const end = begin + chunk.text.size();
+      chunk.tokens.reserve(chunk.text.size() / 4);
+      while (begin != end) {
+        const char *newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+        for (util::TokenIter<util::BoolCharacter, true> w(StringPiece(begin, newline - begin), delimiters_); w; ++w) {
+          uint64_t hash = util::MurmurHashNative(w->data(), w->size());
+          WordCache::MutableIterator it;
+          if (!cache.FindOrInsert(CachedWord::Make(hash, kNewWord + chunk.new_words.size()), it)) {
+            chunk.new_words.push_back(*w);
+            chunk.new_hashes.push_back(hash);
+          }
+          chunk.tokens.push_back(it->value);
+        }
+        chunk.tokens.push_back(kEndLine);
+        begin = newline + 1;
+      }
+    }
+
+    // Waits for the previous chunk.  False if counting failed.
+    bool AddWords(Chunk &chunk) {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (next_sequence_ != chunk.sequence) {
+        turn_.wait(lock);
+      }
+      ++next_sequence_;
+      turn_.notify_all();
+      if (failed_) return false;
+      try {
+        chunk.new_ids.resize(chunk.new_words.size());
+        for (std::size_t i = 0; i < chunk.new_words.size(); ++i) {
+          WordIndex word = vocab_.FindOrInsert(chunk.new_words[i]);
+          if (word <= 2) {
+            if (disallowed_symbol_action_ == THROW_UP) {
+              // Throw from Run.
+              disallowed_ = chunk.new_words[i].as_string();
+              failed_ = true;
+              return false;
+            }
+            ComplainDisallowed(chunk.new_words[i], disallowed_symbol_action_);
+          }
+          chunk.new_ids[i] = word;
+        }
+      } catch (const std::exception &e) {
+        error_ = e.what();
+        failed_ = true;
+      }
+      return !failed_;
+    }
+
+    uint64_t Count(const Chunk &chunk, WordCache &cache, Writer<Handoff> &writer) const {
+      for (std::size_t i = 0; i < chunk.new_hashes.size(); ++i) {
+        WordCache::MutableIterator it;
+        UTIL_THROW_IF(!cache.UnsafeMutableFind(chunk.new_hashes[i], it), util::Exception, "Word missing from thread cache.");
+        it->value = chunk.new_ids[i];
+      }
+      uint64_t count = 0;
+      bool line_start = true;
+      for (std::vector<uint64_t>::const_iterator i = chunk.tokens.begin(); i != chunk.tokens.end(); ++i) {
+        if (line_start) {
+          writer.StartSentence();
+          line_start = false;
+        }
+        if (*i == kEndLine) {
+          writer.Append(end_sentence_);
+          line_start = true;
+          continue;
+        }
+        WordIndex word = (*i >= kNewWord) ? chunk.new_ids[*i - kNewWord] : static_cast<WordIndex>(*i);
+        // Disallowed, already complained about.
+        if (word <= 2) continue;
+        writer.Append(word);
+        ++count;
+      }
+      return count;
+    }
+
+    bool Failed() {
+      boost::mutex::scoped_lock lock(mutex_);
+      return failed_;
+    }
+
+    void Fail(const char *message) {
+      boost::mutex::scoped_lock lock(mutex_);
+      if (!failed_) error_ = message;
+      failed_ = true;
+    }
+
+    util::FilePiece &from_;
+    Vocab &vocab_;
+    const WordIndex end_sentence_;
+    WarningAction &disallowed_symbol_action_;
+    bool delimiters_[256];
+
+    const std::size_t threads_;
+    uint8_t *const dedupe_mem_;
+    const std::size_t dedupe_mem_size_;
+    std::size_t order_, block_size_;
+
+    util::PCQueue<Chunk*> chunks_;
+    util::PCQueue<util::stream::Block> empty_, full_;
+
+    util::stream::Link out_;
+    bool linked_;
+
+    // Protects everything below.
+    boost::mutex mutex_;
+    boost::condition_variable turn_;
+    uint64_t next_sequence_;
+    bool failed_;
+    std::string error_, disallowed_;
+    uint64_t token_count_;
+};
+
 } // namespace
 
 void CorpusCount::Run(const util::stream::ChainPosition &position) {
-  ngram::GrowableVocab<ngram::WriteUniqueWords> vocab(type_count_, vocab_write_);
+  Vocab vocab(type_count_, vocab_write_);
   token_count_ = 0;
   type_count_ = 0;
   const WordIndex end_sentence = vocab.FindOrInsert("</s>");
-  Writer writer(NGram<BuildingPayload>::OrderFromSize(position.GetChain().EntrySize()), position, dedupe_mem_.get(), dedupe_mem_size_);
   uint64_t count = 0;
   bool delimiters[256];
   util::BoolCharacter::Build("\0\t\n\r ", delimiters);
-  try {
-    while(true) {
-      StringPiece line(from_.ReadLine());
-      writer.StartSentence();
-      for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w) {
-        WordIndex word = vocab.FindOrInsert(*w);
-        if (word <= 2) {
-          ComplainDisallowed(*w, disallowed_symbol_action_);
-          continue;
+  // These poison the chain when they go out of scope, after the counts are final.
+  util::scoped_ptr<Writer<util::stream::Link> > writer;
+  util::scoped_ptr<ParallelCount> parallel;
+  if (threads_ > 1) {
+    parallel.reset(new ParallelCount(from_, vocab, end_sentence, disallowed_symbol_action_, threads_, static_cast<uint8_t*>(dedupe_mem_.get()), dedupe_mem_size_));
+    count = parallel->Run(position);
+  } else {
+    writer.reset(new Writer<util::stream::Link>(NGram<BuildingPayload>::OrderFromSize(position.GetChain().EntrySize()), position, position.GetChain().BlockSize(), dedupe_mem_.get(), dedupe_mem_size_));
+    try {
+      while(true) {
+        StringPiece line(from_.ReadLine());
+        writer->StartSentence();
+        for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w) {
+          WordIndex word = vocab.FindOrInsert(*w);
+          if (word <= 2) {
+            ComplainDisallowed(*w, disallowed_symbol_action_);
+            continue;
+          }
+          writer->Append(word);
+          ++count;
         }
-        writer.Append(word);
-        ++count;
+        writer->Append(end_sentence);
       }
-      writer.Append(end_sentence);
-    }
-  } catch (const util::EndOfFileException &e) {}
+    } catch (const util::EndOfFileException &e) {}
+  }
   token_count_ = count;
   type_count_ = vocab.Size();
 
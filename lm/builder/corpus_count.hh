@@ -25,12 +25,19 @@ class CorpusCount {
     // Memory usage will be DedupeMultipler(order) * block_size + total_chain_size + unknown vocab_hash_size
     static float DedupeMultiplier(std::size_t order);
 
+    // Same as DedupeMultiplier when counting with more threads, each of which
+    // has its own dedupe table and block, plus a spare block.  Each also
+    // caches the ids of the words it has seen.
+    static float DedupeMultiplier(std::size_t order, std::size_t threads);
+
     // How much memory vocabulary will use based on estimated size of the vocab.
     static std::size_t VocabUsage(std::size_t vocab_estimate);
 
     // token_count: out.
     // type_count aka vocabulary size.  Initialize to an estimate.  It is set to the exact value.
-    CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol);
+    // threads: count with this many workers, and another thread reading.
+    // The output n-grams and vocabulary are the same as with one.
+    CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol, std::size_t threads = 1);
 
     void Run(const util::stream::ChainPosition &position);
 
@@ -40,8 +47,11 @@ class CorpusCount {
     uint64_t &token_count_;
     WordIndex &type_count_;
     std::vector<bool>& prune_words_;
-    const std::string& prune_vocab_filename_;
+    const std::string prune_vocab_filename_;
+
+    std::size_t threads_;
 
+    // Size of one dedupe table.  There is one per thread.
     std::size_t dedupe_mem_size_;
     util::scoped_malloc dedupe_mem_;
 
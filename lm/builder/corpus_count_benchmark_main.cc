@@ -0,0 +1,77 @@
+#include "lm/builder/corpus_count.hh"
+
+#include "lm/builder/payload.hh"
+#include "lm/common/ngram.hh"
+#include "util/file.hh"
+#include "util/file_piece.hh"
+#include "util/stream/chain.hh"
+#include "util/usage.hh"
+
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace lm { namespace builder { namespace {
+
+// Consumes the counted n-grams, so the benchmark measures counting alone.
+class Discard {
+  public:
+    explicit Discard(uint64_t &entries) : entries_(entries) {}
+
+    void Run(const util::stream::ChainPosition &position) {
+      entries_ = 0;
+      for (util::stream::Link link(position); link; ++link) {
+        entries_ += link->ValidSize() / position.GetChain().EntrySize();
+      }
+    }
+
+  private:
+    uint64_t &entries_;
+};
+
+void Benchmark(const char *file, std::size_t order, std::size_t max_threads) {
+  const uint64_t size = util::SizeOrThrow(util::scoped_fd(util::OpenReadOrThrow(file)).get());
+  std::cout << "#threads\tseconds\tMB/s\ttokens/s\tentries\tspeedup\n";
+  double single_time = 0.0;
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    util::FilePiece from(file);
+    util::scoped_fd vocab(util::MakeTemp("corpus_count_benchmark_vocab"));
+    util::stream::ChainConfig config;
+    config.entry_size = NGram<BuildingPayload>::TotalSize(order);
+    config.total_memory = 64 << 20;
+    config.block_count = 2;
+    uint64_t token_count = 0, entries = 0;
+    WordIndex type_count = 1000000;
+    std::vector<bool> prune_words;
+    double start = util::WallTime();
+    {
+      util::stream::Chain chain(config);
+      CorpusCount counter(from, vocab.get(), token_count, type_count, prune_words, "", chain.BlockSize() / chain.EntrySize(), SILENT, threads);
+      chain >> boost::ref(counter) >> Discard(entries) >> util::stream::kRecycle;
+      // Before counter goes out of scope.
+      chain.Wait();
+    }
+    double took = util::WallTime() - start;
+    if (threads == 1) single_time = took;
+    std::cout << threads << '\t' << took << '\t' << (static_cast<double>(size) / took / 1048576.0) << '\t'
+      << (static_cast<double>(token_count) / took) << '\t' << entries << '\t' << (single_time / took) << std::endl;
+  }
+}
+
+}}} // namespaces
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 4) {
+    std::cerr << "Usage: " << argv[0] << " text [order [max_threads]]\n"
+      "Counts n-grams of text, default order 5, as lmplz does with --count_threads\n"
+      "1, 2, 4, ... up to max_threads, default the number of cores.\n";
+    return 1;
+  }
+  std::size_t order = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 5;
+  std::size_t max_threads = argc > 3 ? std::strtoul(argv[3], NULL, 10) : boost::thread::hardware_concurrency();
+  lm::builder::Benchmark(argv[1], std::max<std::size_t>(1, order), std::max<std::size_t>(1, max_threads));
+  return 0;
+}
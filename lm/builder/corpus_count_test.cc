@@ -13,6 +13,10 @@
 #define BOOST_TEST_MODULE CorpusCountTest
 #include <boost/test/unit_test.hpp>
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace lm { namespace builder { namespace {
 
 #define Check(str, cnt) { \
@@ -76,4 +80,64 @@ BOOST_AUTO_TEST_CASE(Short) {
   BOOST_CHECK_EQUAL(sizeof(v) / sizeof(const char*), type_count);
 }
 
+typedef std::map<std::vector<WordIndex>, uint64_t> Counts;
+
+// Counts of each trigram, summed over blocks, and the vocabulary file.
+void CountWithThreads(const std::string &text, std::size_t threads, Counts &counts, std::string &vocab_words, uint64_t &token_count, WordIndex &type_count) {
+  util::scoped_fd input_file(util::MakeTemp("corpus_count_test_temp"));
+  util::WriteOrThrow(input_file.get(), text.data(), text.size());
+  util::SeekOrThrow(input_file.get(), 0);
+  util::FilePiece input_piece(input_file.release(), "temp file");
+
+  util::stream::ChainConfig config;
+  config.entry_size = NGram<BuildingPayload>::TotalSize(3);
+  config.total_memory = config.entry_size * 20000;
+  config.block_count = 2;
+
+  util::scoped_fd vocab(util::MakeTemp("corpus_count_test_vocab"));
+  {
+    util::stream::Chain chain(config);
+    type_count = 10;
+    std::vector<bool> prune_words;
+    CorpusCount counter(input_piece, vocab.get(), token_count, type_count, prune_words, "", chain.BlockSize() / chain.EntrySize(), SILENT, threads);
+    chain >> boost::ref(counter);
+    NGramStream<BuildingPayload> stream(chain.Add());
+    chain >> util::stream::kRecycle;
+    for (; stream; ++stream) {
+      counts[std::vector<WordIndex>(stream->begin(), stream->end())] += stream->Value().count;
+    }
+  }
+  vocab_words.resize(util::SizeOrThrow(vocab.get()));
+  util::SeekOrThrow(vocab.get(), 0);
+  util::ReadOrThrow(vocab.get(), &vocab_words[0], vocab_words.size());
+}
+
+BOOST_AUTO_TEST_CASE(Threads) {
+  // A few MB, so there are several chunks and blocks.
+  std::string text;
+  uint64_t state = 1;
+  for (std::size_t line = 0; line < 100000; ++line) {
+    std::size_t length = line % 17;
+    for (std::size_t i = 0; i < length; ++i) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      // Skewed so there are repeated n-grams.
+      uint64_t word = (state >> 33) % ((state >> 60) ? 50 : 20000);
+      text += "w" + std::string(1, 'a' + word % 26) + std::string(word / 26 % 30, 'x') + ' ';
+    }
+    text += '\n';
+  }
+
+  Counts counts[2];
+  std::string vocab_words[2];
+  uint64_t token_count[2];
+  WordIndex type_count[2];
+  CountWithThreads(text, 1, counts[0], vocab_words[0], token_count[0], type_count[0]);
+  CountWithThreads(text, 3, counts[1], vocab_words[1], token_count[1], type_count[1]);
+  BOOST_CHECK_EQUAL(token_count[0], token_count[1]);
+  BOOST_CHECK_EQUAL(type_count[0], type_count[1]);
+  BOOST_CHECK(vocab_words[0] == vocab_words[1]);
+  BOOST_CHECK_EQUAL(counts[0].size(), counts[1].size());
+  BOOST_CHECK(counts[0] == counts[1]);
+}
+
 }}} // namespaces
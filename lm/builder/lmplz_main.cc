@@ -5,6 +5,7 @@
 #include "util/file.hh"
 #include "util/file_piece.hh"
 #include "util/usage.hh"
+#include "util/write_compressed.hh"
 
 #include <iostream>
 
@@ -72,7 +73,7 @@ int main(int argc, char *argv[]) {
     po::options_description options("Language model building options");
     lm::builder::PipelineConfig pipeline;
 
-    std::string text, intermediate, arpa;
+    std::string text, intermediate, arpa, intermediate_compression;
     std::vector<std::string> pruning;
     std::vector<std::string> discount_fallback;
     std::vector<std::string> discount_fallback_default;
@@ -94,13 +95,16 @@ int main(int argc, char *argv[]) {
       ("memory,S", lm:: SizeOption(pipeline.sort.total_memory, util::GuessPhysicalMemory() ? "80%" : "1G"), "Sorting memory")
       ("minimum_block", lm::SizeOption(pipeline.minimum_block, "8K"), "Minimum block size to allow")
       ("sort_block", lm::SizeOption(pipeline.sort.buffer_size, "64M"), "Size of IO operations for sort (determines arity)")
+      ("sort_threads", po::value<std::size_t>(&pipeline.sort.threads)->default_value(1), "Threads to sort each block with.  More than one costs an extra block of memory per sort")
       ("block_count", po::value<std::size_t>(&pipeline.block_count)->default_value(2), "Block count (per order)")
+      ("count_threads", po::value<std::size_t>(&pipeline.count_threads)->default_value(1), "Threads to count n-grams with in step 1, besides one reading.  Output is the same.  Each needs another block and dedupe table, so blocks are smaller")
       ("vocab_estimate", po::value<lm::WordIndex>(&pipeline.vocab_estimate)->default_value(1000000), "Assume this vocabulary size for purposes of calculating memory in step 1 (corpus count) and pre-sizing the hash table")
       ("vocab_pad", po::value<uint64_t>(&pipeline.vocab_size_for_unk)->default_value(0), "If the vocabulary is smaller than this value, pad with <unk> to reach this size. Requires --interpolate_unigrams")
       ("verbose_header", po::bool_switch(&verbose_header), "Add a verbose header to the ARPA file that includes information such as token count, smoothing type, etc.")
       ("text", po::value<std::string>(&text), "Read text from a file instead of stdin")
       ("arpa", po::value<std::string>(&arpa), "Write ARPA to a file instead of stdout")
       ("intermediate", po::value<std::string>(&intermediate), "Write ngrams to intermediate files.  Turns off ARPA output (which can be reactivated by --arpa file).  Forces --renumber on.")
+      ("intermediate_compression", po::value<std::string>(&intermediate_compression)->default_value("none"), "Compress the n-gram files written by --intermediate, or the temporary copy kept for ARPA output, with none, gzip, zstd, or lz4.  zstd and lz4 are much faster than gzip to read back")
       ("renumber", po::bool_switch(&pipeline.renumber_vocabulary), "Rrenumber the vocabulary identifiers so that they are monotone with the hash of each string.  This is consistent with the ordering used by the trie data structure.")
       ("collapse_values", po::bool_switch(&pipeline.output_q), "Collapse probability and backoff into a single value, q that yields the same sentence-level probabilities.  See http://kheafield.com/professional/edinburgh/rest_paper.pdf for more details, including a proof.")
       ("prune", po::value<std::vector<std::string> >(&pruning)->multitoken(), "Prune n-grams with count less than or equal to the given threshold.  Specify one value for each order i.e. 0 0 1 to prune singleton trigrams and above.  The sequence of values must be non-decreasing and the last value applies to any remaining orders. Default is to not prune, which is equivalent to --prune 0.")
@@ -202,7 +206,9 @@ int main(int argc, char *argv[]) {
       if (writing_intermediate) {
         pipeline.renumber_vocabulary = true;
       }
-      lm::builder::Output output(writing_intermediate ? intermediate : pipeline.sort.temp_prefix, writing_intermediate, pipeline.output_q);
+      util::WriteCompressed::Compression compression = util::WriteCompressed::FromName(intermediate_compression);
+      UTIL_THROW_IF(!util::WriteCompressed::Available(compression), util::CompressedException, "--intermediate_compression " << intermediate_compression << " was not compiled in.");
+      lm::builder::Output output(writing_intermediate ? intermediate : pipeline.sort.temp_prefix, writing_intermediate, pipeline.output_q, compression);
       if (!writing_intermediate || vm.count("arpa")) {
         output.Add(new lm::builder::PrintHook(out.release(), verbose_header));
       }
@@ -11,8 +11,8 @@ namespace lm { namespace builder {
 
 OutputHook::~OutputHook() {}
 
-Output::Output(StringPiece file_base, bool keep_buffer, bool output_q)
-  : buffer_(file_base, keep_buffer, output_q) {}
+Output::Output(StringPiece file_base, bool keep_buffer, bool output_q, util::WriteCompressed::Compression compression)
+  : buffer_(file_base, keep_buffer, output_q, compression) {}
 
 void Output::SinkProbs(util::stream::Chains &chains) {
   Apply(PROB_PARALLEL_HOOK, chains);
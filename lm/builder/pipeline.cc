@@ -219,7 +219,7 @@ util::stream::Sort<SuffixOrder, CombineCounts> *CountText(int text_file /* input
     // This much memory to work with after vocab hash table.
     static_cast<float>(config.TotalMemory() - vocab_usage) /
     // Solve for block size including the dedupe multiplier for one block.
-    (static_cast<float>(config.block_count) + CorpusCount::DedupeMultiplier(config.order)) *
+    (static_cast<float>(config.block_count) + CorpusCount::DedupeMultiplier(config.order, config.count_threads)) *
     // Chain likes memory expressed in terms of total memory.
     static_cast<float>(config.block_count);
   util::stream::Chain chain(util::stream::ChainConfig(NGram<BuildingPayload>::TotalSize(config.order), config.block_count, memory_for_chain));
@@ -227,7 +227,7 @@ util::stream::Sort<SuffixOrder, CombineCounts> *CountText(int text_file /* input
   type_count = config.vocab_estimate;
   util::FilePiece text(text_file, NULL, &std::cerr);
   text_file_name = text.FileName();
-  CorpusCount counter(text, vocab_file, token_count, type_count, prune_words, config.prune_vocab_file, chain.BlockSize() / chain.EntrySize(), config.disallowed_symbol_action);
+  CorpusCount counter(text, vocab_file, token_count, type_count, prune_words, config.prune_vocab_file, chain.BlockSize() / chain.EntrySize(), config.disallowed_symbol_action, config.count_threads);
   chain >> boost::ref(counter);
 
   util::scoped_ptr<util::stream::Sort<SuffixOrder, CombineCounts> > sorter(new util::stream::Sort<SuffixOrder, CombineCounts>(chain, config.sort, SuffixOrder(config.order), CombineCounts()));
@@ -65,6 +65,10 @@ struct PipelineConfig {
    */
   WarningAction disallowed_symbol_action;
 
+  // Threads counting n-grams in the first step, besides the one reading.
+  // More need more memory, so the chain blocks of that step are smaller.
+  std::size_t count_threads;
+
   const std::string &TempPrefix() const { return sort.temp_prefix; }
   std::size_t TotalMemory() const { return sort.total_memory; }
 };
@@ -12,14 +12,24 @@ namespace lm {
 
 namespace {
 const char kMetadataHeader[] = "KenLM intermediate binary file";
+
+// Compressed files are read in order from the beginning.
+void SourceFile(int fd, util::WriteCompressed::Compression compression, util::stream::Chain &chain) {
+  if (compression == util::WriteCompressed::NONE) {
+    chain >> util::stream::PRead(fd);
+  } else {
+    util::SeekOrThrow(fd, 0);
+    chain >> util::stream::Decompress(fd);
+  }
+}
 } // namespace
 
-ModelBuffer::ModelBuffer(StringPiece file_base, bool keep_buffer, bool output_q)
-  : file_base_(file_base.data(), file_base.size()), keep_buffer_(keep_buffer), output_q_(output_q),
+ModelBuffer::ModelBuffer(StringPiece file_base, bool keep_buffer, bool output_q, util::WriteCompressed::Compression compression)
+  : file_base_(file_base.data(), file_base.size()), keep_buffer_(keep_buffer), output_q_(output_q), compression_(compression),
     vocab_file_(keep_buffer ? util::CreateOrThrow((file_base_ + ".vocab").c_str()) : util::MakeTemp(file_base_)) {}
   
 ModelBuffer::ModelBuffer(StringPiece file_base)
-  : file_base_(file_base.data(), file_base.size()), keep_buffer_(false) {
+  : file_base_(file_base.data(), file_base.size()), keep_buffer_(false), compression_(util::WriteCompressed::NONE) {
   const std::string full_name = file_base_ + ".kenlm_intermediate";
   util::FilePiece in(full_name.c_str());
   StringPiece token = in.ReadLine();
@@ -44,6 +54,13 @@ ModelBuffer::ModelBuffer(StringPiece file_base)
     UTIL_THROW(util::Exception, "Unknown payload " << token);
   }
 
+  // Optional: files without this line are uncompressed.
+  try {
+    token = in.ReadDelimited();
+    UTIL_THROW_IF2(token != "Compression", "Expected Compression, got \"" << token << "\" in " << full_name);
+    compression_ = util::WriteCompressed::FromName(in.ReadDelimited());
+    UTIL_THROW_IF2(!util::WriteCompressed::Available(compression_), full_name << " says the n-grams are compressed with " << util::WriteCompressed::Name(compression_) << " but support was not compiled in.");
+  } catch (const util::EndOfFileException &e) {}
   vocab_file_.reset(util::OpenReadOrThrow((file_base_ + ".vocab").c_str()));
 
   files_.Init(counts_.size());
@@ -64,7 +81,11 @@ void ModelBuffer::Sink(util::stream::Chains &chains, const std::vector<uint64_t>
     } else {
       files_.push_back(util::MakeTemp(file_base_));
     }
-    chains[i] >> util::stream::Write(files_.back().get());
+    if (compression_ == util::WriteCompressed::NONE) {
+      chains[i] >> util::stream::Write(files_.back().get());
+    } else {
+      chains[i] >> util::stream::Compress(files_.back().get(), compression_);
+    }
   }
   if (keep_buffer_) {
     util::scoped_fd metadata(util::CreateOrThrow((file_base_ + ".kenlm_intermediate").c_str()));
@@ -74,18 +95,21 @@ void ModelBuffer::Sink(util::stream::Chains &chains, const std::vector<uint64_t>
       meta << ' ' << *i;
     }
     meta << "\nPayload " << (output_q_ ? "q" : "pb") << '\n';
+    if (compression_ != util::WriteCompressed::NONE) {
+      meta << "Compression " << util::WriteCompressed::Name(compression_) << '\n';
+    }
   }
 }
 
 void ModelBuffer::Source(util::stream::Chains &chains) {
   assert(chains.size() <= files_.size());
   for (unsigned int i = 0; i < chains.size(); ++i) {
-    chains[i] >> util::stream::PRead(files_[i].get());
+    SourceFile(files_[i].get(), compression_, chains[i]);
   }
 }
 
 void ModelBuffer::Source(std::size_t order_minus_1, util::stream::Chain &chain) {
-  chain >> util::stream::PRead(files_[order_minus_1].get());
+  SourceFile(files_[order_minus_1].get(), compression_, chain);
 }
 
 } // namespace
@@ -5,9 +5,47 @@
 #include "util/usage.hh"
 
 #include <stdint.h>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace {
 
+// Data TLB misses of this thread, where the kernel allows counting them.
+class TLBMisses {
+  public:
+    TLBMisses() : fd_(-1) {
+#ifdef __linux__
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd_ = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~TLBMisses() {
+      if (fd_ >= 0) close(fd_);
+    }
+
+    // -1 if they can't be counted.
+    int64_t Get() const {
+      uint64_t count;
+      if (fd_ < 0 || read(fd_, &count, sizeof(count)) != sizeof(count)) return -1;
+      return count;
+    }
+
+  private:
+    int fd_;
+};
+
 template <class Model, class Width> void ConvertToBytes(const Model &model, int fd_in) {
   util::FilePiece in(fd_in);
   util::FileStream out(1);
@@ -36,6 +74,9 @@ template <class Model, class Width> void QueryFromBytes(const Model &model, int
 
   std::cout << "CPU_to_load: " << loaded << std::endl;
 
+  TLBMisses tlb;
+  int64_t tlb_before = tlb.Get();
+
   // Numerical precision: batch sums.
   double total = 0.0;
   while (std::size_t got = util::ReadOrEOF(fd_in, buf, sizeof(buf))) {
@@ -61,59 +102,130 @@ template <class Model, class Width> void QueryFromBytes(const Model &model, int
     total += sum;
   }
   double after = util::CPUTime();
+  int64_t tlb_after = tlb.Get();
   std::cerr << "Probability sum is " << total << std::endl;
+  if (tlb_before >= 0 && tlb_after >= 0) {
+    std::cout << "DTLB_misses_per_query: " << (static_cast<double>(tlb_after - tlb_before) / static_cast<double>(completed)) << std::endl;
+  }
   std::cout << "Queries: " << completed << std::endl;
   std::cout << "CPU_excluding_load: " << (after - loaded) << "\nCPU_per_query: " << ((after - loaded) / static_cast<double>(completed)) << std::endl;
   std::cout << "RSSMax: " << util::RSSMax() << std::endl;
 }
 
-template <class Model, class Width> void DispatchFunction(const Model &model, bool query) {
-  if (query) {
+// Score K sentences at a time with FullScoreBatch, for K = 1, 2, 4, ... 32.
+template <class Model, class Width> void BatchFromBytes(const Model &model, int fd_in) {
+  const Width kEOS = model.GetVocabulary().EndSentence();
+  std::vector<Width> text;
+  Width buf[4096];
+  while (std::size_t got = util::ReadOrEOF(fd_in, buf, sizeof(buf))) {
+    UTIL_THROW_IF2(got % sizeof(Width), "File size not a multiple of vocab id size " << sizeof(Width));
+    text.insert(text.end(), buf, buf + got / sizeof(Width));
+  }
+  std::cout << "CPU_to_load: " << util::CPUTime() << std::endl;
+
+  const std::size_t kMaxStreams = 32;
+  std::vector<lm::ngram::State> state(kMaxStreams), out(kMaxStreams);
+  std::vector<const lm::ngram::State*> in(kMaxStreams);
+  std::vector<lm::WordIndex> words(kMaxStreams);
+  std::vector<lm::FullScoreReturn> ret(kMaxStreams);
+  std::vector<std::size_t> pos(kMaxStreams + 1), which(kMaxStreams);
+
+  for (std::size_t streams = 1; streams <= kMaxStreams; streams *= 2) {
+    // Each stream takes an equal share of the text, starting after an end of sentence.
+    pos[0] = 0;
+    for (std::size_t s = 1; s < streams; ++s) {
+      std::size_t start = std::max(pos[s - 1], text.size() * s / streams);
+      while (start < text.size() && start && text[start - 1] != kEOS) ++start;
+      pos[s] = start;
+    }
+    pos[streams] = text.size();
+    std::vector<std::size_t> end(pos.begin() + 1, pos.begin() + streams + 1);
+    for (std::size_t s = 0; s < streams; ++s) {
+      state[s] = model.BeginSentenceState();
+    }
+
+    double total = 0.0;
+    double start_time = util::CPUTime();
+    while (true) {
+      std::size_t batch = 0;
+      for (std::size_t s = 0; s < streams; ++s) {
+        if (pos[s] == end[s]) continue;
+        in[batch] = &state[s];
+        words[batch] = text[pos[s]];
+        which[batch] = s;
+        ++batch;
+      }
+      if (!batch) break;
+      model.FullScoreBatch(&in[0], &words[0], &out[0], &ret[0], batch);
+      for (std::size_t b = 0; b < batch; ++b) {
+        const std::size_t s = which[b];
+        total += ret[b].prob;
+        state[s] = (text[pos[s]++] == kEOS) ? model.BeginSentenceState() : out[b];
+      }
+    }
+    double took = util::CPUTime() - start_time;
+    std::cout << "K: " << streams << " Queries: " << text.size() << " CPU: " << took
+              << " Queries_per_second: " << (took > 0.0 ? static_cast<double>(text.size()) / took : 0.0)
+              << " Probability_sum: " << total << std::endl;
+  }
+  std::cout << "RSSMax: " << util::RSSMax() << std::endl;
+}
+
+template <class Model, class Width> void DispatchFunction(const Model &model, const char *mode) {
+  if (!strcmp(mode, "query")) {
     QueryFromBytes<Model, Width>(model, 0);
+  } else if (!strcmp(mode, "batch")) {
+    BatchFromBytes<Model, Width>(model, 0);
   } else {
     ConvertToBytes<Model, Width>(model, 0);
   }
 }
 
-template <class Model> void DispatchWidth(const char *file, bool query) {
+template <class Model> void DispatchWidth(const char *file, const char *mode, util::LoadMethod load_method) {
   lm::ngram::Config config;
-  config.load_method = util::READ;
-  std::cerr << "Using load_method = READ." << std::endl;
+  config.load_method = load_method;
+  double start = util::WallTime();
   Model model(file, config);
+  if (strcmp(mode, "vocab")) {
+    // With lazy or background loading, the model can be used well before it's all in memory.
+    lm::ngram::State ignored;
+    model.FullScore(model.BeginSentenceState(), model.GetVocabulary().EndSentence(), ignored);
+    std::cout << "Time_to_first_query: " << (util::WallTime() - start) << std::endl;
+  }
   lm::WordIndex bound = model.GetVocabulary().Bound();
   if (bound <= 256) {
-    DispatchFunction<Model, uint8_t>(model, query);
+    DispatchFunction<Model, uint8_t>(model, mode);
   } else if (bound <= 65536) {
-    DispatchFunction<Model, uint16_t>(model, query);
+    DispatchFunction<Model, uint16_t>(model, mode);
   } else if (bound <= (1ULL << 32)) {
-    DispatchFunction<Model, uint32_t>(model, query);
+    DispatchFunction<Model, uint32_t>(model, mode);
   } else {
-    DispatchFunction<Model, uint64_t>(model, query);
+    DispatchFunction<Model, uint64_t>(model, mode);
   }
 }
 
-void Dispatch(const char *file, bool query) {
+void Dispatch(const char *file, const char *mode, util::LoadMethod load_method) {
   using namespace lm::ngram;
   lm::ngram::ModelType model_type;
   if (lm::ngram::RecognizeBinary(file, model_type)) {
     switch(model_type) {
       case PROBING:
-        DispatchWidth<lm::ngram::ProbingModel>(file, query);
+        DispatchWidth<lm::ngram::ProbingModel>(file, mode, load_method);
         break;
       case REST_PROBING:
-        DispatchWidth<lm::ngram::RestProbingModel>(file, query);
+        DispatchWidth<lm::ngram::RestProbingModel>(file, mode, load_method);
         break;
       case TRIE:
-        DispatchWidth<lm::ngram::TrieModel>(file, query);
+        DispatchWidth<lm::ngram::TrieModel>(file, mode, load_method);
         break;
       case QUANT_TRIE:
-        DispatchWidth<lm::ngram::QuantTrieModel>(file, query);
+        DispatchWidth<lm::ngram::QuantTrieModel>(file, mode, load_method);
         break;
       case ARRAY_TRIE:
-        DispatchWidth<lm::ngram::ArrayTrieModel>(file, query);
+        DispatchWidth<lm::ngram::ArrayTrieModel>(file, mode, load_method);
         break;
       case QUANT_ARRAY_TRIE:
-        DispatchWidth<lm::ngram::QuantArrayTrieModel>(file, query);
+        DispatchWidth<lm::ngram::QuantArrayTrieModel>(file, mode, load_method);
         break;
       default:
         UTIL_THROW(util::Exception, "Unrecognized kenlm model type " << model_type);
@@ -123,10 +235,23 @@ void Dispatch(const char *file, bool query) {
   }
 }
 
+bool ParseLoadMethod(const char *name, util::LoadMethod &method) {
+  const char *names[] = {"lazy", "populate_or_lazy", "populate_or_read", "read", "parallel_read", "huge_read", "background"};
+  const util::LoadMethod methods[] = {util::LAZY, util::POPULATE_OR_LAZY, util::POPULATE_OR_READ, util::READ, util::PARALLEL_READ, util::HUGE_READ, util::BACKGROUND_POPULATE};
+  for (std::size_t i = 0; i < sizeof(names) / sizeof(const char*); ++i) {
+    if (!strcmp(name, names[i])) {
+      method = methods[i];
+      return true;
+    }
+  }
+  return false;
+}
+
 } // namespace
 
 int main(int argc, char *argv[]) {
-  if (argc != 3 || (strcmp(argv[1], "vocab") && strcmp(argv[1], "query"))) {
+  util::LoadMethod load_method = util::READ;
+  if (argc < 3 || argc > 4 || (strcmp(argv[1], "vocab") && strcmp(argv[1], "query") && strcmp(argv[1], "batch")) || (argc == 4 && !ParseLoadMethod(argv[3], load_method))) {
     std::cerr
       << "Benchmark program for KenLM.  Intended usage:\n"
       << "#Convert text to vocabulary ids offline.  These ids are tied to a model.\n"
@@ -134,9 +259,15 @@ int main(int argc, char *argv[]) {
       << "#Ensure files are in RAM.\n"
       << "cat $text.vocab $model >/dev/null\n"
       << "#Timed query against the model.\n"
-      << argv[0] << " query $model <$text.vocab\n";
+      << argv[0] << " query $model <$text.vocab\n"
+      << "#Queries per second with 1 to 32 sentences scored at once by FullScoreBatch.\n"
+      << argv[0] << " batch $model <$text.vocab\n"
+      << "#Query and batch take an optional load method, read by default:\n"
+      << "#lazy, populate_or_lazy, populate_or_read, read, parallel_read, huge_read or background.\n"
+      << "#They report the time from the start of loading to the first query answered.\n"
+      << argv[0] << " query $model huge_read <$text.vocab\n";
     return 1;
   }
-  Dispatch(argv[2], !strcmp(argv[1], "query"));
+  Dispatch(argv[2], argv[1], load_method);
   return 0;
 }
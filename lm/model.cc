@@ -295,6 +295,88 @@ template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT
   }
 }
 
+template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT>::FullScoreBatch(const State *const in_states[], const WordIndex new_words[], State out_states[], FullScoreReturn returns[], std::size_t num) const {
+  // Progress of each query, in chunks so it fits on the stack.
+  const std::size_t kChunk = 64;
+  typename Search::Node node[kChunk];
+  unsigned char order_minus_2[kChunk];
+  std::size_t active[kChunk];
+
+  for (std::size_t chunk = 0; chunk < num; chunk += kChunk) {
+    const State *const *in = in_states + chunk;
+    const WordIndex *word = new_words + chunk;
+    State *out = out_states + chunk;
+    FullScoreReturn *ret = returns + chunk;
+    const std::size_t size = std::min(kChunk, num - chunk);
+
+    for (std::size_t i = 0; i < size; ++i) {
+      Prefetch(*in[i], word[i]);
+    }
+
+    // Unigrams, as in ScoreExceptBackoff.
+    std::size_t num_active = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      assert(word[i] < vocab_.Bound());
+      ret[i].ngram_length = 1;
+      typename Search::UnigramPointer uni(search_.LookupUnigram(word[i], node[i], ret[i].independent_left, ret[i].extend_left));
+      out[i].backoff[0] = uni.Backoff();
+      ret[i].prob = uni.Prob();
+      ret[i].rest = uni.Rest();
+      out[i].length = HasExtension(out[i].backoff[0]) ? 1 : 0;
+      out[i].words[0] = word[i];
+      order_minus_2[i] = 0;
+      if (in[i]->length && !ret[i].independent_left) {
+        PrefetchOrder(0, in[i]->words[0], node[i]);
+        active[num_active++] = i;
+      }
+    }
+
+    // Higher orders, as in ResumeScore, one order of every query per pass.
+    while (num_active) {
+      std::size_t still_active = 0;
+      for (std::size_t a = 0; a < num_active; ++a) {
+        const std::size_t i = active[a];
+        const unsigned char order = order_minus_2[i];
+        const WordIndex hist = in[i]->words[order];
+        if (order == P::Order() - 2) {
+          ret[i].independent_left = true;
+          typename Search::LongestPointer longest(search_.LookupLongest(hist, node[i]));
+          if (longest.Found()) {
+            ret[i].prob = longest.Prob();
+            ret[i].rest = ret[i].prob;
+            ret[i].ngram_length = P::Order();
+          }
+          continue;
+        }
+
+        typename Search::MiddlePointer pointer(search_.LookupMiddle(order, hist, node[i], ret[i].independent_left, ret[i].extend_left));
+        if (!pointer.Found()) continue;
+        out[i].backoff[order + 1] = pointer.Backoff();
+        ret[i].prob = pointer.Prob();
+        ret[i].rest = pointer.Rest();
+        ret[i].ngram_length = order + 2;
+        if (HasExtension(out[i].backoff[order + 1])) {
+          out[i].length = ret[i].ngram_length;
+        }
+
+        if (order + 1 == in[i]->length || ret[i].independent_left) continue;
+        order_minus_2[i] = order + 1;
+        PrefetchOrder(order + 1, in[i]->words[order + 1], node[i]);
+        active[still_active++] = i;
+      }
+      num_active = still_active;
+    }
+
+    // As in ScoreExceptBackoff and FullScore.
+    for (std::size_t i = 0; i < size; ++i) {
+      if (in[i]->length) CopyRemainingHistory(in[i]->words, out[i]);
+      for (const float *b = in[i]->backoff + ret[i].ngram_length - 1; b < in[i]->backoff + in[i]->length; ++b) {
+        ret[i].prob += *b;
+      }
+    }
+  }
+}
+
 template <class Search, class VocabularyT> float GenericModel<Search, VocabularyT>::InternalUnRest(const uint64_t *pointers_begin, const uint64_t *pointers_end, unsigned char first_length) const {
   float ret;
   typename Search::Node node;
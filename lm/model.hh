@@ -56,6 +56,23 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     FullScoreReturn FullScore(const State &in_state, const WordIndex new_word, State &out_state) const;
 
+    /* Start loading the memory that FullScore(in_state, new_word, ...) will
+     * read, without waiting for it.  Call this for a batch of independent
+     * queries before scoring any of them to overlap their cache misses.
+     */
+    void Prefetch(const State &in_state, const WordIndex new_word) const {
+      search_.Prefetch(in_state.words, in_state.words + in_state.length, new_word);
+    }
+
+    /* Score num independent queries, eg. the next word of num sentences.
+     * out_states[i] and returns[i] are what
+     * FullScore(*in_states[i], new_words[i], out_states[i]) would give.  The
+     * queries advance one n-gram order at a time in lockstep, prefetching the
+     * next order of every query before reading any, so their cache misses
+     * overlap instead of following one another.
+     */
+    void FullScoreBatch(const State *const in_states[], const WordIndex new_words[], State out_states[], FullScoreReturn returns[], std::size_t num) const;
+
     /* Slower call without in_state.  Try to remember state, but sometimes it
      * would cost too much memory or your decoder isn't setup properly.
      * To use this function, make an array of WordIndex containing the context
@@ -108,6 +125,15 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
     // Score bigrams and above.  Do not include backoff.
     void ResumeScore(const WordIndex *context_rbegin, const WordIndex *const context_rend, unsigned char starting_order_minus_2, typename Search::Node &node, float *backoff_out, unsigned char &next_use, FullScoreReturn &ret) const;
 
+    // Start loading what looking up word at order_minus_2 + 2 from node will read.
+    void PrefetchOrder(unsigned char order_minus_2, WordIndex word, const typename Search::Node &node) const {
+      if (order_minus_2 == P::Order() - 2) {
+        search_.PrefetchLongest(word, node);
+      } else {
+        search_.PrefetchMiddle(order_minus_2, word, node);
+      }
+    }
+
     // Appears after Size in the cc file.
     void SetupMemory(void *start, const std::vector<uint64_t> &counts, const Config &config);
 
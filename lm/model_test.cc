@@ -286,6 +286,50 @@ template <class M> void NoUnkCheck(const M &model) {
   SLOPPY_CHECK_CLOSE(-100.0, ret.prob, 0.001);
 }
 
+template <class M> void Batch(const M &model) {
+  // Several sentences at once, each word scored in one batch with the next word of the others.
+  const char *sentences[][8] = {
+    {"looking", "on", "a", "little", "the", "biarritz", ".", "</s>"},
+    {"looking", "on", "a", "little", "more", "loin", "</s>", NULL},
+    {"also", "would", "consider", "higher", "</s>", NULL},
+    {"not_found", "more", ".", "</s>", NULL},
+    {"on", NULL}
+  };
+  const std::size_t num = sizeof(sentences) / sizeof(sentences[0]);
+  State state[num], expect_state[num], out[num];
+  const State *in[num];
+  WordIndex words[num];
+  FullScoreReturn ret[num];
+  for (std::size_t i = 0; i < num; ++i) {
+    state[i] = expect_state[i] = (i == 2) ? model.NullContextState() : model.BeginSentenceState();
+  }
+
+  for (std::size_t word = 0; word < 8; ++word) {
+    std::size_t batch = 0;
+    for (std::size_t i = 0; i < num; ++i) {
+      if (word >= sizeof(sentences[i]) / sizeof(const char*) || !sentences[i][word]) continue;
+      in[batch] = &state[i];
+      words[batch] = model.GetVocabulary().Index(sentences[i][word]);
+      ++batch;
+    }
+    model.FullScoreBatch(in, words, out, ret, batch);
+
+    for (std::size_t b = 0; b < batch; ++b) {
+      const std::size_t i = in[b] - state;
+      State expect_out;
+      FullScoreReturn expect = model.FullScore(expect_state[i], words[b], expect_out);
+      SLOPPY_CHECK_CLOSE(expect.prob, ret[b].prob, 0.001);
+      SLOPPY_CHECK_CLOSE(expect.rest, ret[b].rest, 0.001);
+      BOOST_CHECK_EQUAL(static_cast<unsigned int>(expect.ngram_length), static_cast<unsigned int>(ret[b].ngram_length));
+      BOOST_CHECK_EQUAL(expect.independent_left, ret[b].independent_left);
+      BOOST_CHECK_EQUAL(expect.extend_left, ret[b].extend_left);
+      BOOST_CHECK_EQUAL(expect_out, out[b]);
+      expect_state[i] = expect_out;
+      state[i] = out[b];
+    }
+  }
+}
+
 template <class M> void Everything(const M &m) {
   Starters(m);
   Continuation(m);
@@ -294,6 +338,7 @@ template <class M> void Everything(const M &m) {
   MinimalState(m);
   ExtendLeftTest(m);
   Stateless(m);
+  Batch(m);
 }
 
 class ExpectEnumerateVocab : public EnumerateVocab {
@@ -0,0 +1,91 @@
+/* Decoders score every hypothesis through these calls, so they must not touch
+ * the heap.  Counts calls to operator new while querying.
+ */
+#include "lm/model.hh"
+
+#include <cstdlib>
+#include <new>
+
+#define BOOST_TEST_MODULE QueryAllocTest
+#include <boost/test/unit_test.hpp>
+
+namespace {
+unsigned long kAllocations = 0;
+} // namespace
+
+void *operator new(std::size_t size) {
+  ++kAllocations;
+  void *ret = std::malloc(size ? size : 1);
+  if (!ret) throw std::bad_alloc();
+  return ret;
+}
+
+void operator delete(void *ptr) throw() {
+  std::free(ptr);
+}
+
+namespace lm {
+namespace ngram {
+namespace {
+
+const char *TestLocation() {
+  if (boost::unit_test::framework::master_test_suite().argc < 2) {
+    return "test.arpa";
+  }
+  return boost::unit_test::framework::master_test_suite().argv[1];
+}
+
+const char *const kWords[] = {"looking", "on", "a", "little", "more", "loin", "also", "call", "for", "higher", "<unk>"};
+const std::size_t kNumWords = sizeof(kWords) / sizeof(const char*);
+
+// What a phrase-based decoder does for a hypothesis: extend the previous state
+// by the phrase, then score </s> from the last words once the sentence is
+// complete.
+template <class M> void Query() {
+  M m(TestLocation());
+  WordIndex ids[kNumWords];
+  for (std::size_t i = 0; i < kNumWords; ++i) {
+    ids[i] = m.GetVocabulary().Index(kWords[i]);
+  }
+
+  unsigned long before = kAllocations;
+  float total = 0.0;
+  State states[2];
+  for (unsigned int iteration = 0; iteration < 100; ++iteration) {
+    const State *in = &m.BeginSentenceState();
+    for (std::size_t i = 0; i < kNumWords; ++i) {
+      m.Prefetch(*in, ids[i]);
+      total += m.FullScore(*in, ids[i], states[i & 1]).prob;
+      in = &states[i & 1];
+    }
+
+    WordIndex context[KENLM_MAX_ORDER - 1];
+    unsigned int length = m.Order() - 1;
+    for (unsigned int i = 0; i < length; ++i) {
+      context[i] = ids[kNumWords - 1 - i];
+    }
+    total += m.FullScoreForgotState(context, context + length, m.GetVocabulary().EndSentence(), states[0]).prob;
+    m.GetState(context, context + length, states[1]);
+  }
+  unsigned long used = kAllocations - before;
+
+  BOOST_CHECK_EQUAL(0UL, used);
+  BOOST_CHECK(total < 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(probing) {
+  Query<ProbingModel>();
+}
+BOOST_AUTO_TEST_CASE(rest_probing) {
+  Query<RestProbingModel>();
+}
+BOOST_AUTO_TEST_CASE(trie) {
+  Query<TrieModel>();
+}
+BOOST_AUTO_TEST_CASE(quant_array_trie) {
+  Query<QuantArrayTrieModel>();
+}
+
+} // namespace
+} // namespace ngram
+} // namespace lm
@@ -14,7 +14,9 @@ void Usage(const char *name) {
     "-b: Do not buffer output.\n"
     "-n: Do not wrap the input in <s> and </s>.\n"
     "-v summary|sentence|word: Level of verbosity\n"
-    "-l lazy|populate|read|parallel: Load lazily, with populate, or malloc+read\n"
+    "-l lazy|populate|read|parallel|huge|background: Load lazily, with populate,\n"
+    "   malloc+read, malloc+read in parallel, read into huge pages, or lazily\n"
+    "   while populating in the background\n"
     "The default loading method is populate on Linux and read on others.\n";
   exit(1);
 }
@@ -57,6 +59,10 @@ int main(int argc, char *argv[]) {
           config.load_method = util::READ;
         } else if (!strcmp(optarg, "parallel")) {
           config.load_method = util::PARALLEL_READ;
+        } else if (!strcmp(optarg, "huge")) {
+          config.load_method = util::HUGE_READ;
+        } else if (!strcmp(optarg, "background")) {
+          config.load_method = util::BACKGROUND_POPULATE;
         } else {
           Usage(argv[0]);
         }
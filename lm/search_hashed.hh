@@ -8,6 +8,7 @@
 #include "lm/weights.hh"
 
 #include "util/bit_packing.hh"
+#include "util/prefetch.hh"
 #include "util/probing_hash_table.hh"
 
 #include <algorithm>
@@ -125,6 +126,26 @@ template <class Value> class HashedSearch {
       return LongestPointer(found->value.prob);
     }
 
+    // Prefetch everything scoring word after the reversed context will probe.
+    // The keys do not depend on table contents, so all orders go out at once.
+    void Prefetch(const WordIndex *context_rbegin, const WordIndex *context_rend, WordIndex word) const {
+      util::Prefetch(&unigram_.Lookup(word));
+      Node node = static_cast<Node>(word);
+      std::size_t order_minus_2 = 0;
+      for (const WordIndex *i = context_rbegin; i != context_rend; ++i, ++order_minus_2) {
+        node = CombineWordHash(node, *i);
+        if (order_minus_2 == middle_.size()) {
+          longest_.Prefetch(node);
+          return;
+        }
+        middle_[order_minus_2].Prefetch(node);
+      }
+    }
+
+    // Prefetch() has already asked for every order.
+    void PrefetchMiddle(unsigned char, WordIndex, const Node &) const {}
+    void PrefetchLongest(WordIndex, const Node &) const {}
+
     // Generate a node without necessarily checking that it actually exists.
     // Optionally return false if it's know to not exist.
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
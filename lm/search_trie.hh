@@ -9,6 +9,7 @@
 
 #include "util/file.hh"
 #include "util/file_piece.hh"
+#include "util/prefetch.hh"
 
 #include <vector>
 #include <cstdlib>
@@ -88,6 +89,21 @@ template <class Quant, class Bhiksha> class TrieSearch {
       return LongestPointer(quant_, longest_.Find(word, node));
     }
 
+    // Once node is known, start loading what the next lookup will read first.
+    void PrefetchMiddle(unsigned char order_minus_2, WordIndex word, const Node &node) const {
+      middle_begin_[order_minus_2].PrefetchFind(word, node);
+    }
+
+    void PrefetchLongest(WordIndex word, const Node &node) const {
+      longest_.PrefetchFind(word, node);
+    }
+
+    // Higher orders are found through pointers stored at lower orders, so only
+    // the unigram is known before the lookup starts.
+    void Prefetch(const WordIndex *, const WordIndex *, WordIndex word) const {
+      util::Prefetch(&unigram_.Lookup(word));
+    }
+
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
       assert(begin != end);
       bool independent_left;
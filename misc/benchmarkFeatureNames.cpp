@@ -0,0 +1,120 @@
+// Throughput of sparse feature name lookups, as made by word translation and
+// phrase pair features: names of the form root_source~target, built from a
+// synthetic vocabulary and looked up from several threads at once.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "moses/FeatureVector.h"
+#include "util/usage.hh"
+
+using namespace Moses;
+
+namespace
+{
+
+void printHelp()
+{
+  std::cerr << "Usage:\n"
+            "options: \n"
+            "\t-words int   -- vocabulary size (default 1000)\n"
+            "\t-pairs int   -- distinct word pairs, i.e. feature names (default 100000)\n"
+            "\t-n int       -- lookups per thread (default 1000000)\n"
+            "\t-threads int -- (default 1)\n"
+            "\n";
+}
+
+struct Pair {
+  size_t source, target;
+};
+
+void Lookup(const std::vector<std::string>& vocab, const std::vector<Pair>& pairs,
+            size_t n, size_t offset, size_t& checksum)
+{
+  for (size_t i = 0; i < n; ++i) {
+    const Pair& pair = pairs[(offset + i * 7919) % pairs.size()];
+    std::string name(vocab[pair.source]);
+    name += "~";
+    name += vocab[pair.target];
+    checksum += FName("WordTranslationFeature0", name).hash();
+  }
+}
+
+void Run(const std::string& name, const std::vector<std::string>& vocab,
+         const std::vector<Pair>& pairs, size_t n, size_t numThreads)
+{
+  std::vector<size_t> checksums(numThreads);
+  double start = util::WallTime();
+  boost::thread_group threads;
+  for (size_t t = 0; t < numThreads; ++t) {
+    threads.create_thread(boost::bind(&Lookup, boost::cref(vocab), boost::cref(pairs),
+                                      n, t * n, boost::ref(checksums[t])));
+  }
+  threads.join_all();
+  double time = util::WallTime() - start;
+
+  size_t checksum = 0;
+  for (size_t t = 0; t < numThreads; ++t) {
+    checksum += checksums[t];
+  }
+  size_t lookups = n * numThreads;
+  std::cout << name << ": " << lookups << " lookups, " << time << "s, "
+            << lookups / time << " lookups/s, " << FName::getNumNames()
+            << " names, checksum " << checksum << std::endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  size_t numWords = 1000, numPairs = 100000, n = 1000000, numThreads = 1;
+  for(int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if("-words" == arg && i+1 < argc) {
+      numWords = atoi(argv[++i]);
+    } else if("-pairs" == arg && i+1 < argc) {
+      numPairs = atoi(argv[++i]);
+    } else if("-n" == arg && i+1 < argc) {
+      n = atoi(argv[++i]);
+    } else if("-threads" == arg && i+1 < argc) {
+      numThreads = atoi(argv[++i]);
+    } else {
+      printHelp();
+      return 1;
+    }
+  }
+  if (!numWords || !numPairs || !numThreads) {
+    printHelp();
+    return 1;
+  }
+
+  std::vector<std::string> vocab;
+  unsigned seed = 1;
+  for (size_t i = 0; i < numWords; ++i) {
+    std::string word;
+    size_t length = 2 + i % 9;
+    for (size_t j = 0; j < length; ++j) {
+      seed = seed * 1103515245 + 12345;
+      word += 'a' + (seed >> 16) % 26;
+    }
+    vocab.push_back(word);
+  }
+  std::vector<Pair> pairs;
+  for (size_t i = 0; i < numPairs; ++i) {
+    seed = seed * 1103515245 + 12345;
+    Pair pair = {(seed >> 8) % numWords, 0};
+    seed = seed * 1103515245 + 12345;
+    pair.target = (seed >> 8) % numWords;
+    pairs.push_back(pair);
+  }
+
+  // the first run adds the names, the second only finds them
+  Run("new names", vocab, pairs, n, numThreads);
+  Run("known names", vocab, pairs, n, numThreads);
+
+  return 0;
+}
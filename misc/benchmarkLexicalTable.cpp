@@ -0,0 +1,158 @@
+// Load time and lookup throughput of every lexicalized reordering table format
+// found for a table prefix: text (memory), tree, compact and probing.
+// Queries are the keys of the first lines of the text table.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "moses/Phrase.h"
+#include "moses/InputFileStream.h"
+#include "moses/Util.h"
+#include "moses/FF/LexicalReordering/LexicalReorderingTable.h"
+#include "util/usage.hh"
+
+#ifdef HAVE_CMPH
+#include "moses/TranslationModel/CompactPT/LexicalReorderingTableCompact.h"
+#endif
+
+using namespace Moses;
+
+namespace
+{
+
+struct Query {
+  Phrase f, e, c;
+};
+
+struct Masks {
+  FactorList f, e, c;
+};
+
+void printHelp()
+{
+  std::cerr << "Usage:\n"
+            "options: \n"
+            "\t-table string -- table prefix, as in moses.ini\n"
+            "\t-text string  -- text table to take the queries from (default: the prefix)\n"
+            "\t-n int        -- number of queries (default 100000)\n"
+            "\t-repeat int   -- times to run the queries (default 10)\n"
+            "\n";
+}
+
+// keys of the first n lines. The number of key fields decides the masks
+void LoadQueries(const std::string& filePath, size_t n,
+                 std::vector<Query>& queries, Masks& masks)
+{
+  InputFileStream file(filePath);
+  std::string line;
+  while(queries.size() < n && getline(file, line)) {
+    std::vector<std::string> tokens = TokenizeMultiCharSeparator(line, "|||");
+    size_t numKeyFields = tokens.size() - 1;
+    if(queries.empty()) {
+      masks.f.push_back(0);
+      if(numKeyFields > 1) masks.e.push_back(0);
+      if(numKeyFields > 2) masks.c.push_back(0);
+    }
+
+    queries.push_back(Query());
+    Query& query = queries.back();
+    query.f.CreateFromString(Input, masks.f, Trim(tokens[0]), NULL);
+    if(numKeyFields > 1)
+      query.e.CreateFromString(Output, masks.e, Trim(tokens[1]), NULL);
+    if(numKeyFields > 2)
+      query.c.CreateFromString(Input, masks.c, Trim(tokens[2]), NULL);
+  }
+}
+
+void Run(const std::string& name, LexicalReorderingTable* table,
+         double loadTime, const std::vector<Query>& queries, size_t repeat)
+{
+  size_t found = 0;
+  double checksum = 0; // so the formats can be compared
+  double start = util::CPUTime();
+  for(size_t r = 0; r < repeat; ++r) {
+    for(size_t i = 0; i < queries.size(); ++i) {
+      Scores scores = table->GetScore(queries[i].f, queries[i].e, queries[i].c);
+      if(scores.empty()) continue;
+      ++found;
+      checksum += scores[0];
+    }
+  }
+  double time = util::CPUTime() - start;
+  size_t lookups = repeat * queries.size();
+  std::cout << name << ": loaded in " << loadTime << "s, " << lookups
+            << " lookups, " << found << " found, " << time << "s, "
+            << lookups / time << " lookups/s, checksum " << checksum << std::endl;
+  delete table;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  std::string tablePath, textPath;
+  size_t n = 100000;
+  size_t repeat = 10;
+  for(int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if("-table" == arg && i+1 < argc) {
+      tablePath = argv[++i];
+    } else if("-text" == arg && i+1 < argc) {
+      textPath = argv[++i];
+    } else if("-n" == arg && i+1 < argc) {
+      n = atoi(argv[++i]);
+    } else if("-repeat" == arg && i+1 < argc) {
+      repeat = atoi(argv[++i]);
+    } else {
+      printHelp();
+      return 1;
+    }
+  }
+  if(tablePath.empty()) {
+    printHelp();
+    return 1;
+  }
+  if(textPath.empty()) {
+    textPath = tablePath;
+    if(!FileExists(textPath) && FileExists(textPath + ".gz"))
+      textPath += ".gz";
+  }
+
+  std::vector<Query> queries;
+  Masks masks;
+  LoadQueries(textPath, n, queries, masks);
+  std::cout << "Queries: " << queries.size() << std::endl;
+
+  double start;
+  if(FileExists(tablePath) || FileExists(tablePath + ".gz")) {
+    start = util::WallTime();
+    LexicalReorderingTable* table
+    = new LexicalReorderingTableMemory(tablePath, masks.f, masks.e, masks.c);
+    Run("memory", table, util::WallTime() - start, queries, repeat);
+  }
+  if(FileExists(tablePath + ".binlexr.idx")) {
+    start = util::WallTime();
+    LexicalReorderingTable* table
+    = new LexicalReorderingTableTree(tablePath, masks.f, masks.e, masks.c);
+    Run("tree", table, util::WallTime() - start, queries, repeat);
+  }
+#ifdef HAVE_CMPH
+  if(FileExists(tablePath + ".minlexr")) {
+    start = util::WallTime();
+    LexicalReorderingTable* table = LexicalReorderingTableCompact::CheckAndLoad(
+                                      tablePath + ".minlexr", masks.f, masks.e, masks.c);
+    if(table)
+      Run("compact", table, util::WallTime() - start, queries, repeat);
+  }
+#endif
+  if(FileExists(tablePath + ".problexr")) {
+    start = util::WallTime();
+    LexicalReorderingTable* table
+    = new LexicalReorderingTableProbing(tablePath, masks.f, masks.e, masks.c);
+    Run("probing", table, util::WallTime() - start, queries, repeat);
+  }
+
+  return 0;
+}
@@ -0,0 +1,178 @@
+// Decoding throughput of the Huffman codes in a compact phrase table.
+//
+// Reads the encoded target phrase collections of a .minphr file and decodes
+// every symbol, score and alignment point in them, the way PhraseDecoder does,
+// but without building target phrases. Times the table-driven decoder against
+// the bit-by-bit one it replaced.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "moses/TranslationModel/CompactPT/BlockHashIndex.h"
+#include "moses/TranslationModel/CompactPT/CanonicalHuffman.h"
+#include "moses/TranslationModel/CompactPT/MmapAllocator.h"
+#include "moses/TranslationModel/CompactPT/StringVector.h"
+#include "util/exception.hh"
+#include "util/usage.hh"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+typedef pair<unsigned char, unsigned char> AlignPoint;
+typedef pair<unsigned, unsigned> SrcTrg;
+enum Coding { None, REnc, PREnc };
+
+struct Trees {
+  size_t numScoreComponent;
+  bool containsAlignmentInfo;
+  CanonicalHuffman<unsigned> *symbolTree;
+  bool multipleScoreTrees;
+  vector<CanonicalHuffman<float>*> scoreTrees;
+  CanonicalHuffman<AlignPoint> *alignTree;
+};
+
+// as PhraseDecoder::Load()
+void LoadTrees(FILE *in, Trees &trees)
+{
+  Coding coding;
+  size_t maxRank, maxPhraseLength;
+  UTIL_THROW_IF2(fread(&coding, sizeof(coding), 1, in) != 1
+                 || fread(&trees.numScoreComponent, sizeof(size_t), 1, in) != 1
+                 || fread(&trees.containsAlignmentInfo, sizeof(bool), 1, in) != 1
+                 || fread(&maxRank, sizeof(size_t), 1, in) != 1
+                 || fread(&maxPhraseLength, sizeof(size_t), 1, in) != 1,
+                 "Cannot read phrase decoder header");
+
+  if (coding == REnc) {
+    StringVector<unsigned char, unsigned, std::allocator> sourceSymbols;
+    sourceSymbols.load(in);
+
+    size_t size;
+    UTIL_THROW_IF2(fread(&size, sizeof(size_t), 1, in) != 1, "Cannot read lexical table");
+    vector<size_t> lexicalTableIndex(size);
+    UTIL_THROW_IF2(fread(&lexicalTableIndex[0], sizeof(size_t), size, in) != size, "Cannot read lexical table");
+    UTIL_THROW_IF2(fread(&size, sizeof(size_t), 1, in) != 1, "Cannot read lexical table");
+    vector<SrcTrg> lexicalTable(size);
+    UTIL_THROW_IF2(fread(&lexicalTable[0], sizeof(SrcTrg), size, in) != size, "Cannot read lexical table");
+  }
+
+  StringVector<unsigned char, unsigned, std::allocator> targetSymbols;
+  targetSymbols.load(in);
+
+  trees.symbolTree = new CanonicalHuffman<unsigned>(in);
+
+  UTIL_THROW_IF2(fread(&trees.multipleScoreTrees, sizeof(bool), 1, in) != 1, "Cannot read score trees");
+  size_t numScoreTrees = trees.multipleScoreTrees ? trees.numScoreComponent : 1;
+  for (size_t i = 0; i < numScoreTrees; ++i) {
+    trees.scoreTrees.push_back(new CanonicalHuffman<float>(in));
+  }
+
+  trees.alignTree = trees.containsAlignmentInfo ? new CanonicalHuffman<AlignPoint>(in) : NULL;
+}
+
+template <class Data>
+Data Read(CanonicalHuffman<Data> &tree, BitWrapper<> &bits, bool table)
+{
+  return table ? tree.Read(bits) : tree.ReadBitByBit(bits);
+}
+
+struct Result {
+  size_t symbols;
+  double checksum; // so both decoders can be compared
+};
+
+// the states of PhraseDecoder::DecodeCollection()
+void Decode(Trees &trees, string &encoded, bool table, Result &result)
+{
+  enum DecodeState { Symbol, Score, Alignment } state = Symbol;
+  const AlignPoint alignStopSymbol(-1, -1);
+  size_t numScores = 0;
+
+  BitWrapper<> bits(encoded);
+  while (bits.TellFromEnd()) {
+    bool done = false;
+    ++result.symbols;
+    if (state == Symbol) {
+      unsigned symbol = Read(*trees.symbolTree, bits, table);
+      result.checksum += symbol;
+      if (symbol == 0) {
+        state = Score;
+      }
+    } else if (state == Score) {
+      size_t idx = trees.multipleScoreTrees ? numScores : 0;
+      result.checksum += Read(*trees.scoreTrees[idx], bits, table);
+      if (++numScores == trees.numScoreComponent) {
+        numScores = 0;
+        state = Alignment;
+        done = !trees.containsAlignmentInfo;
+      }
+    } else {
+      AlignPoint alignPoint = Read(*trees.alignTree, bits, table);
+      result.checksum += alignPoint.first + alignPoint.second;
+      done = alignPoint == alignStopSymbol;
+    }
+
+    if (done) {
+      if (bits.TellFromEnd() <= 8) {
+        break;
+      }
+      state = Symbol;
+    }
+  }
+}
+
+void Run(Trees &trees, vector<string> &collections, bool table)
+{
+  Result result = {0, 0};
+  double start = util::CPUTime();
+  for (size_t i = 0; i < collections.size(); ++i) {
+    Decode(trees, collections[i], table, result);
+  }
+  double time = util::CPUTime() - start;
+  cout << (table ? "table" : "bit-by-bit") << ": " << result.symbols << " symbols, "
+       << time << "s, " << result.symbols / time << " symbols/s, checksum "
+       << result.checksum << endl;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) {
+    cerr << "Usage: " << argv[0] << " table.minphr [max-collections=1000000]" << endl;
+    return EXIT_FAILURE;
+  }
+  size_t maxCollections = argc > 2 ? atoi(argv[2]) : 1000000;
+
+  FILE *in = fopen(argv[1], "r");
+  UTIL_THROW_IF2(in == NULL, "Cannot open " << argv[1]);
+
+  // as PhraseDictionaryCompact::Load()
+  BlockHashIndex hash(10, 16);
+  hash.Load(in);
+
+  Trees trees;
+  LoadTrees(in, trees);
+
+  StringVector<unsigned char, size_t, MmapAllocator> targetPhrases;
+  targetPhrases.load(in, true);
+
+  // copied out first, so only decoding is timed
+  vector<string> collections;
+  for (size_t i = 0; i < targetPhrases.size() && i < maxCollections; ++i) {
+    collections.push_back(targetPhrases[i].str());
+  }
+  cout << "Collections: " << collections.size() << endl;
+
+  Run(trees, collections, false);
+  Run(trees, collections, true);
+
+  return EXIT_SUCCESS;
+}
@@ -15,7 +15,8 @@ void printHelp()
             "options: \n"
             "\t-in  string -- input table file name\n"
             "\t-out string -- prefix of binary table files\n"
-            "If -in is not specified reads from stdin\n"
+            "\t-format tree|probing -- binary format (default tree)\n"
+            "If -in is not specified reads from stdin (tree format only)\n"
             "\n";
 }
 
@@ -24,6 +25,7 @@ int main(int argc, char** argv)
   std::cerr << "processLexicalTable v0.1 by Konrad Rawlik\n";
   std::string inFilePath;
   std::string outFilePath("out");
+  std::string format("tree");
   if(1 >= argc) {
     printHelp();
     return 1;
@@ -36,6 +38,9 @@ int main(int argc, char** argv)
     } else if("-out" == arg && i+1 < argc) {
       ++i;
       outFilePath = argv[i];
+    } else if("-format" == arg && i+1 < argc) {
+      ++i;
+      format = argv[i];
     } else {
       //somethings wrong... print help
       printHelp();
@@ -45,7 +50,17 @@ int main(int argc, char** argv)
 
   bool success = false;
 
-  if(inFilePath.empty()) {
+  if(format == "probing") {
+    if(inFilePath.empty()) {
+      std::cerr << "The probing format needs -in, it reads the table twice\n";
+      return 1;
+    }
+    std::cerr << "processing " << inFilePath << " to " << outFilePath << ".problexr\n";
+    success = LexicalReorderingTableProbing::Create(inFilePath, outFilePath);
+  } else if(format != "tree") {
+    printHelp();
+    return 1;
+  } else if(inFilePath.empty()) {
     std::cerr << "processing stdin to " << outFilePath << ".*\n";
     success = LexicalReorderingTableTree::Create(std::cin, outFilePath);
   } else {
@@ -8,6 +8,7 @@
 #include "moses/TranslationModel/CompactPT/PhraseTableCreator.h"
 
 #include "util/file.hh"
+#include "util/usage.hh"
 
 using namespace Moses;
 
@@ -20,6 +21,7 @@ void printHelp(char **argv)
             "\t-T string         -- path to temporary directory (uses /tmp by default)\n"
             "\t-nscores int      -- number of score components in phrase table\n"
             "\t-no-alignment-info   -- do not include alignment info in the binary phrase table\n"
+            "\t-memory size      -- memory budget, e.g. 8G or 50% (default: no budget)\n"
 #ifdef WITH_THREADS
             "\t-threads int|all  -- number of threads used for conversion\n"
 #endif
@@ -67,6 +69,7 @@ int main(int argc, char **argv)
   bool sortScoreIndexSet = false;
   size_t sortScoreIndex = 2;
   bool warnMe = true;
+  size_t memory = 0;
   size_t threads =
 #ifdef WITH_THREADS
     boost::thread::hardware_concurrency() ? boost::thread::hardware_concurrency() :
@@ -124,6 +127,9 @@ int main(int argc, char **argv)
       quantize = atoi(argv[i]);
     } else if("-no-warnings" == arg) {
       warnMe = false;
+    } else if("-memory" == arg && i+1 < argc) {
+      ++i;
+      memory = util::ParseSize(argv[i]);
     } else if("-threads" == arg && i+1 < argc) {
 #ifdef WITH_THREADS
       ++i;
@@ -166,7 +172,7 @@ int main(int argc, char **argv)
                      numScoreComponent, sortScoreIndex,
                      coding, orderBits, fingerprintBits,
                      useAlignmentInfo, multipleScoreTrees,
-                     quantize, maxRank, warnMe
+                     quantize, maxRank, warnMe, memory
 #ifdef WITH_THREADS
                      , threads
 #endif
@@ -0,0 +1,96 @@
+// Contention benchmark for Moses::FactorCollection.
+//
+// Every thread interns words drawn from a shared vocabulary, as input parsing
+// and phrase-table lookups do while decoding. Most words are already interned,
+// a few are new. Reports lookups per second for 1..N threads, against the
+// sharded collection and with all calls funnelled through one reader-writer
+// lock, which is how the collection used to be guarded.
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "moses/FactorCollection.h"
+#include "util/usage.hh"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+boost::shared_mutex globalLock;
+
+void Run(const vector<string> &vocab, size_t numCalls, unsigned int seed, bool global)
+{
+  FactorCollection &collection = FactorCollection::Instance();
+  string fresh;
+  for (size_t i = 0; i < numCalls; ++i) {
+    // 1 in 1000 calls interns a word nobody has seen
+    seed = seed * 1103515245 + 12345;
+    const string *word = &vocab[(seed >> 8) % vocab.size()];
+    if ((seed >> 4) % 1000 == 0) {
+      fresh = *word + "@" + boost::lexical_cast<string>(seed);
+      word = &fresh;
+    }
+
+    if (global) {
+      boost::shared_lock<boost::shared_mutex> lock(globalLock);
+      collection.AddFactor(*word);
+    } else {
+      collection.AddFactor(*word);
+    }
+  }
+}
+
+double Time(const vector<string> &vocab, size_t numThreads, size_t numCalls, bool global)
+{
+  double start = util::WallTime();
+  boost::thread_group threads;
+  for (size_t i = 0; i < numThreads; ++i) {
+    threads.create_thread(boost::bind(&Run, boost::cref(vocab), numCalls, i + 1, global));
+  }
+  threads.join_all();
+  return util::WallTime() - start;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  size_t maxThreads = argc > 1 ? atoi(argv[1]) : boost::thread::hardware_concurrency();
+  size_t numCalls = argc > 2 ? atoi(argv[2]) : 1000000;
+  size_t vocabSize = argc > 3 ? atoi(argv[3]) : 100000;
+  if (maxThreads == 0 || numCalls == 0 || vocabSize == 0) {
+    cerr << "Usage: " << argv[0] << " [max-threads] [calls-per-thread=1000000] [vocab-size=100000]" << endl;
+    return EXIT_FAILURE;
+  }
+
+  vector<string> vocab(vocabSize);
+  for (size_t i = 0; i < vocabSize; ++i) {
+    vocab[i] = "word" + boost::lexical_cast<string>(i);
+    FactorCollection::Instance().AddFactor(vocab[i]);
+  }
+
+  // powers of two, then max-threads itself
+  vector<size_t> threadCounts;
+  for (size_t numThreads = 1; numThreads < maxThreads; numThreads *= 2) {
+    threadCounts.push_back(numThreads);
+  }
+  threadCounts.push_back(maxThreads);
+
+  cout << "threads\tsharded calls/s\tsingle lock calls/s" << endl;
+  for (size_t i = 0; i < threadCounts.size(); ++i) {
+    size_t numThreads = threadCounts[i];
+    double sharded = Time(vocab, numThreads, numCalls, false);
+    double single = Time(vocab, numThreads, numCalls, true);
+    cout << numThreads << "\t" << numThreads * numCalls / sharded
+         << "\t" << numThreads * numCalls / single << endl;
+  }
+  return EXIT_SUCCESS;
+}
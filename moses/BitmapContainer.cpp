@@ -225,7 +225,8 @@ Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const
     hypothesis.GetManager().GetSentenceStats().StartTimeBuildHyp();
   }
   const Bitmap &bitmap = m_parent.GetWordsBitmap();
-  Hypothesis *newHypo = new Hypothesis(hypothesis, transOpt, bitmap, hypothesis.GetManager().GetNextHypoId());
+  Manager &manager = hypothesis.GetManager();
+  Hypothesis *newHypo = new (manager.GetHypothesisPool()) Hypothesis(hypothesis, transOpt, bitmap, manager.GetNextHypoId());
   IFVERBOSE(2) {
     hypothesis.GetManager().GetSentenceStats().StopTimeBuildHyp();
   }
@@ -237,8 +238,7 @@ Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const
 bool
 BackwardsEdge::SeenPosition(const size_t x, const size_t y)
 {
-  boost::unordered_set< int >::iterator iter = m_seenPosition.find((x<<16) + y);
-  return (iter != m_seenPosition.end());
+  return m_seenPosition.find((x<<16) + y) != m_seenPosition.end();
 }
 
 void
@@ -331,7 +331,7 @@ BitmapContainer::Enqueue(int hypothesis_pos
 {
   // Only supply target phrase if running deterministic search mode
   const TargetPhrase *target_phrase = m_deterministic ? &(hypothesis->GetCurrTargetPhrase()) : NULL;
-  HypothesisQueueItem *item = new HypothesisQueueItem(hypothesis_pos
+  HypothesisQueueItem *item = new (hypothesis->GetManager().GetQueueItemPool()) HypothesisQueueItem(hypothesis_pos
       , translation_pos
       , hypothesis
       , edge
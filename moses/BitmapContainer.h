@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef moses_BitmapContainer_h
 #define moses_BitmapContainer_h
 
+#include <functional>
 #include <queue>
 #include <set>
 #include <vector>
@@ -32,8 +33,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TranslationOption.h"
 #include "TypeDef.h"
 #include "Bitmap.h"
+#include "ProbingSet.h"
 
-#include <boost/unordered_set.hpp>
+#include <boost/functional/hash.hpp>
 
 namespace Moses
 {
@@ -83,6 +85,17 @@ public:
   ~HypothesisQueueItem() {
   }
 
+  //! allocated from Manager::GetQueueItemPool()
+  static void *operator new(size_t size, RecyclingPool &pool) {
+    return pool.Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    RecyclingPool::Free(ptr);
+  }
+  static void operator delete(void *ptr, RecyclingPool &) {
+    RecyclingPool::Free(ptr);
+  }
+
   int GetHypothesisPos() {
     return m_hypothesis_pos;
   }
@@ -190,7 +203,7 @@ private:
   bool m_deterministic;
 
   std::vector< const Hypothesis* > m_hypotheses;
-  boost::unordered_set< int > m_seenPosition;
+  ProbingSet< int, boost::hash<int>, std::equal_to<int> > m_seenPosition;
 
   // We don't want to instantiate "empty" objects.
   BackwardsEdge();
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#endif
+
+#include "moses/FeatureVector.h"
+
+namespace Moses
+{
+
+class Factor;
+
+/** The FNames of sparse features named after a sequence of factors, such as
+ *  a word pair. A feature finds the FName by the factors instead of building
+ *  the name every time it fires. The name is only built, and interned, the
+ *  first time, for Add(). Factors is anything with size() and an operator[]
+ *  returning const Factor*.
+ */
+class FactorFeatureNames
+{
+public:
+  //! two factors, e.g. a source and a target word
+  struct Pair {
+    Pair(const Factor *first, const Factor *second)
+      : first(first), second(second) {}
+    size_t size() const {
+      return 2;
+    }
+    const Factor *operator[](size_t i) const {
+      return i ? second : first;
+    }
+    const Factor *first, *second;
+  };
+
+  template <class Factors>
+  const FName *Find(const Factors &factors) const {
+#ifdef WITH_THREADS
+    boost::shared_lock<boost::shared_mutex> lock(m_lock);
+#endif
+    Map::const_iterator i = m_names.find(factors, Hash(), Equals());
+    return i == m_names.end() ? NULL : &i->second;
+  }
+
+  template <class Factors>
+  const FName &Add(const Factors &factors, const FName &name) const {
+    Key key(factors.size());
+    for (size_t i = 0; i < key.size(); ++i) {
+      key[i] = factors[i];
+    }
+#ifdef WITH_THREADS
+    boost::unique_lock<boost::shared_mutex> lock(m_lock);
+#endif
+    // map nodes don't move, so Find() can return a pointer to the value
+    return m_names.insert(std::make_pair(key, name)).first->second;
+  }
+
+private:
+  typedef std::vector<const Factor*> Key;
+
+  struct Hash {
+    template <class Factors>
+    size_t operator()(const Factors &factors) const {
+      size_t seed = 0;
+      for (size_t i = 0; i < factors.size(); ++i) {
+        boost::hash_combine(seed, factors[i]);
+      }
+      return seed;
+    }
+  };
+
+  struct Equals {
+    template <class Factors>
+    bool operator()(const Factors &lhs, const Key &rhs) const {
+      if (lhs.size() != rhs.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < rhs.size(); ++i) {
+        if (lhs[i] != rhs[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+    template <class Factors>
+    bool operator()(const Key &lhs, const Factors &rhs) const {
+      return (*this)(rhs, lhs);
+    }
+    bool operator()(const Key &lhs, const Key &rhs) const {
+      return lhs == rhs;
+    }
+  };
+
+  typedef boost::unordered_map<Key, FName, Hash, Equals> Map;
+  mutable Map m_names;
+#ifdef WITH_THREADS
+  mutable boost::shared_mutex m_lock;
+#endif
+};
+
+}
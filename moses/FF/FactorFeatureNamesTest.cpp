@@ -0,0 +1,72 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2016- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "moses/FactorCollection.h"
+#include "FactorFeatureNames.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(factor_feature_names)
+
+BOOST_AUTO_TEST_CASE(pairs)
+{
+  FactorCollection &factors = FactorCollection::Instance();
+  const Factor *a = factors.AddFactor("a");
+  const Factor *b = factors.AddFactor("b");
+
+  FactorFeatureNames names;
+  FactorFeatureNames::Pair ab(a, b), ba(b, a), aOther(a, NULL);
+  BOOST_CHECK(!names.Find(ab));
+
+  const FName &added = names.Add(ab, FName("ff", "a~b"));
+  BOOST_CHECK(&added == names.Find(ab));
+  BOOST_CHECK_EQUAL(names.Find(ab)->name(), "ff_a~b");
+  BOOST_CHECK(!names.Find(ba));
+  BOOST_CHECK(!names.Find(aOther));
+
+  names.Add(aOther, FName("ff", "a~OTHER"));
+  BOOST_CHECK_EQUAL(names.Find(aOther)->name(), "ff_a~OTHER");
+  BOOST_CHECK(&added == names.Find(ab));
+}
+
+BOOST_AUTO_TEST_CASE(sequences)
+{
+  FactorCollection &factors = FactorCollection::Instance();
+  vector<const Factor*> abc, ab;
+  abc.push_back(factors.AddFactor("a"));
+  abc.push_back(factors.AddFactor("b"));
+  abc.push_back(factors.AddFactor("c"));
+  ab.assign(abc.begin(), abc.begin() + 2);
+
+  FactorFeatureNames names;
+  names.Add(abc, FName("ff", "a~b~c"));
+  BOOST_CHECK(!names.Find(ab));
+  names.Add(ab, FName("ff", "a~b"));
+
+  // a pair finds the same name as a sequence of the same factors
+  FactorFeatureNames::Pair pair(ab[0], ab[1]);
+  BOOST_CHECK(names.Find(pair) == names.Find(ab));
+  BOOST_CHECK_EQUAL(names.Find(abc)->name(), "ff_a~b~c");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,13 @@
 #include "moses/TargetPhrase.h"
 #include "moses/TargetPhraseCollection.h"
 #include "moses/TranslationTask.h"
+#include "util/file.hh"
+#include "util/murmur_hash.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
 
 #if !defined WIN32 || defined __MINGW32__ || defined HAVE_CMPH
 #include "moses/TranslationModel/CompactPT/LexicalReorderingTableCompact.h"
@@ -60,7 +67,10 @@ LoadAvailable(const std::string& filePath,
     return compactLexr;
 #endif
   LexicalReorderingTable* ret;
-  if (FileExists(filePath+".binlexr.idx") )
+  if (FileExists(filePath+".problexr"))
+    ret = new LexicalReorderingTableProbing(filePath, f_factors,
+                                            e_factors, c_factors);
+  else if (FileExists(filePath+".binlexr.idx") )
     ret = new LexicalReorderingTableTree(filePath, f_factors,
                                          e_factors, c_factors);
   else
@@ -589,5 +599,256 @@ Cache(const Sentence& input)
   std::cerr << "Cached " << m_Cache.size() - prev_cache_size
             << " new primary reordering table keys\n";
 }
+
+namespace
+{
+const char ProbingMagic[8] = "lexrpr1";
+const size_t ProbingMaxSamples = 1 << 20;
+
+// keys are chained hashes of the words of each field, and of a separator
+// after each field
+inline uint64_t auxHashToken(const StringPiece& token, uint64_t seed)
+{
+  return util::MurmurHash64A(token.data(), token.size(), seed);
+}
+
+inline uint64_t auxHashFieldEnd(uint64_t seed)
+{
+  return util::MurmurHash64A("|||", 3, seed);
+}
+
+// 0 marks empty buckets
+inline uint64_t auxValidKey(uint64_t key)
+{
+  return key ? key : 1;
+}
+
+// As LexicalReorderingTableMemory::LoadFromFile()
+Scores auxParseScores(const std::string& field)
+{
+  Scores p = Scan<float>(Tokenize(field));
+  std::transform(p.begin(),p.end(),p.begin(),TransformScore);
+  std::transform(p.begin(),p.end(),p.begin(),FloorScore);
+  return p;
+}
+
+// Every distinct value if there are few enough, else the means of bins with
+// equally many values
+void auxMakeCodebook(std::vector<float>& values, float* codebook, size_t size)
+{
+  std::sort(values.begin(), values.end());
+  std::vector<float> centers(values.begin(), values.end());
+  centers.erase(std::unique(centers.begin(), centers.end()), centers.end());
+  if(centers.size() > size) {
+    centers.clear();
+    for(size_t b = 0; b < size; ++b) {
+      size_t begin = b * values.size() / size;
+      size_t end = (b + 1) * values.size() / size;
+      if(begin == end) continue;
+      double sum = 0;
+      for(size_t i = begin; i < end; ++i) sum += values[i];
+      centers.push_back(sum / (end - begin));
+    }
+    centers.erase(std::unique(centers.begin(), centers.end()), centers.end());
+  }
+  if(centers.empty()) centers.push_back(0);
+
+  for(size_t i = 0; i < size; ++i)
+    codebook[i] = centers[std::min(i, centers.size() - 1)];
+}
+
+// nearest center, the codebook is sorted
+uint64_t auxEncode(float value, const float* codebook, size_t size)
+{
+  size_t i = std::lower_bound(codebook, codebook + size, value) - codebook;
+  if(i == size)
+    return size - 1;
+  if(i > 0 && value - codebook[i - 1] < codebook[i] - value)
+    return i - 1;
+  return i;
+}
+}
+
+bool
+LexicalReorderingTableProbing::
+Create(const std::string& inFilePath, const std::string& outFileName)
+{
+  // 1st pass: count entries and sample the scores for the codebooks
+  std::cerr << "Sampling scores...";
+  size_t numEntries = 0, numScores = 0, numKeyFields = 0;
+  std::vector<std::vector<float> > samples;
+  uint64_t random = 1;
+  {
+    InputFileStream file(inFilePath);
+    std::string line;
+    while(getline(file, line)) {
+      std::vector<std::string> tokens = TokenizeMultiCharSeparator(line, "|||");
+      Scores p = auxParseScores(tokens.back());
+      if(numEntries == 0) {
+        numKeyFields = tokens.size() - 1;
+        numScores = p.size();
+        UTIL_THROW_IF2(numScores == 0 || numScores > MAX_SCORES,
+                       "The binary format holds 1 to " << MAX_SCORES
+                       << " scores, found " << numScores);
+        samples.resize(numScores);
+      }
+      UTIL_THROW_IF2(tokens.size() - 1 != numKeyFields || p.size() != numScores,
+                     "Inconsistent number of fields or scores in line: " << line);
+
+      // reservoir sampling
+      random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+      size_t j = (random >> 16) % (numEntries + 1);
+      for(size_t i = 0; i < numScores; ++i) {
+        if(samples[i].size() < ProbingMaxSamples)
+          samples[i].push_back(p[i]);
+        else if(j < ProbingMaxSamples)
+          samples[i][j] = p[i];
+      }
+      ++numEntries;
+    }
+  }
+  std::cerr << "done.\n";
+  UTIL_THROW_IF2(numEntries == 0, "Empty reordering table " << inFilePath);
+
+  uint64_t tableBytes = Table::Size(numEntries, 1.5);
+  std::string fileName = outFileName + ".problexr";
+  util::scoped_fd fd;
+  util::scoped_mmap mem(util::MapZeroedWrite(fileName.c_str(),
+                        sizeof(Header) + tableBytes, fd),
+                        sizeof(Header) + tableBytes);
+
+  Header* header = new (mem.get()) Header;
+  std::memcpy(header->magic, ProbingMagic, sizeof(header->magic));
+  header->numScores = numScores;
+  header->numKeyFields = numKeyFields;
+  header->numEntries = numEntries;
+  header->tableBytes = tableBytes;
+  for(size_t i = 0; i < MAX_SCORES; ++i) {
+    if(i < numScores)
+      auxMakeCodebook(samples[i], header->codebook[i], CODEBOOK_SIZE);
+    else
+      std::fill(header->codebook[i], header->codebook[i] + CODEBOOK_SIZE, 0);
+  }
+
+  // 2nd pass: the hash table. The memory is zeroed, so all buckets are empty
+  std::cerr << "Creating hash table for " << numEntries << " entries...";
+  Table table(static_cast<char*>(mem.get()) + sizeof(Header), tableBytes);
+  InputFileStream file(inFilePath);
+  std::string line;
+  size_t duplicates = 0;
+  double sumError = 0, maxError = 0;
+  while(getline(file, line)) {
+    std::vector<std::string> tokens = TokenizeMultiCharSeparator(line, "|||");
+    uint64_t key = 0;
+    for(size_t t = 0; t < numKeyFields; ++t) {
+      std::vector<std::string> words = Tokenize(tokens[t]);
+      for(size_t i = 0; i < words.size(); ++i)
+        key = auxHashToken(words[i], key);
+      key = auxHashFieldEnd(key);
+    }
+
+    Entry entry;
+    entry.key = auxValidKey(key);
+    entry.codes = 0;
+    Scores p = auxParseScores(tokens.back());
+    for(size_t i = 0; i < numScores; ++i) {
+      uint64_t code = auxEncode(p[i], header->codebook[i], CODEBOOK_SIZE);
+      entry.codes |= code << (8 * i);
+      double error = std::abs(header->codebook[i][code] - p[i]);
+      sumError += error;
+      maxError = std::max(maxError, error);
+    }
+
+    // the last one wins, as in LexicalReorderingTableMemory
+    Table::MutableIterator it;
+    if(table.FindOrInsert(entry, it)) {
+      it->codes = entry.codes;
+      ++duplicates;
+    }
+  }
+  std::cerr << "done.\n";
+  if(duplicates)
+    std::cerr << "Warning: " << duplicates << " duplicate keys\n";
+  std::cerr << "Quantization error: mean " << sumError / (numEntries * numScores)
+            << ", max " << maxError << "\n";
+  return true;
+}
+
+LexicalReorderingTableProbing::
+LexicalReorderingTableProbing(const std::string& filePath,
+                              const std::vector<FactorType>& f_factors,
+                              const std::vector<FactorType>& e_factors,
+                              const std::vector<FactorType>& c_factors,
+                              util::LoadMethod load)
+  : LexicalReorderingTable(f_factors, e_factors, c_factors)
+{
+  std::string fileName = filePath + ".problexr";
+  util::scoped_fd fd(util::OpenReadOrThrow(fileName.c_str()));
+  uint64_t size = util::SizeOrThrow(fd.get());
+  UTIL_THROW_IF2(size < sizeof(Header), fileName << " is too small");
+  util::MapRead(load, fd.get(), 0, size, m_Memory);
+
+  m_Header = reinterpret_cast<const Header*>(m_Memory.get());
+  UTIL_THROW_IF2(std::memcmp(m_Header->magic, ProbingMagic, sizeof(m_Header->magic))
+                 || size != sizeof(Header) + m_Header->tableBytes,
+                 fileName << " is not a binary reordering table of this version");
+  size_t numKeyFields = !m_FactorsF.empty() + !m_FactorsE.empty() + !m_FactorsC.empty();
+  UTIL_THROW_IF2(m_Header->numKeyFields != numKeyFields,
+                 fileName << " has " << m_Header->numKeyFields
+                 << " key fields, the model type needs " << numKeyFields);
+
+  m_Table = Table(static_cast<char*>(m_Memory.get()) + sizeof(Header),
+                  m_Header->tableBytes);
+}
+
+uint64_t
+LexicalReorderingTableProbing::
+HashPhrase(const Phrase& phrase, size_t begin, const FactorList& factors,
+           uint64_t seed) const
+{
+  for(size_t i = begin; i < phrase.GetSize(); ++i) {
+    const Word& word = phrase.GetWord(i);
+    if(factors.size() == 1)
+      seed = auxHashToken(word.GetString(factors[0]), seed);
+    else
+      seed = auxHashToken(word.GetString(factors, false), seed);
+  }
+  return auxHashFieldEnd(seed);
+}
+
+Scores
+LexicalReorderingTableProbing::
+Find(uint64_t key) const
+{
+  Table::ConstIterator it;
+  if(!m_Table.Find(auxValidKey(key), it))
+    return Scores();
+
+  Scores ret(m_Header->numScores);
+  for(size_t i = 0; i < ret.size(); ++i)
+    ret[i] = m_Header->codebook[i][(it->codes >> (8 * i)) & 0xff];
+  return ret;
 }
 
+Scores
+LexicalReorderingTableProbing::
+GetScore(const Phrase& f, const Phrase& e, const Phrase& c)
+{
+  uint64_t key = 0;
+  if(!m_FactorsF.empty())
+    key = HashPhrase(f, 0, m_FactorsF, key);
+  if(!m_FactorsE.empty())
+    key = HashPhrase(e, 0, m_FactorsE, key);
+  if(m_FactorsC.empty())
+    return Find(key);
+
+  // from large to smaller context, as LexicalReorderingTableMemory
+  for(size_t i = 0; i <= c.GetSize(); ++i) {
+    Scores ret = Find(HashPhrase(c, i, m_FactorsC, key));
+    if(!ret.empty())
+      return ret;
+  }
+  return Scores();
+}
+
+}
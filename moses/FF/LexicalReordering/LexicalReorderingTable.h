@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 #include <iostream>
+#include <stdint.h>
 
 #ifdef WITH_THREADS
 #include <boost/thread/tss.hpp>
@@ -18,6 +19,8 @@
 #include "moses/ConfusionNet.h"
 #include "moses/Sentence.h"
 #include "moses/PrefixTreeMap.h"
+#include "util/mmap.hh"
+#include "util/probing_hash_table.hh"
 
 namespace Moses
 {
@@ -208,5 +211,66 @@ private:
 
 };
 
-}
+//! Binary table that is mmapped as is, without parsing or building anything at
+//! load time. A probing hash table maps a 64-bit hash of the key words to the
+//! scores, quantized to 8 bits with one 256-entry codebook per score
+class LexicalReorderingTableProbing
+  : public LexicalReorderingTable
+{
+public:
+  static const size_t MAX_SCORES = 8;
+  static const size_t CODEBOOK_SIZE = 256;
+
+  //! Create outFileName + ".problexr" from a text table, in two passes
+  static
+  bool
+  Create(const std::string& inFilePath, const std::string& outFileName);
+
+  LexicalReorderingTableProbing(const std::string& filePath,
+                                const std::vector<FactorType>& f_factors,
+                                const std::vector<FactorType>& e_factors,
+                                const std::vector<FactorType>& c_factors,
+                                util::LoadMethod load = util::POPULATE_OR_READ);
+
+  virtual
+  Scores
+  GetScore(const Phrase& f, const Phrase& e, const Phrase& c);
 
+private:
+  struct Header {
+    char magic[8];
+    uint64_t numScores;
+    uint64_t numKeyFields;
+    uint64_t numEntries;
+    uint64_t tableBytes;
+    float codebook[MAX_SCORES][CODEBOOK_SIZE];
+  };
+
+  struct Entry {
+    typedef uint64_t Key;
+    Key key;
+    uint64_t codes; // 8 bits per score, first score lowest
+
+    Key GetKey() const {
+      return key;
+    }
+    void SetKey(Key to) {
+      key = to;
+    }
+  };
+
+  typedef util::ProbingHashTable<Entry, util::IdentityHash> Table;
+
+  util::scoped_memory m_Memory;
+  const Header* m_Header;
+  Table m_Table;
+
+  uint64_t
+  HashPhrase(const Phrase& phrase, size_t begin, const FactorList& factors,
+             uint64_t seed) const;
+
+  Scores
+  Find(uint64_t key) const;
+};
+
+}
@@ -105,6 +105,15 @@ SparseReordering::SparseReordering(const map<string,string>& config, const Lexic
     }
   }
 
+  // look the weights up once rather than by feature name when they are used
+  if (m_useWeightMap) {
+    for (FeatureMap::const_iterator i = m_featureMap.begin(); i != m_featureMap.end(); ++i) {
+      WeightMap::const_iterator wmi = m_weightMap.find(i->second.name());
+      if (wmi != m_weightMap.end() && wmi->second != 0) {
+        m_featureWeights[i->first] = wmi->second;
+      }
+    }
+  }
 }
 
 void SparseReordering::PreCalculateFeatureNames(size_t index, const string& id, SparseReorderingFeatureKey::Side side, const Factor* factor, bool isCluster)
@@ -186,16 +195,14 @@ void SparseReordering::AddFeatures(
   for (size_t id = 0; id < wordLists->size(); ++id) {
     if ((*wordLists)[id].second.find(wordFactor) == (*wordLists)[id].second.end()) continue;
     SparseReorderingFeatureKey key(id, type, wordFactor, false, position, side, reoType);
-    FeatureMap::const_iterator fmi = m_featureMap.find(key);
-    assert(fmi != m_featureMap.end());
     if (m_useWeightMap) {
-      WeightMap::const_iterator wmi = m_weightMap.find(fmi->second.name());
-      if (wmi != m_weightMap.end()) {
-        if (wmi->second != 0) {
-          scores->SparsePlusEquals(m_featureMap2[reoType], wmi->second);
-        }
+      FeatureWeights::const_iterator fwi = m_featureWeights.find(key);
+      if (fwi != m_featureWeights.end()) {
+        scores->SparsePlusEquals(m_featureMap2[reoType], fwi->second);
       }
     } else {
+      FeatureMap::const_iterator fmi = m_featureMap.find(key);
+      assert(fmi != m_featureMap.end());
       scores->SparsePlusEquals(fmi->second, 1.0);
     }
   }
@@ -206,16 +213,14 @@ void SparseReordering::AddFeatures(
     = clusterMap.second.find(wordFactor);
     if (clusterIter != clusterMap.second.end()) {
       SparseReorderingFeatureKey key(id, type, clusterIter->second, true, position, side, reoType);
-      FeatureMap::const_iterator fmi = m_featureMap.find(key);
-      assert(fmi != m_featureMap.end());
       if (m_useWeightMap) {
-        WeightMap::const_iterator wmi = m_weightMap.find(fmi->second.name());
-        if (wmi != m_weightMap.end()) {
-          if (wmi->second != 0) {
-            scores->SparsePlusEquals(m_featureMap2[reoType], wmi->second);
-          }
+        FeatureWeights::const_iterator fwi = m_featureWeights.find(key);
+        if (fwi != m_featureWeights.end()) {
+          scores->SparsePlusEquals(m_featureMap2[reoType], fwi->second);
         }
       } else {
+        FeatureMap::const_iterator fmi = m_featureMap.find(key);
+        assert(fmi != m_featureMap.end());
         scores->SparsePlusEquals(fmi->second, 1.0);
       }
     }
@@ -116,6 +116,9 @@ private:
   WeightMap m_weightMap;
   bool m_useWeightMap;
   std::vector<FName> m_featureMap2;
+  // the non-zero weights of m_weightMap by the keys of m_featureMap
+  typedef boost::unordered_map<SparseReorderingFeatureKey, float, HashSparseReorderingFeatureKey, EqualsSparseReorderingFeatureKey> FeatureWeights;
+  FeatureWeights m_featureWeights;
 
   void ReadWordList(const std::string& filename, const std::string& id,
                     SparseReorderingFeatureKey::Side side, std::vector<WordList>* pWordLists);
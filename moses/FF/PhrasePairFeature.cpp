@@ -15,6 +15,38 @@ using namespace std;
 namespace Moses
 {
 
+namespace
+{
+// the source factors, NULL, then the target factors, to find a phrase pair in
+// FactorFeatureNames without copying them
+class PhrasePairFactors
+{
+public:
+  PhrasePairFactors(const Phrase &source, FactorType sourceFactorId,
+                    const Phrase &target, FactorType targetFactorId)
+    : m_source(source), m_sourceFactorId(sourceFactorId)
+    , m_target(target), m_targetFactorId(targetFactorId) {}
+
+  size_t size() const {
+    return m_source.GetSize() + 1 + m_target.GetSize();
+  }
+
+  const Factor *operator[](size_t i) const {
+    if (i < m_source.GetSize())
+      return m_source.GetWord(i).GetFactor(m_sourceFactorId);
+    if (i == m_source.GetSize())
+      return NULL;
+    return m_target.GetWord(i - m_source.GetSize() - 1).GetFactor(m_targetFactorId);
+  }
+
+private:
+  const Phrase &m_source;
+  FactorType m_sourceFactorId;
+  const Phrase &m_target;
+  FactorType m_targetFactorId;
+};
+}
+
 PhrasePairFeature::PhrasePairFeature(const std::string &line)
   :StatelessFeatureFunction(0, line)
   ,m_unrestricted(false)
@@ -241,22 +273,28 @@ void PhrasePairFeature::EvaluateInIsolation(const Phrase &source
     , ScoreComponentCollection &estimatedScores) const
 {
   if (m_simple) {
-    util::StringStream namestr;
-    namestr << m_description << "_";
-    namestr << ReplaceTilde( source.GetWord(0).GetFactor(m_sourceFactorId)->GetString() );
+    PhrasePairFactors pair(source, m_sourceFactorId, targetPhrase, m_targetFactorId);
+    const FName *fname = m_simpleNames.Find(pair);
+    if (fname) {
+      scoreBreakdown.SparsePlusEquals(*fname, 1);
+      return;
+    }
+
+    // construct feature name, the first time the phrase pair is seen
+    string name = ReplaceTilde( source.GetWord(0).GetFactor(m_sourceFactorId)->GetString() );
     for (size_t i = 1; i < source.GetSize(); ++i) {
       const Factor* sourceFactor = source.GetWord(i).GetFactor(m_sourceFactorId);
-      namestr << "~";
-      namestr << ReplaceTilde( sourceFactor->GetString() );
+      name += "~";
+      name += ReplaceTilde( sourceFactor->GetString() );
     }
-    namestr << "~~";
-    namestr << ReplaceTilde( targetPhrase.GetWord(0).GetFactor(m_targetFactorId)->GetString() );
+    name += "~~";
+    name += ReplaceTilde( targetPhrase.GetWord(0).GetFactor(m_targetFactorId)->GetString() );
     for (size_t i = 1; i < targetPhrase.GetSize(); ++i) {
       const Factor* targetFactor = targetPhrase.GetWord(i).GetFactor(m_targetFactorId);
-      namestr << "~";
-      namestr << ReplaceTilde( targetFactor->GetString() );
+      name += "~";
+      name += ReplaceTilde( targetFactor->GetString() );
     }
-    scoreBreakdown.SparsePlusEquals(namestr.str(),1);
+    scoreBreakdown.SparsePlusEquals(m_simpleNames.Add(pair, GetFeatureName(name)), 1);
   }
 }
 
@@ -3,6 +3,7 @@
 #include <stdexcept>
 #include <boost/unordered_set.hpp>
 
+#include "FactorFeatureNames.h"
 #include "StatelessFeatureFunction.h"
 #include "moses/Factor.h"
 #include "moses/Sentence.h"
@@ -30,6 +31,8 @@ class PhrasePairFeature: public StatelessFeatureFunction
   bool m_ignorePunctuation;
   CharHash m_punctuationHash;
   std::string m_filePathSource;
+  // simple features by source and target phrase factors
+  FactorFeatureNames m_simpleNames;
 
   inline std::string ReplaceTilde(const StringPiece &str) const {
     std::string out = str.as_string();
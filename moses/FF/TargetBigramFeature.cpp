@@ -34,7 +34,7 @@ TargetBigramFeature::TargetBigramFeature(const std::string &line)
   const Factor* bosFactor =
     factorCollection.AddFactor(Output,m_factorType,BOS_);
   m_bos.SetFactor(m_factorType,bosFactor);
-
+  m_eos = factorCollection.AddFactor(Output,m_factorType,EOS_);
 }
 
 void TargetBigramFeature::SetParameter(const std::string& key, const std::string& value)
@@ -103,26 +103,36 @@ FFState* TargetBigramFeature::EvaluateWhenApplied(const Hypothesis& cur_hypo,
       continue;
     }
 
-    string name(w1.data(), w1.size());
-    name += ":";
-    name.append(w2.data(), w2.size());
-    accumulator->PlusEquals(this,name,1);
+    accumulator->SparsePlusEquals(GetBigramName(f1, f2), 1);
   }
 
   if (cur_hypo.GetWordsBitmap().IsComplete()) {
-    const StringPiece w1 = targetPhrase.GetWord(targetPhrase.GetSize()-1).GetFactor(m_factorType)->GetString();
-    const string& w2 = EOS_;
-    if (m_vocab.empty() || (FindStringPiece(m_vocab, w1) != m_vocab.end())) {
-      string name(w1.data(), w1.size());
-      name += ":";
-      name += w2;
-      accumulator->PlusEquals(this,name,1);
+    const Factor* f1 = targetPhrase.GetWord(targetPhrase.GetSize()-1).GetFactor(m_factorType);
+    if (m_vocab.empty() || (FindStringPiece(m_vocab, f1->GetString()) != m_vocab.end())) {
+      accumulator->SparsePlusEquals(GetBigramName(f1, m_eos), 1);
     }
     return NULL;
   }
   return new TargetBigramState(targetPhrase.GetWord(targetPhrase.GetSize()-1));
 }
 
+const FName &TargetBigramFeature::GetBigramName(const Factor *f1, const Factor *f2) const
+{
+  FactorFeatureNames::Pair bigram(f1, f2);
+  const FName *fname = m_bigramNames.Find(bigram);
+  if (fname) {
+    return *fname;
+  }
+
+  // the first time the bigram is seen
+  const StringPiece w1 = f1->GetString();
+  const StringPiece w2 = f2->GetString();
+  string name(w1.data(), w1.size());
+  name += ":";
+  name.append(w2.data(), w2.size());
+  return m_bigramNames.Add(bigram, GetFeatureName(name));
+}
+
 bool TargetBigramFeature::IsUseable(const FactorMask &mask) const
 {
   bool ret = mask[m_factorType];
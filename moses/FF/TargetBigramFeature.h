@@ -6,6 +6,7 @@
 #include <boost/unordered_set.hpp>
 
 #include "moses/FF/FFState.h"
+#include "FactorFeatureNames.h"
 #include "StatefulFeatureFunction.h"
 #include "moses/FactorCollection.h"
 #include "moses/Word.h"
@@ -54,8 +55,13 @@ public:
 private:
   FactorType m_factorType;
   Word m_bos;
+  const Factor *m_eos;
   std::string m_filePath;
   boost::unordered_set<std::string> m_vocab;
+  // bigram features by their two factors
+  FactorFeatureNames m_bigramNames;
+
+  const FName &GetBigramName(const Factor *f1, const Factor *f2) const;
 };
 
 }
@@ -5,6 +5,7 @@
 
 #include "moses/FactorCollection.h"
 #include "moses/Sentence.h"
+#include "FactorFeatureNames.h"
 #include "StatelessFeatureFunction.h"
 
 namespace Moses
@@ -33,6 +34,8 @@ private:
   CharHash m_punctuationHash;
   std::string m_filePathSource;
   std::string m_filePathTarget;
+  // simple features by source and target factor, NULL for OTHER
+  FactorFeatureNames m_simpleNames;
 
 public:
   WordTranslationFeature(const std::string &line);
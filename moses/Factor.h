@@ -45,9 +45,10 @@ class Factor
   friend struct FactorFriend;
 
   // FactorCollection writes here.
-  // This is mutable so the pointer can be changed to pool-backed memory.
+  // These are mutable so the pointer can be changed to pool-backed memory,
+  // and the id assigned, once the factor is in the set.
   mutable StringPiece m_string;
-  size_t			m_id;
+  mutable size_t			m_id;
 
   //! protected constructor. only friend class, FactorCollection, is allowed to create Factor objects
   Factor() {}
@@ -39,28 +39,31 @@ const Factor *FactorCollection::AddFactor(const StringPiece &factorString, bool
 {
   FactorFriend to_ins;
   to_ins.in.m_string = factorString;
-  to_ins.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
+  Shard &shard = GetShard(factorString, isNonTerminal);
   // If we're threaded, hope a read-only lock is sufficient.
 #ifdef WITH_THREADS
   {
     // read=lock scope
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
-    Set::const_iterator i = set.find(to_ins);
-    if (i != set.end()) return &i->in;
+    boost::shared_lock<boost::shared_mutex> read_lock(shard.accessLock);
+    Set::const_iterator i = shard.set.find(to_ins);
+    if (i != shard.set.end()) return &i->in;
   }
-  boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
+  boost::unique_lock<boost::shared_mutex> lock(shard.accessLock);
 #endif // WITH_THREADS
-  std::pair<Set::iterator, bool> ret(set.insert(to_ins));
+  std::pair<Set::iterator, bool> ret(shard.set.insert(to_ins));
   if (ret.second) {
     ret.first->in.m_string.set(
-      memcpy(m_string_backing.Allocate(factorString.size()), factorString.data(), factorString.size()),
+      memcpy(shard.string_backing.Allocate(factorString.size()), factorString.data(), factorString.size()),
       factorString.size());
+
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock idLock(m_idLock);
+#endif // WITH_THREADS
     if (isNonTerminal) {
-      m_factorIdNonTerminal++;
+      ret.first->in.m_id = m_factorIdNonTerminal++;
       UTIL_THROW_IF2(m_factorIdNonTerminal >= moses_MaxNumNonterminals, "Number of non-terminals exceeds maximum size reserved. Adjust parameter moses_MaxNumNonterminals, then recompile");
     } else {
-      m_factorId++;
+      ret.first->in.m_id = m_factorId++;
     }
   }
   return &ret.first->in;
@@ -70,15 +73,14 @@ const Factor *FactorCollection::GetFactor(const StringPiece &factorString, bool
 {
   FactorFriend to_find;
   to_find.in.m_string = factorString;
-  to_find.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
+  const Shard &shard = GetShard(factorString, isNonTerminal);
   {
     // read=lock scope
 #ifdef WITH_THREADS
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+    boost::shared_lock<boost::shared_mutex> read_lock(shard.accessLock);
 #endif // WITH_THREADS
-    Set::const_iterator i = set.find(to_find);
-    if (i != set.end()) return &i->in;
+    Set::const_iterator i = shard.set.find(to_find);
+    if (i != shard.set.end()) return &i->in;
   }
   return NULL;
 }
@@ -91,11 +93,14 @@ TO_STRING_BODY(FactorCollection);
 // friend
 ostream& operator<<(ostream& out, const FactorCollection& factorCollection)
 {
+  for (size_t shardInd = 0; shardInd < FactorCollection::NUM_SHARDS; ++shardInd) {
+    const FactorCollection::Shard &shard = factorCollection.m_shards[shardInd];
 #ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(factorCollection.m_accessLock);
+    boost::shared_lock<boost::shared_mutex> lock(shard.accessLock);
 #endif
-  for (FactorCollection::Set::const_iterator i = factorCollection.m_set.begin(); i != factorCollection.m_set.end(); ++i) {
-    out << i->in;
+    for (FactorCollection::Set::const_iterator i = shard.set.begin(); i != shard.set.end(); ++i) {
+      out << i->in;
+    }
   }
   return out;
 }
@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #endif
 
 #ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #endif
 
@@ -81,15 +82,27 @@ class FactorCollection
     }
   };
   typedef boost::unordered_set<FactorFriend, HashFactor, EqualsFactor> Set;
-  Set m_set;
-  Set m_setNonTerminal;
 
-  util::Pool m_string_backing;
+  /** Factors are spread over independently locked shards by the hash of
+   * their string, so threads interning different strings rarely wait for
+   * each other. Strings are copied into the shard's own pool.
+   */
+  struct Shard {
+    Set set;
+    util::Pool string_backing;
+#ifdef WITH_THREADS
+    //reader-writer lock
+    mutable boost::shared_mutex accessLock;
+#endif
+  };
+  static const size_t NUM_SHARDS = 64;
+  Shard m_shards[NUM_SHARDS];
+  Shard m_shardsNonTerminal[NUM_SHARDS];
 
   static FactorCollection s_instance;
 #ifdef WITH_THREADS
-  //reader-writer lock
-  mutable boost::shared_mutex m_accessLock;
+  // taken after a shard's write lock, only to number a new factor
+  boost::mutex m_idLock;
 #endif
 
   size_t m_factorIdNonTerminal; /**< unique, contiguous ids, starting from 0, for each non-terminal factor */
@@ -101,6 +114,13 @@ class FactorCollection
     , m_factorId(moses_MaxNumNonterminals) {
   }
 
+  Shard &GetShard(const StringPiece &factorString, bool isNonTerminal) {
+    std::size_t hash = util::MurmurHashNative(factorString.data(), factorString.size());
+    // the low bits pick the bucket inside the shard's set
+    Shard *shards = isNonTerminal ? m_shardsNonTerminal : m_shards;
+    return shards[(hash >> 24) % NUM_SHARDS];
+  }
+
 public:
   static FactorCollection& Instance() {
     return s_instance;
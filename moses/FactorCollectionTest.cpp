@@ -0,0 +1,101 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2016- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#endif
+
+#include "FactorCollection.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(factor_collection)
+
+namespace
+{
+const size_t NUM_WORDS = 2000;
+
+string TestWord(size_t i)
+{
+  return "factor_collection_test_" + boost::lexical_cast<string>(i);
+}
+
+// every thread interns the same words, starting at a different offset
+void AddAll(size_t offset, vector<const Factor*> &out)
+{
+  FactorCollection &collection = FactorCollection::Instance();
+  out.resize(NUM_WORDS);
+  for (size_t i = 0; i < NUM_WORDS; ++i) {
+    size_t ind = (i + offset) % NUM_WORDS;
+    out[ind] = collection.AddFactor(TestWord(ind));
+  }
+}
+}
+
+BOOST_AUTO_TEST_CASE(add_and_get)
+{
+  FactorCollection &collection = FactorCollection::Instance();
+  const Factor *factor = collection.AddFactor("factor_collection_test_word");
+  BOOST_CHECK_EQUAL(factor, collection.AddFactor("factor_collection_test_word"));
+  BOOST_CHECK_EQUAL(factor, collection.GetFactor("factor_collection_test_word"));
+  BOOST_CHECK_EQUAL(string("factor_collection_test_word"), factor->GetString().as_string());
+  BOOST_CHECK(!collection.GetFactor("factor_collection_test_missing"));
+
+  // non-terminals are kept apart and numbered separately
+  const Factor *nonTerm = collection.AddFactor("factor_collection_test_word", true);
+  BOOST_CHECK(factor != nonTerm);
+  BOOST_CHECK(nonTerm->GetId() < collection.GetNumNonTerminals());
+  BOOST_CHECK(factor->GetId() >= moses_MaxNumNonterminals);
+}
+
+#ifdef WITH_THREADS
+BOOST_AUTO_TEST_CASE(concurrent_add)
+{
+  const size_t numThreads = 8;
+  vector<vector<const Factor*> > results(numThreads);
+  boost::thread_group threads;
+  for (size_t i = 0; i < numThreads; ++i) {
+    threads.create_thread(boost::bind(&AddAll, i * NUM_WORDS / numThreads, boost::ref(results[i])));
+  }
+  threads.join_all();
+
+  // all threads got the same factor for a word, and every word has its own id
+  set<size_t> ids;
+  for (size_t word = 0; word < NUM_WORDS; ++word) {
+    const Factor *factor = results[0][word];
+    BOOST_REQUIRE(factor);
+    BOOST_CHECK_EQUAL(TestWord(word), factor->GetString().as_string());
+    for (size_t thread = 1; thread < numThreads; ++thread) {
+      BOOST_CHECK_EQUAL(factor, results[thread][word]);
+    }
+    ids.insert(factor->GetId());
+  }
+  BOOST_CHECK_EQUAL(NUM_WORDS, ids.size());
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,9 +19,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <stdint.h>
 
 #if defined __MINGW32__ && defined WITH_THREADS
 #include <boost/thread/locks.hpp>
@@ -38,53 +40,182 @@ namespace Moses
 {
 
 const string FName::SEP = "_";
-FName::Name2Id FName::name2id;
-vector<string> FName::id2name;
+const size_t FName::NUM_SHARDS;
 FName::Id2Count FName::id2hopeCount;
 FName::Id2Count FName::id2fearCount;
+const size_t FName::CHUNK_BITS;
+const size_t FName::MAX_CHUNKS;
+FName::Chunk FName::id2name[FName::MAX_CHUNKS];
+size_t FName::numNames = 0;
 #ifdef WITH_THREADS
 boost::shared_mutex FName::m_idLock;
 #endif
 
-void FName::init(const StringPiece &name)
+namespace
 {
+// FNV-1a, so a name can be hashed piece by piece
+const uint64_t NAME_HASH_SEED = 14695981039346656037ULL;
+
+inline uint64_t HashAppend(uint64_t hash, const StringPiece &str)
+{
+  for (size_t i = 0; i < str.size(); ++i) {
+    hash ^= static_cast<unsigned char>(str[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+}
+
+//! a name, or root SEP name, without assembling it
+struct FName::Key {
+  StringPiece root, name;
+  bool hasRoot;
+  uint64_t hash;
+
+  Key(const StringPiece &root, const StringPiece &name, bool hasRoot)
+    : root(root), name(name), hasRoot(hasRoot) {
+    hash = NAME_HASH_SEED;
+    if (hasRoot) {
+      hash = HashAppend(HashAppend(hash, root), SEP);
+    }
+    hash = HashAppend(hash, name);
+  }
+
+  size_t size() const {
+    return hasRoot ? root.size() + SEP.size() + name.size() : name.size();
+  }
+
+  bool operator==(const std::string &str) const {
+    if (size() != str.size()) {
+      return false;
+    }
+    if (!hasRoot) {
+      return name == str;
+    }
+    const char *pos = str.data();
+    return !memcmp(pos, root.data(), root.size())
+           && !memcmp(pos + root.size(), SEP.data(), SEP.size())
+           && !memcmp(pos + root.size() + SEP.size(), name.data(), name.size());
+  }
+
+  std::string str() const {
+    std::string ret;
+    ret.reserve(size());
+    if (hasRoot) {
+      ret.append(root.data(), root.size());
+      ret += SEP;
+    }
+    ret.append(name.data(), name.size());
+    return ret;
+  }
+};
+
+struct FName::Shard {
+  struct Hash {
+    size_t operator()(const std::string &str) const {
+      return HashAppend(NAME_HASH_SEED, str);
+    }
+    size_t operator()(const Key &key) const {
+      return key.hash;
+    }
+  };
+  struct Equals {
+    bool operator()(const std::string &lhs, const std::string &rhs) const {
+      return lhs == rhs;
+    }
+    bool operator()(const Key &lhs, const std::string &rhs) const {
+      return lhs == rhs;
+    }
+    bool operator()(const std::string &lhs, const Key &rhs) const {
+      return rhs == lhs;
+    }
+  };
+  typedef boost::unordered_map<std::string, size_t, Hash, Equals> Map;
+
+  Map map;
 #ifdef WITH_THREADS
-  //reader lock
-  boost::shared_lock<boost::shared_mutex> lock(m_idLock);
+  boost::shared_mutex lock;
 #endif
-  Name2Id::iterator i = FindStringPiece(name2id, name);
-  if (i != name2id.end()) {
-    m_id = i->second;
-  } else {
+};
+
+FName::Shard FName::shards[FName::NUM_SHARDS];
+
+static inline size_t GetShardIndex(uint64_t hash, size_t numShards)
+{
+  // the maps use the low bits
+  return (hash >> 32) % numShards;
+}
+
+bool FName::find(const Key &key, size_t &id)
+{
+  Shard &shard = shards[GetShardIndex(key.hash, NUM_SHARDS)];
 #ifdef WITH_THREADS
-    //release the reader lock, and upgrade to writer lock
-    lock.unlock();
-    boost::unique_lock<boost::shared_mutex> write_lock(m_idLock);
+  boost::shared_lock<boost::shared_mutex> lock(shard.lock);
 #endif
-    std::pair<std::string, size_t> to_ins;
-    to_ins.first.assign(name.data(), name.size());
-    to_ins.second = name2id.size();
-    std::pair<Name2Id::iterator, bool> res(name2id.insert(to_ins));
-    if (res.second) {
-      // TODO this should be string pointers backed by the hash table.
-      id2name.push_back(to_ins.first);
-    }
-    m_id = res.first->second;
+  Shard::Map::const_iterator i = shard.map.find(key, Shard::Hash(), Shard::Equals());
+  if (i == shard.map.end()) {
+    return false;
+  }
+  id = i->second;
+  return true;
+}
+
+void FName::init(const StringPiece &root, const StringPiece &name, bool hasRoot)
+{
+  Key key(root, name, hasRoot);
+  if (find(key, m_id)) {
+    return;
+  }
+
+  Shard &shard = shards[GetShardIndex(key.hash, NUM_SHARDS)];
+#ifdef WITH_THREADS
+  boost::unique_lock<boost::shared_mutex> lock(shard.lock);
+#endif
+  // another thread may have added it in the meantime
+  Shard::Map::iterator i = shard.map.find(key, Shard::Hash(), Shard::Equals());
+  if (i == shard.map.end()) {
+    i = shard.map.insert(std::make_pair(key.str(), size_t(0))).first;
+    i->second = addName(&i->first);
   }
+  m_id = i->second;
+}
+
+size_t FName::addName(const std::string *name)
+{
+#ifdef WITH_THREADS
+  boost::unique_lock<boost::shared_mutex> lock(m_idLock);
+#endif
+  size_t id = numNames;
+  size_t chunk = id >> CHUNK_BITS;
+  UTIL_THROW_IF2(chunk >= MAX_CHUNKS, "Too many feature names");
+#ifdef WITH_THREADS
+  Slot *slots = id2name[chunk].load(boost::memory_order_relaxed);
+  if (!slots) {
+    slots = new Slot[1 << CHUNK_BITS];
+    id2name[chunk].store(slots, boost::memory_order_release);
+  }
+  slots[id & ((1 << CHUNK_BITS) - 1)].store(name, boost::memory_order_release);
+#else
+  if (!id2name[chunk]) {
+    id2name[chunk] = new Slot[1 << CHUNK_BITS];
+  }
+  id2name[chunk][id & ((1 << CHUNK_BITS) - 1)] = name;
+#endif
+  return numNames++;
 }
 
 size_t FName::getId(const string& name)
 {
-  Name2Id::iterator i = name2id.find(name);
-  assert (i != name2id.end());
-  return i->second;
+  size_t id = 0;
+  bool found = find(Key(StringPiece(), name, false), id);
+  assert(found);
+  return id;
 }
 
 size_t FName::getHopeIdCount(const string& name)
 {
-  Name2Id::iterator i = name2id.find(name);
-  if (i != name2id.end()) {
-    float id = i->second;
+  size_t id;
+  if (find(Key(StringPiece(), name, false), id)) {
     return id2hopeCount[id];
   }
   return 0;
@@ -92,9 +223,8 @@ size_t FName::getHopeIdCount(const string& name)
 
 size_t FName::getFearIdCount(const string& name)
 {
-  Name2Id::iterator i = name2id.find(name);
-  if (i != name2id.end()) {
-    float id = i->second;
+  size_t id;
+  if (find(Key(StringPiece(), name, false), id)) {
     return id2fearCount[id];
   }
   return 0;
@@ -102,26 +232,24 @@ size_t FName::getFearIdCount(const string& name)
 
 void FName::incrementHopeId(const string& name)
 {
-  Name2Id::iterator i = name2id.find(name);
-  assert(i != name2id.end());
+  size_t id = getId(name);
 #ifdef WITH_THREADS
   // get upgradable lock and upgrade to writer lock
   boost::upgrade_lock<boost::shared_mutex> upgradeLock(m_idLock);
   boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(upgradeLock);
 #endif
-  id2hopeCount[i->second] += 1;
+  id2hopeCount[id] += 1;
 }
 
 void FName::incrementFearId(const string& name)
 {
-  Name2Id::iterator i = name2id.find(name);
-  assert(i != name2id.end());
+  size_t id = getId(name);
 #ifdef WITH_THREADS
   // get upgradable lock and upgrade to writer lock
   boost::upgrade_lock<boost::shared_mutex> upgradeLock(m_idLock);
   boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(upgradeLock);
 #endif
-  id2fearCount[i->second] += 1;
+  id2fearCount[id] += 1;
 }
 
 void FName::eraseId(size_t id)
@@ -135,6 +263,14 @@ void FName::eraseId(size_t id)
   id2fearCount.erase(id);
 }
 
+size_t FName::getNumNames()
+{
+#ifdef WITH_THREADS
+  boost::shared_lock<boost::shared_mutex> lock(m_idLock);
+#endif
+  return numNames;
+}
+
 std::ostream& operator<<( std::ostream& out, const FName& name)
 {
   out << name.name();
@@ -148,7 +284,13 @@ size_t FName::hash() const
 
 const std::string& FName::name() const
 {
-  return id2name[m_id];
+  size_t slot = m_id & ((1 << CHUNK_BITS) - 1);
+#ifdef WITH_THREADS
+  const Slot *slots = id2name[m_id >> CHUNK_BITS].load(boost::memory_order_acquire);
+  return *slots[slot].load(boost::memory_order_acquire);
+#else
+  return *id2name[m_id >> CHUNK_BITS][slot];
+#endif
 }
 
 
@@ -162,20 +304,82 @@ bool FName::operator!=(const FName& rhs) const
   return ! (*this == rhs);
 }
 
+const size_t FDenseVector::INLINE_SIZE;
+
+FDenseVector::FDenseVector(size_t size)
+  : m_values(size > INLINE_SIZE ? new FValue[size] : m_inline)
+  , m_size(size)
+{
+  fill(0);
+}
+
+FDenseVector::FDenseVector(const FDenseVector &other)
+  : m_values(other.m_size > INLINE_SIZE ? new FValue[other.m_size] : m_inline)
+  , m_size(other.m_size)
+{
+  std::copy(other.begin(), other.end(), m_values);
+}
+
+FDenseVector &FDenseVector::operator=(const FDenseVector &other)
+{
+  if (this != &other) {
+    if (other.m_size > INLINE_SIZE && other.m_size > m_size) {
+      FValue *values = new FValue[other.m_size];
+      if (m_values != m_inline) {
+        delete [] m_values;
+      }
+      m_values = values;
+    } else if (other.m_size <= INLINE_SIZE && m_values != m_inline) {
+      delete [] m_values;
+      m_values = m_inline;
+    }
+    m_size = other.m_size;
+    std::copy(other.begin(), other.end(), m_values);
+  }
+  return *this;
+}
+
+void FDenseVector::resize(size_t newSize)
+{
+  // allocated storage may be longer than m_size, but isn't grown into
+  if (newSize > INLINE_SIZE && newSize > m_size) {
+    FValue *values = new FValue[newSize];
+    std::copy(begin(), end(), values);
+    if (m_values != m_inline) {
+      delete [] m_values;
+    }
+    m_values = values;
+  } else if (newSize <= INLINE_SIZE && m_values != m_inline) {
+    std::copy(m_values, m_values + min(m_size, newSize), m_inline);
+    delete [] m_values;
+    m_values = m_inline;
+  }
+  std::fill(m_values + min(m_size, newSize), m_values + newSize, FValue(0));
+  m_size = newSize;
+}
+
+void FDenseVector::fill(FValue value)
+{
+  std::fill(begin(), end(), value);
+}
+
+void swap(FDenseVector &first, FDenseVector &second)
+{
+  FDenseVector tmp(first);
+  first = second;
+  second = tmp;
+}
+
 FVector::FVector(size_t coreFeatures) : m_coreFeatures(coreFeatures) {}
 
 void FVector::resize(size_t newsize)
 {
-  valarray<FValue> oldValues(m_coreFeatures);
   m_coreFeatures.resize(newsize);
-  for (size_t i = 0; i < min(m_coreFeatures.size(), oldValues.size()); ++i) {
-    m_coreFeatures[i] = oldValues[i];
-  }
 }
 
 void FVector::clear()
 {
-  m_coreFeatures.resize(m_coreFeatures.size(), 0);
+  m_coreFeatures.fill(0);
   m_features.clear();
 }
 
@@ -372,8 +576,7 @@ FVector& FVector::operator+= (const FVector& rhs)
     resize(rhs.m_coreFeatures.size());
   for (const_iterator i = rhs.cbegin(); i != rhs.cend(); ++i)
     set(i->first, get(i->first) + i->second);
-  for (size_t i = 0; i < rhs.m_coreFeatures.size(); ++i)
-    m_coreFeatures[i] += rhs.m_coreFeatures[i];
+  m_coreFeatures.plusEquals(rhs.m_coreFeatures);
   return *this;
 }
 
@@ -389,8 +592,7 @@ void FVector::corePlusEquals(const FVector& rhs)
 {
   if (rhs.m_coreFeatures.size() > m_coreFeatures.size())
     resize(rhs.m_coreFeatures.size());
-  for (size_t i = 0; i < rhs.m_coreFeatures.size(); ++i)
-    m_coreFeatures[i] += rhs.m_coreFeatures[i];
+  m_coreFeatures.plusEquals(rhs.m_coreFeatures);
 }
 
 // assign only core features
@@ -608,7 +810,9 @@ FVector& FVector::operator*= (const FValue& rhs)
   for (iterator i = begin(); i != end(); ++i) {
     i->second *= rhs;
   }
-  m_coreFeatures *= rhs;
+  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
+    m_coreFeatures[i] *= rhs;
+  }
   return *this;
 }
 
@@ -617,7 +821,9 @@ FVector& FVector::operator/= (const FValue& rhs)
   for (iterator i = begin(); i != end(); ++i) {
     i->second /= rhs;
   }
-  m_coreFeatures /= rhs;
+  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
+    m_coreFeatures[i] /= rhs;
+  }
   return *this;
 }
 
@@ -798,7 +1004,9 @@ FValue FVector::sum() const
   for (const_iterator i = cbegin(); i != cend(); ++i) {
     sum += i->second;
   }
-  sum += m_coreFeatures.sum();
+  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
+    sum += m_coreFeatures[i];
+  }
   return sum;
 }
 
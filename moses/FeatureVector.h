@@ -22,11 +22,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef FEATUREVECTOR_H
 #define FEATUREVECTOR_H
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
-#include <valarray>
 #include <vector>
 
 #include <boost/functional/hash.hpp>
@@ -37,10 +37,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
-#include <boost/serialization/valarray.hpp>
 #endif
 
 #ifdef WITH_THREADS
+#include <boost/atomic.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #endif
 
@@ -59,25 +59,22 @@ struct FName {
 
   static const std::string SEP;
 
-  typedef boost::unordered_map<std::string,size_t> Name2Id;
   typedef boost::unordered_map<size_t,size_t> Id2Count;
-  //typedef std::map<std::string, size_t> Name2Id;
-  static Name2Id name2id;
-  static std::vector<std::string> id2name;
   static Id2Count id2hopeCount;
   static Id2Count id2fearCount;
 
   //A feature name can either be initialised as a pair of strings,
   //which will be concatenated with a SEP between them, or as
   //a single string, which will be used as-is.
+  //Names are interned in a table split into independently locked shards.
+  //Looking up a name that is already there doesn't allocate, but feature
+  //functions with a fixed set of names should still create their FNames
+  //once, e.g. with FeatureFunction::GetFeatureName()
   FName(const StringPiece &root, const StringPiece &name) {
-    std::string assembled(root.data(), root.size());
-    assembled += SEP;
-    assembled.append(name.data(), name.size());
-    init(assembled);
+    init(root, name, true);
   }
   explicit FName(const StringPiece &name) {
-    init(name);
+    init(StringPiece(), name, false);
   }
 
   const std::string& name() const;
@@ -95,11 +92,35 @@ struct FName {
   static void incrementFearId(const std::string& name);
   static void eraseId(size_t id);
 
+  //! number of distinct names so far
+  static size_t getNumNames();
+
 private:
-  void init(const StringPiece& name);
+  struct Key;
+  struct Shard;
+  static const size_t NUM_SHARDS = 32;
+  static Shard shards[NUM_SHARDS];
+
+  // id to name table, pointing to the keys of the shard maps. It is only
+  // appended to, in chunks that never move, so name() reads it without a lock
+  static const size_t CHUNK_BITS = 14;
+  static const size_t MAX_CHUNKS = 1 << 14;
+#ifdef WITH_THREADS
+  typedef boost::atomic<const std::string*> Slot;
+  typedef boost::atomic<Slot*> Chunk;
+#else
+  typedef const std::string* Slot;
+  typedef Slot* Chunk;
+#endif
+  static Chunk id2name[MAX_CHUNKS];
+  static size_t numNames;
+  static size_t addName(const std::string *name);
+
+  static bool find(const Key &key, size_t &id);
+  void init(const StringPiece &root, const StringPiece &name, bool hasRoot);
   size_t m_id;
 #ifdef WITH_THREADS
-  //reader-writer lock
+  //reader-writer lock for adding to id2name and the hope and fear counts
   static boost::shared_mutex m_idLock;
 #endif
 };
@@ -119,6 +140,72 @@ struct FNameHash
   }
 };
 
+/**
+ * The core (dense) values of a feature vector. Up to INLINE_SIZE values are
+ * stored in an aligned array inside the object, so copying and adding the
+ * score breakdowns of hypotheses doesn't touch the heap. Longer vectors are
+ * allocated.
+ **/
+class FDenseVector
+{
+public:
+  static const size_t INLINE_SIZE = 32;
+
+  explicit FDenseVector(size_t size = 0);
+  FDenseVector(const FDenseVector &other);
+  ~FDenseVector() {
+    if (m_values != m_inline) {
+      delete [] m_values;
+    }
+  }
+
+  FDenseVector &operator=(const FDenseVector &other);
+
+  size_t size() const {
+    return m_size;
+  }
+
+  FValue &operator[](size_t index) {
+    return m_values[index];
+  }
+  FValue operator[](size_t index) const {
+    return m_values[index];
+  }
+
+  FValue *begin() {
+    return m_values;
+  }
+  FValue *end() {
+    return m_values + m_size;
+  }
+  const FValue *begin() const {
+    return m_values;
+  }
+  const FValue *end() const {
+    return m_values + m_size;
+  }
+
+  //! keeps the first values, new ones are 0
+  void resize(size_t newSize);
+  void fill(FValue value);
+
+  //! add the first rhs.size() values, rhs must not be longer
+  void plusEquals(const FDenseVector &rhs) {
+    FValue *lhsValues = m_values;
+    const FValue *rhsValues = rhs.m_values;
+    for (size_t i = 0; i < rhs.m_size; ++i) {
+      lhsValues[i] += rhsValues[i];
+    }
+  }
+
+  friend void swap(FDenseVector &first, FDenseVector &second);
+
+private:
+  alignas(16) FValue m_inline[INLINE_SIZE];
+  FValue *m_values; // m_inline, or allocated if longer than INLINE_SIZE
+  size_t m_size;
+};
+
 class ProxyFVector;
 
 /**
@@ -184,7 +271,7 @@ public:
     return m_coreFeatures.size();
   }
 
-  const std::valarray<FValue> &getCoreFeatures() const {
+  const FDenseVector &getCoreFeatures() const {
     return m_coreFeatures;
   }
 
@@ -273,7 +360,7 @@ private:
   void set(const FName& name, const FValue& value);
 
   FNVmap m_features;
-  std::valarray<FValue> m_coreFeatures;
+  FDenseVector m_coreFeatures;
 
 #ifdef MPI_ENABLE
   //serialization
@@ -287,9 +374,10 @@ private:
       names.push_back(ostr.str());
       values.push_back(i->second);
     }
+    std::vector<FValue> coreValues(m_coreFeatures.begin(), m_coreFeatures.end());
     ar << names;
     ar << values;
-    ar << m_coreFeatures;
+    ar << coreValues;
   }
 
   template<class Archive>
@@ -297,9 +385,12 @@ private:
     clear();
     std::vector<std::string> names;
     std::vector<FValue> values;
+    std::vector<FValue> coreValues;
     ar >> names;
     ar >> values;
-    ar >> m_coreFeatures;
+    ar >> coreValues;
+    m_coreFeatures.resize(coreValues.size());
+    std::copy(coreValues.begin(), coreValues.end(), m_coreFeatures.begin());
     UTIL_THROW_IF2(names.size() != values.size(), "Error");
     for (size_t i = 0; i < names.size(); ++i) {
       set(FName(names[i]), values[i]);
@@ -306,6 +306,80 @@ BOOST_AUTO_TEST_CASE(ip)
   BOOST_CHECK_CLOSE((FValue)p1, 1.1*0.5 + -0.1*0.25 + 2.2*2.4, TOL);
 }
 
+BOOST_AUTO_TEST_CASE(names)
+{
+  FName n1("root", "a~b");
+  FName n2("root_a~b");
+  FName n3("root", "a~c");
+  FName n4("root_a", "b");
+  BOOST_CHECK(n1 == n2);
+  BOOST_CHECK(n1 != n3);
+  BOOST_CHECK(FName("root", "a_b") == n4);
+  BOOST_CHECK_EQUAL(n1.name(), "root_a~b");
+  BOOST_CHECK_EQUAL(n3.name(), "root_a~c");
+  BOOST_CHECK_EQUAL(FName::getId("root_a~c"), FName::getId(n3.name()));
+
+  size_t numNames = FName::getNumNames();
+  FName n5("root", "a~c");
+  BOOST_CHECK_EQUAL(FName::getNumNames(), numNames);
+  FName n6("root", "a~d");
+  BOOST_CHECK_EQUAL(FName::getNumNames(), numNames + 1);
+}
+
+BOOST_AUTO_TEST_CASE(many_names)
+{
+  // enough to fill more than one chunk of the id to name table
+  vector<FName> names;
+  for (size_t i = 0; i < 40000; ++i) {
+    ostringstream name;
+    name << i;
+    names.push_back(FName("many", name.str()));
+  }
+  for (size_t i = 0; i < names.size(); ++i) {
+    ostringstream name;
+    name << "many_" << i;
+    BOOST_CHECK_EQUAL(names[i].name(), name.str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(core_long)
+{
+  // more core features than are stored inline
+  size_t longSize = FDenseVector::INLINE_SIZE + 3;
+  FVector f1(2);
+  f1[0] = 1.5;
+  f1[1] = -2;
+  FVector f2(longSize);
+  for (size_t i = 0; i < longSize; ++i) {
+    f2[i] = i;
+  }
+
+  f1 += f2;
+  BOOST_CHECK_EQUAL(f1.coreSize(), longSize);
+  BOOST_CHECK_CLOSE(f1[0], 1.5, TOL);
+  BOOST_CHECK_CLOSE(f1[1], -1, TOL);
+  BOOST_CHECK_CLOSE(f1[longSize - 1], longSize - 1, TOL);
+
+  FVector f3(f1);
+  f1[2] = 7;
+  BOOST_CHECK_CLOSE(f3[2], 2, TOL);
+
+  f3 = FVector(2);
+  BOOST_CHECK_EQUAL(f3.coreSize(), 2);
+  BOOST_CHECK_EQUAL(f3[1], 0);
+  f3 = f1;
+  BOOST_CHECK_EQUAL(f3.coreSize(), longSize);
+  BOOST_CHECK_CLOSE(f3[2], 7, TOL);
+
+  f3.resize(3);
+  f3.resize(longSize);
+  BOOST_CHECK_CLOSE(f3[2], 7, TOL);
+  BOOST_CHECK_EQUAL(f3[3], 0);
+  BOOST_CHECK_EQUAL(f3[longSize - 1], 0);
+
+  swap(f1, f3);
+  BOOST_CHECK_CLOSE(f1.sum(), 7.5, TOL);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
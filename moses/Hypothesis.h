@@ -36,6 +36,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ScoreComponentCollection.h"
 #include "InputType.h"
 #include "ObjectPool.h"
+#include "RecyclingPool.h"
 #include "xmlrpc-c.h"
 
 namespace Moses
@@ -92,6 +93,20 @@ public:
   Hypothesis(const Hypothesis &prevHypo, const TranslationOption &transOpt, const Bitmap &bitmap, int id);
   ~Hypothesis();
 
+  //! the search allocates from the sentence's pool, see Manager::GetHypothesisPool()
+  static void *operator new(size_t size, RecyclingPool &pool) {
+    return pool.Allocate(size);
+  }
+  static void *operator new(size_t size) {
+    return RecyclingPool::AllocateUnpooled(size);
+  }
+  static void operator delete(void *ptr) {
+    RecyclingPool::Free(ptr);
+  }
+  static void operator delete(void *ptr, RecyclingPool &) {
+    RecyclingPool::Free(ptr);
+  }
+
   void PrintHypothesis() const;
 
   const InputType& GetInput() const {
@@ -43,8 +43,8 @@ HypothesisStackNormal::HypothesisStackNormal(Manager& manager) :
 /** remove all hypotheses from the collection */
 void HypothesisStackNormal::RemoveAll()
 {
-  while (m_hypos.begin() != m_hypos.end()) {
-    Remove(m_hypos.begin());
+  for (iterator iter = m_hypos.begin(); iter != m_hypos.end(); ) {
+    Remove(iter++);
   }
 }
 
@@ -165,10 +165,7 @@ void HypothesisStackNormal::PruneToSize(size_t newSize)
   for(size_t i=0; i<hypos.size(); i++) included[i] = false;
 
   // clear out original set
-  for( iterator iter = m_hypos.begin(); iter != m_hypos.end(); ) {
-    iterator removeHyp = iter++;
-    Detach(removeHyp);
-  }
+  m_hypos.clear();
 
   // add best hyps for each coverage according to minStackDiversity
   if ( m_minHypoStackDiversity > 0 ) {
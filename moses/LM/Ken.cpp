@@ -458,7 +458,7 @@ LanguageModel *ConstructKenLM(const std::string &lineOrig)
       } else if (value == "1" || value == "true") {
         load_method = util::LAZY;
       } else {
-        UTIL_THROW2("Can't parse lazyken argument " << value << ".  Also, lazyken is deprecated.  Use load with one of the arguments lazy, populate_or_lazy, populate_or_read, read, or parallel_read.");
+        UTIL_THROW2("Can't parse lazyken argument " << value << ".  Also, lazyken is deprecated.  Use load with one of the arguments lazy, populate_or_lazy, populate_or_read, read, parallel_read, huge_read, or background.");
       }
     } else if (name == "load") {
       if (value == "lazy") {
@@ -471,6 +471,10 @@ LanguageModel *ConstructKenLM(const std::string &lineOrig)
         load_method = util::READ;
       } else if (value == "parallel_read") {
         load_method = util::PARALLEL_READ;
+      } else if (value == "huge_read") {
+        load_method = util::HUGE_READ;
+      } else if (value == "background") {
+        load_method = util::BACKGROUND_POPULATE;
       } else {
         UTIL_THROW2("Unknown KenLM load method " << value);
       }
@@ -49,6 +49,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/LatticeMBR.h"
 #include "moses/SearchNormal.h"
 #include "moses/SearchCubePruning.h"
+#include "moses/BitmapContainer.h"
 #include <boost/foreach.hpp>
 
 #ifdef HAVE_PROTOBUF
@@ -69,6 +70,8 @@ Manager::Manager(ttasksptr const& ttask)
   : BaseManager(ttask)
   , interrupted_flag(0)
   , m_hypoId(0)
+  , m_hypothesisPool(sizeof(Hypothesis))
+  , m_queueItemPool(sizeof(HypothesisQueueItem))
 {
   boost::shared_ptr<InputType> source = ttask->GetSource();
   m_transOptColl = source->CreateTranslationOptionCollection(ttask);
@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Search.h"
 #include "SearchCubePruning.h"
 #include "BaseManager.h"
+#include "RecyclingPool.h"
 
 namespace Moses
 {
@@ -119,6 +120,8 @@ protected:
   size_t interrupted_flag;
   std::auto_ptr<SentenceStats> m_sentenceStats;
   int m_hypoId; //used to number the hypos as they are created.
+  RecyclingPool m_hypothesisPool; /**< memory for the hypotheses of this sentence */
+  RecyclingPool m_queueItemPool; /**< memory for the cube pruning queue items of this sentence */
 
   void GetConnectedGraph(
     std::map< int, bool >* pConnected,
@@ -167,6 +170,13 @@ public:
   void GetWordGraph(long translationId, std::ostream &outputWordGraphStream) const;
   int GetNextHypoId();
 
+  RecyclingPool &GetHypothesisPool() {
+    return m_hypothesisPool;
+  }
+  RecyclingPool &GetQueueItemPool() {
+    return m_queueItemPool;
+  }
+
   void OutputLatticeMBRNBest(std::ostream& out, const std::vector<LatticeMBRSolution>& solutions,long translationId) const;
   void OutputBestHypo(const std::vector<Moses::Word>&  mbrBestHypo, std::ostream& out) const;
   void OutputBestHypo(const Moses::TrellisPath &path, std::ostream &out) const;
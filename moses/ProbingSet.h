@@ -0,0 +1,221 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2016- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_ProbingSet_h
+#define moses_ProbingSet_h
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Moses
+{
+
+/** Hash set with open addressing and linear probing, for the small values
+ *  (pointers, integers) that hypothesis stacks recombine and look up all the
+ *  time. The values are stored in one array instead of a node per value.
+ *
+ *  Erased values leave a tombstone, so erasing doesn't move other values and
+ *  iterators stay valid, as with boost::unordered_set. Inserting may rehash
+ *  and invalidate all iterators.
+ */
+template <class T, class Hash, class Equals = Hash>
+class ProbingSet
+{
+  enum State { Empty, Full, Erased };
+
+public:
+  class const_iterator : public std::iterator<std::forward_iterator_tag, T>
+  {
+  public:
+    const_iterator() : m_set(NULL), m_ind(0) {}
+
+    const T &operator*() const {
+      return m_set->m_values[m_ind];
+    }
+    const T *operator->() const {
+      return &m_set->m_values[m_ind];
+    }
+
+    const_iterator &operator++() {
+      m_ind = m_set->NextFull(m_ind + 1);
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator ret(*this);
+      ++(*this);
+      return ret;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return m_ind == other.m_ind;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return m_ind != other.m_ind;
+    }
+
+  private:
+    friend class ProbingSet;
+    const_iterator(const ProbingSet *set, size_t ind) : m_set(set), m_ind(ind) {}
+
+    const ProbingSet *m_set;
+    size_t m_ind;
+  };
+  // values can't be changed in place, as their hash would change
+  typedef const_iterator iterator;
+
+  explicit ProbingSet(const Hash &hash = Hash(), const Equals &equals = Equals())
+    : m_hash(hash), m_equals(equals), m_size(0), m_erased(0) {
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, NextFull(0));
+  }
+  const_iterator end() const {
+    return const_iterator(this, m_states.size());
+  }
+
+  size_t size() const {
+    return m_size;
+  }
+  bool empty() const {
+    return m_size == 0;
+  }
+
+  const_iterator find(const T &value) const {
+    if (m_states.empty()) {
+      return end();
+    }
+    size_t ind = Bucket(value);
+    while (m_states[ind] != Empty) {
+      if (m_states[ind] == Full && m_equals(m_values[ind], value)) {
+        return const_iterator(this, ind);
+      }
+      ind = (ind + 1) & (m_states.size() - 1);
+    }
+    return end();
+  }
+
+  //! as std::set, the iterator points to the equal value if there is one
+  std::pair<const_iterator, bool> insert(const T &value) {
+    const_iterator existing = find(value);
+    if (existing != end()) {
+      return std::make_pair(existing, false);
+    }
+
+    // keep at least a quarter of the buckets empty, so probes stay short
+    if ((m_size + m_erased + 1) * 4 > m_states.size() * 3) {
+      Rehash(m_size + 1);
+    }
+
+    size_t ind = Bucket(value);
+    while (m_states[ind] == Full) {
+      ind = (ind + 1) & (m_states.size() - 1);
+    }
+    if (m_states[ind] == Erased) {
+      --m_erased;
+    }
+    m_states[ind] = Full;
+    m_values[ind] = value;
+    ++m_size;
+    return std::make_pair(const_iterator(this, ind), true);
+  }
+
+  void erase(const const_iterator &iter) {
+    m_states[iter.m_ind] = Erased;
+    --m_size;
+    ++m_erased;
+  }
+
+  size_t erase(const T &value) {
+    const_iterator iter = find(value);
+    if (iter == end()) {
+      return 0;
+    }
+    erase(iter);
+    return 1;
+  }
+
+  //! keeps the buckets
+  void clear() {
+    m_states.assign(m_states.size(), Empty);
+    m_size = 0;
+    m_erased = 0;
+  }
+
+  void reserve(size_t size) {
+    if (size * 2 > m_states.size()) {
+      Rehash(size);
+    }
+  }
+
+private:
+  Hash m_hash;
+  Equals m_equals;
+  std::vector<T> m_values;
+  std::vector<unsigned char> m_states; // power of 2 buckets, or none
+  size_t m_size, m_erased;
+
+  size_t Bucket(const T &value) const {
+    // hashes of small integers differ in the low bits only
+    uint64_t hash = static_cast<uint64_t>(m_hash(value)) * 0x9E3779B97F4A7C15ULL;
+    return (hash >> 32) & (m_states.size() - 1);
+  }
+
+  size_t NextFull(size_t ind) const {
+    while (ind < m_states.size() && m_states[ind] != Full) {
+      ++ind;
+    }
+    return ind;
+  }
+
+  //! room for size values at half load, dropping the tombstones
+  void Rehash(size_t size) {
+    size_t buckets = 16;
+    while (buckets < size * 2) {
+      buckets *= 2;
+    }
+
+    std::vector<T> values(buckets);
+    std::vector<unsigned char> states(buckets, Empty);
+    values.swap(m_values);
+    states.swap(m_states);
+
+    for (size_t i = 0; i < states.size(); ++i) {
+      if (states[i] != Full) {
+        continue;
+      }
+      size_t ind = Bucket(values[i]);
+      while (m_states[ind] != Empty) {
+        ind = (ind + 1) & (m_states.size() - 1);
+      }
+      m_states[ind] = Full;
+      m_values[ind] = values[i];
+    }
+    m_erased = 0;
+  }
+};
+
+}
+
+#endif
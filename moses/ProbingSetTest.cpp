@@ -0,0 +1,122 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2016- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <functional>
+#include <set>
+
+#include <boost/functional/hash.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "ProbingSet.h"
+#include "RecyclingPool.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(probing_set)
+
+typedef ProbingSet<int, boost::hash<int>, std::equal_to<int> > IntSet;
+
+BOOST_AUTO_TEST_CASE(insert_find_erase)
+{
+  IntSet ints;
+  BOOST_CHECK(ints.empty());
+  BOOST_CHECK(ints.find(3) == ints.end());
+
+  for (int i = 0; i < 1000; ++i) {
+    BOOST_CHECK(ints.insert(i << 16).second);
+  }
+  BOOST_CHECK(!ints.insert(5 << 16).second);
+  BOOST_CHECK_EQUAL(*ints.insert(5 << 16).first, 5 << 16);
+  BOOST_CHECK_EQUAL(ints.size(), 1000);
+
+  for (int i = 0; i < 1000; i += 2) {
+    BOOST_CHECK_EQUAL(ints.erase(i << 16), 1);
+  }
+  BOOST_CHECK_EQUAL(ints.erase(0), 0);
+  BOOST_CHECK_EQUAL(ints.size(), 500);
+  for (int i = 0; i < 1000; ++i) {
+    BOOST_CHECK_EQUAL(ints.find(i << 16) != ints.end(), i % 2 == 1);
+  }
+
+  ints.clear();
+  BOOST_CHECK(ints.begin() == ints.end());
+  BOOST_CHECK(ints.insert(7).second);
+  BOOST_CHECK_EQUAL(ints.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(erase_while_iterating)
+{
+  // as hypothesis stacks prune
+  IntSet ints;
+  for (int i = 0; i < 100; ++i) {
+    ints.insert(i);
+  }
+  for (IntSet::iterator iter = ints.begin(); iter != ints.end(); ) {
+    if (*iter % 3) {
+      ints.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+
+  set<int> left(ints.begin(), ints.end());
+  BOOST_CHECK_EQUAL(left.size(), 34);
+  BOOST_CHECK_EQUAL(ints.size(), 34);
+  for (set<int>::const_iterator iter = left.begin(); iter != left.end(); ++iter) {
+    BOOST_CHECK_EQUAL(*iter % 3, 0);
+  }
+
+  // tombstones pile up until the next rehash
+  for (int i = 1000; i < 2000; ++i) {
+    ints.insert(i);
+    ints.erase(i);
+  }
+  BOOST_CHECK_EQUAL(ints.size(), 34);
+}
+
+BOOST_AUTO_TEST_CASE(recycling_pool)
+{
+  void *unpooled = RecyclingPool::AllocateUnpooled(24);
+  void *block, *other;
+  {
+    RecyclingPool pool(24);
+    block = pool.Allocate(24);
+    other = pool.Allocate(24);
+    BOOST_CHECK(block != other);
+    BOOST_CHECK_EQUAL(reinterpret_cast<size_t>(block) % 16, 0);
+
+    RecyclingPool::Free(block);
+    BOOST_CHECK(pool.Allocate(24) == block);
+    for (size_t i = 0; i < 10; ++i) {
+      RecyclingPool::Free(pool.Allocate(24));
+    }
+    BOOST_CHECK_EQUAL(pool.GetNumChunks(), 1);
+
+    // too large for the blocks
+    RecyclingPool::Free(pool.Allocate(100));
+    RecyclingPool::Free(block);
+  }
+  // blocks may be freed after their pool
+  RecyclingPool::Free(other);
+  RecyclingPool::Free(unpooled);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
@@ -0,0 +1,121 @@
+#include <cstdlib>
+#include <new>
+#include "RecyclingPool.h"
+
+namespace Moses
+{
+
+namespace
+{
+// keeps the objects after it as aligned as malloc would
+const size_t HEADER_SIZE = 16;
+
+inline size_t RoundUp(size_t size)
+{
+  return (size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+}
+}
+
+struct RecyclingPool::State {
+  size_t blockSize, blocksPerChunk;
+  std::vector<char*> chunks;
+  char *next, *end; // rest of the last chunk
+  void *freeList; // blocks link through their header
+  size_t live;
+  bool poolAlive;
+
+  ~State() {
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      std::free(chunks[i]);
+    }
+  }
+};
+
+RecyclingPool::RecyclingPool(size_t objectSize, size_t chunkBytes)
+  : m_state(new State())
+{
+  m_state->blockSize = HEADER_SIZE + RoundUp(objectSize);
+  m_state->blocksPerChunk = chunkBytes / m_state->blockSize;
+  if (m_state->blocksPerChunk == 0) {
+    m_state->blocksPerChunk = 1;
+  }
+  m_state->next = m_state->end = NULL;
+  m_state->freeList = NULL;
+  m_state->live = 0;
+  m_state->poolAlive = true;
+}
+
+RecyclingPool::~RecyclingPool()
+{
+  m_state->poolAlive = false;
+  if (m_state->live == 0) {
+    delete m_state;
+  }
+}
+
+void *RecyclingPool::Allocate(size_t size)
+{
+  State &state = *m_state;
+  if (HEADER_SIZE + size > state.blockSize) {
+    return AllocateUnpooled(size);
+  }
+
+  char *block;
+  if (state.freeList) {
+    block = static_cast<char*>(state.freeList);
+    state.freeList = *reinterpret_cast<void**>(block + sizeof(State*));
+  } else {
+    if (state.next == state.end) {
+      char *chunk = static_cast<char*>(std::malloc(state.blockSize * state.blocksPerChunk));
+      if (!chunk) {
+        throw std::bad_alloc();
+      }
+      state.chunks.push_back(chunk);
+      state.next = chunk;
+      state.end = chunk + state.blockSize * state.blocksPerChunk;
+    }
+    block = state.next;
+    state.next += state.blockSize;
+  }
+
+  *reinterpret_cast<State**>(block) = m_state;
+  ++state.live;
+  return block + HEADER_SIZE;
+}
+
+void *RecyclingPool::AllocateUnpooled(size_t size)
+{
+  char *block = static_cast<char*>(std::malloc(HEADER_SIZE + size));
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<State**>(block) = NULL;
+  return block + HEADER_SIZE;
+}
+
+void RecyclingPool::Free(void *ptr)
+{
+  if (!ptr) {
+    return;
+  }
+  char *block = static_cast<char*>(ptr) - HEADER_SIZE;
+  State *state = *reinterpret_cast<State**>(block);
+  if (!state) {
+    std::free(block);
+    return;
+  }
+
+  *reinterpret_cast<void**>(block + sizeof(State*)) = state->freeList;
+  state->freeList = block;
+  if (--state->live == 0 && !state->poolAlive) {
+    delete state;
+  }
+}
+
+size_t RecyclingPool::GetNumChunks() const
+{
+  return m_state->chunks.size();
+}
+
+}
+
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Moses
+{
+
+/** Memory for objects of one size that are created and destroyed many times
+ *  while a sentence is decoded, like hypotheses. Blocks are cut from large
+ *  chunks and recycled through a free list, and all chunks are released
+ *  together. Not thread-safe: a pool belongs to the manager of one sentence.
+ *
+ *  Every block starts with a header that points back to its pool, so the
+ *  operator delete of a class can return any block with Free(), whether it
+ *  was allocated from a pool or with AllocateUnpooled(). The chunks outlive
+ *  the pool object until the last of their blocks is freed.
+ */
+class RecyclingPool
+{
+public:
+  explicit RecyclingPool(size_t objectSize, size_t chunkBytes = 1 << 18);
+  ~RecyclingPool();
+
+  //! from the heap if size is larger than the blocks
+  void *Allocate(size_t size);
+
+  static void *AllocateUnpooled(size_t size);
+
+  static void Free(void *ptr);
+
+  size_t GetNumChunks() const;
+
+private:
+  struct State;
+  State *m_state;
+
+  RecyclingPool(const RecyclingPool &);
+  RecyclingPool &operator=(const RecyclingPool &);
+};
+
+}
+
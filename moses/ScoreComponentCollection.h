@@ -145,7 +145,7 @@ public:
     return m_scores;
   }
 
-  const std::valarray<FValue> &getCoreFeatures() const {
+  const FDenseVector &getCoreFeatures() const {
     return m_scores.getCoreFeatures();
   }
 
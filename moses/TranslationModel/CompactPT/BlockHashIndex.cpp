@@ -19,6 +19,8 @@ License along with this library; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ***********************************************************************/
 
+#include <algorithm>
+
 #include "ThrowingFwrite.h"
 #include "BlockHashIndex.h"
 #include "CmphStringVectorAdapter.h"
@@ -36,8 +38,8 @@ BlockHashIndex::BlockHashIndex(size_t orderBits, size_t fingerPrintBits,
                                size_t threadsNum)
   : m_orderBits(orderBits), m_fingerPrintBits(fingerPrintBits),
     m_fileHandle(0), m_fileHandleStart(0), m_landmarks(true), m_size(0),
-    m_lastSaved(-1), m_lastDropped(-1), m_numLoadedRanges(0),
-    m_threadPool(threadsNum)
+    m_rangesEnd(0), m_lastSaved(-1), m_lastDropped(-1), m_numLoadedRanges(0),
+    m_maxLoadedRanges(0), m_tick(0), m_threadPool(threadsNum)
 {
 #ifndef HAVE_CMPH
   std::cerr << "minphr: CMPH support not compiled in." << std::endl;
@@ -47,8 +49,9 @@ BlockHashIndex::BlockHashIndex(size_t orderBits, size_t fingerPrintBits,
 #else
 BlockHashIndex::BlockHashIndex(size_t orderBits, size_t fingerPrintBits)
   : m_orderBits(orderBits), m_fingerPrintBits(fingerPrintBits),
-    m_fileHandle(0), m_fileHandleStart(0), m_size(0),
-    m_lastSaved(-1), m_lastDropped(-1), m_numLoadedRanges(0)
+    m_fileHandle(0), m_fileHandleStart(0), m_landmarks(true), m_size(0),
+    m_rangesEnd(0), m_lastSaved(-1), m_lastDropped(-1), m_numLoadedRanges(0),
+    m_maxLoadedRanges(0), m_tick(0)
 {
 #ifndef HAVE_CMPH
   std::cerr << "minphr: CMPH support not compiled in." << std::endl;
@@ -82,7 +85,7 @@ size_t BlockHashIndex::GetHash(const char* key)
   if(i == 0ul-1)
     return GetSize();
 
-  size_t pos = GetHash(i, key);
+  size_t pos = m_maxLoadedRanges ? GetHashLoading(i, key) : GetHash(i, key);
   if(pos != GetSize())
     return (1ul << m_orderBits) * i + pos;
   else
@@ -99,11 +102,6 @@ size_t BlockHashIndex::GetFprint(const char* key) const
 
 size_t BlockHashIndex::GetHash(size_t i, const char* key)
 {
-//#ifdef WITH_THREADS
-//  boost::mutex::scoped_lock lock(m_mutex);
-//#endif
-  //if(m_hashes[i] == 0)
-  //LoadRange(i);
 #ifdef HAVE_CMPH
   size_t idx = cmph_search((cmph_t*)m_hashes[i], key, (cmph_uint32) strlen(key));
 #else
@@ -112,7 +110,6 @@ size_t BlockHashIndex::GetHash(size_t i, const char* key)
 #endif
 
   std::pair<size_t, size_t> orderPrint = m_arrays[i]->Get(idx, m_orderBits, m_fingerPrintBits);
-  m_clocks[i] = clock();
 
   if(GetFprint(key) == orderPrint.second)
     return orderPrint.first;
@@ -120,6 +117,69 @@ size_t BlockHashIndex::GetHash(size_t i, const char* key)
     return GetSize();
 }
 
+size_t BlockHashIndex::GetHashLoading(size_t i, const char* key)
+{
+#ifdef WITH_THREADS
+  {
+    // most lookups hit a loaded range, and any number of threads can do that
+    // at once
+    boost::shared_lock<boost::shared_mutex> lock(m_loadMutex);
+    if(m_hashes[i] != 0) {
+      m_lastUsed[i].store(m_tick, boost::memory_order_relaxed);
+      return GetHash(i, key);
+    }
+  }
+  boost::unique_lock<boost::shared_mutex> lock(m_loadMutex);
+#endif
+  if(m_hashes[i] == 0) {
+    if(m_numLoadedRanges >= m_maxLoadedRanges)
+      DropLeastRecentRanges();
+    LoadRange(i);
+    ++m_tick;
+  }
+  m_lastUsed[i] = m_tick;
+  return GetHash(i, key);
+}
+
+void BlockHashIndex::DropLeastRecentRanges()
+{
+  // down to 90% of the maximum, so sorting is rare
+  typedef std::vector<std::pair<clock_t, size_t> > LastUsed;
+  LastUsed lastUsed;
+  for(size_t i = 0; i < m_hashes.size(); i++)
+    if(m_hashes[i] != 0)
+      lastUsed.push_back(std::make_pair(clock_t(m_lastUsed[i]), i));
+
+  size_t keep = m_maxLoadedRanges * 0.9;
+  if(keep >= lastUsed.size())
+    keep = lastUsed.size() - 1;
+  std::nth_element(lastUsed.begin(), lastUsed.end() - keep, lastUsed.end());
+  for(LastUsed::iterator it = lastUsed.begin(); it != lastUsed.end() - keep; it++)
+    DropRange(it->second);
+}
+
+void BlockHashIndex::SetMaxLoadedRanges(size_t max)
+{
+  if(max == 0 || max >= m_hashes.size()) {
+    for(size_t i = 0; i < m_hashes.size(); i++)
+      if(m_hashes[i] == 0)
+        LoadRange(i);
+    m_maxLoadedRanges = 0;
+  } else {
+    m_lastUsed.reset(new Tick[m_hashes.size()]);
+    for(size_t i = 0; i < m_hashes.size(); i++)
+      m_lastUsed[i] = 0;
+    m_maxLoadedRanges = max;
+  }
+}
+
+size_t BlockHashIndex::GetRangeBytes() const
+{
+  if(m_seekIndex.empty())
+    return 0;
+  return (m_rangesEnd - m_seekIndex[0]) / m_seekIndex.size();
+}
+
 size_t BlockHashIndex::GetHash(std::string key)
 {
   return GetHash(key.c_str());
@@ -222,6 +282,7 @@ size_t BlockHashIndex::FinalizeSave()
   SaveLastRange();
 
   size_t relIndexPos = std::ftell(m_fileHandle) - m_fileHandleStart;
+  m_rangesEnd = relIndexPos;
 
   std::fseek(m_fileHandle, m_fileHandleStart, SEEK_SET);
   ThrowingFwrite(&relIndexPos, sizeof(size_t), 1, m_fileHandle);
@@ -262,6 +323,7 @@ size_t BlockHashIndex::LoadIndex(std::FILE* mphf)
 
   size_t relIndexPos;
   read += std::fread(&relIndexPos, sizeof(size_t), 1, mphf);
+  m_rangesEnd = relIndexPos;
   std::fseek(m_fileHandle, m_fileHandleStart + relIndexPos, SEEK_SET);
 
   m_landmarks.load(mphf);
@@ -291,7 +353,7 @@ void BlockHashIndex::LoadRange(size_t i)
   m_arrays[i]->Load(m_fileHandle);
 
   m_hashes[i] = (void*)hash;
-  m_clocks[i] = clock();
+  m_clocks[i] = m_tick;
 
   m_numLoadedRanges++;
 #endif
@@ -399,7 +461,8 @@ void BlockHashIndex::CalcHash(size_t current, void* source_void)
 
   m_hashes[current] = (void*)hash;
   m_arrays[current] = pv;
-  m_clocks[current] = clock();
+  m_clocks[current] = m_tick;
+  m_numLoadedRanges++;
   m_queue.push(-current);
 #endif
 }
@@ -38,10 +38,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #ifdef WITH_THREADS
 #include "moses/ThreadPool.h"
+#include <boost/atomic.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #else
 #include <ctime>
 #endif
 
+#include <boost/scoped_array.hpp>
 #include <boost/shared_ptr.hpp>
 
 namespace Moses
@@ -67,14 +70,33 @@ private:
   std::vector<size_t> m_seekIndex;
 
   size_t m_size;
+  size_t m_rangesEnd;
   int m_lastSaved;
   int m_lastDropped;
   size_t m_numLoadedRanges;
 
+  // if set, ranges are loaded from m_fileHandle when looked up and the least
+  // recently used ones dropped when more than this many are loaded
+  size_t m_maxLoadedRanges;
+  // counts ranges loaded on demand. Ranges looked up since the last load
+  // share the current value as their recency
+  clock_t m_tick;
+
 #ifdef WITH_THREADS
   ThreadPool m_threadPool;
   boost::mutex m_mutex;
 
+  // lookups in loaded ranges share it, loading or dropping a range takes it
+  // exclusively
+  boost::shared_mutex m_loadMutex;
+  typedef boost::atomic<clock_t> Tick;
+#else
+  typedef clock_t Tick;
+#endif
+  // m_tick at the last lookup of each range, only when loading on demand
+  boost::scoped_array<Tick> m_lastUsed;
+
+#ifdef WITH_THREADS
   template <typename Keys>
   class HashTask : public Task
   {
@@ -99,6 +121,8 @@ private:
 
   size_t GetFprint(const char* key) const;
   size_t GetHash(size_t i, const char* key);
+  size_t GetHashLoading(size_t i, const char* key);
+  void DropLeastRecentRanges();
 
 public:
 #ifdef WITH_THREADS
@@ -138,9 +162,32 @@ public:
   size_t Load(std::FILE * mphf);
 
   size_t GetSize() const;
+  size_t GetNumRanges() const {
+    return m_hashes.size();
+  }
+  size_t GetNumLoadedRanges() const {
+    return m_numLoadedRanges;
+  }
+
+  //! average bytes of a saved range, about what one takes when loaded
+  size_t GetRangeBytes() const;
 
   void KeepNLastRanges(float ratio = 0.1, float tolerance = 0.1);
 
+  /** Keep at most max ranges in memory, loading the others from the file
+   *  they were saved to or loaded from when they are looked up. Ranges must
+   *  have been saved or the index loaded with LoadIndex(). 0, or a max of
+   *  at least all ranges, loads them all and keeps them.
+   */
+  void SetMaxLoadedRanges(size_t max);
+
+#ifdef WITH_THREADS
+  //! block AddRange() while this many ranges wait to be hashed
+  void SetQueueLimit(size_t limit) {
+    m_threadPool.SetQueueLimit(limit);
+  }
+#endif
+
   template <typename Keys>
   void AddRange(Keys &keys) {
     size_t current = m_landmarks.size();
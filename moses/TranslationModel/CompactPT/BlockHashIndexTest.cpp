@@ -0,0 +1,178 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2016- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+// BlockHashIndex only works with CMPH, without it the constructor exits
+#ifdef HAVE_CMPH
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#endif
+
+#include "util/string_stream.hh"
+#include "BlockHashIndex.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(block_hash_index)
+
+namespace
+{
+const size_t kOrderBits = 4;
+const size_t kFingerPrintBits = 16;
+const size_t kRanges = 8;
+const size_t kMaxLoaded = 3;
+
+// sorted keys, 2^kOrderBits per range, so a key's hash is its position
+vector<string> MakeKeys()
+{
+  vector<string> keys;
+  for(size_t i = 0; i < kRanges << kOrderBits; i++) {
+    util::StringStream key;
+    key << "key" << (1000 + i);
+    keys.push_back(key.str());
+  }
+  return keys;
+}
+
+void AddRanges(BlockHashIndex &index, const vector<string> &keys)
+{
+  size_t rangeSize = 1ul << kOrderBits;
+  for(size_t i = 0; i < keys.size(); i += rangeSize) {
+    vector<string> range(keys.begin() + i, keys.begin() + i + rangeSize);
+    index.AddRange(range);
+  }
+}
+
+// looks up every key, strided so that ranges are loaded and dropped in turn
+void LookUpAll(BlockHashIndex &index, const vector<string> &keys,
+               size_t stride, size_t *errors)
+{
+  for(size_t pass = 0; pass < 10; pass++)
+    for(size_t i = 0, k = 0; i < keys.size(); i++, k = (k + stride) % keys.size())
+      if(index.GetHash(keys[k]) != k)
+        (*errors)++;
+}
+
+void CheckLoading(BlockHashIndex &index, const vector<string> &keys)
+{
+  BOOST_CHECK_EQUAL(kRanges, index.GetNumRanges());
+  BOOST_CHECK(index.GetRangeBytes() > 0);
+  index.SetMaxLoadedRanges(kMaxLoaded);
+
+  size_t errors = 0;
+  LookUpAll(index, keys, 17, &errors);
+  BOOST_CHECK_EQUAL(0u, errors);
+  BOOST_CHECK(index.GetNumLoadedRanges() <= kMaxLoaded);
+  BOOST_CHECK_EQUAL(index.GetSize(), index.GetHash("aaa"));
+}
+}
+
+// the rank hash of PhraseTableCreator: ranges are saved as they are hashed,
+// dropped, and loaded back on demand
+BOOST_AUTO_TEST_CASE(drop_and_reload)
+{
+  vector<string> keys = MakeKeys();
+  std::FILE *file = std::tmpfile();
+
+  BlockHashIndex index(kOrderBits, kFingerPrintBits);
+  index.BeginSave(file);
+  AddRanges(index, keys);
+#ifdef WITH_THREADS
+  index.WaitAll();
+#endif
+  index.SaveLastRange();
+  index.DropLastRange();
+  index.FinalizeSave();
+  BOOST_CHECK_EQUAL(0u, index.GetNumLoadedRanges());
+
+  CheckLoading(index, keys);
+  std::fclose(file);
+}
+
+// a saved index opened with LoadIndex() only
+BOOST_AUTO_TEST_CASE(load_index)
+{
+  vector<string> keys = MakeKeys();
+  std::FILE *file = std::tmpfile();
+  {
+    BlockHashIndex saved(kOrderBits, kFingerPrintBits);
+    AddRanges(saved, keys);
+#ifdef WITH_THREADS
+    saved.WaitAll();
+#endif
+    saved.Save(file);
+  }
+
+  std::fseek(file, 0, SEEK_SET);
+  BlockHashIndex index(kOrderBits, kFingerPrintBits);
+  index.LoadIndex(file);
+  CheckLoading(index, keys);
+
+  // no limit loads everything back
+  index.SetMaxLoadedRanges(0);
+  BOOST_CHECK_EQUAL(kRanges, index.GetNumLoadedRanges());
+  size_t errors = 0;
+  LookUpAll(index, keys, 1, &errors);
+  BOOST_CHECK_EQUAL(0u, errors);
+  std::fclose(file);
+}
+
+#ifdef WITH_THREADS
+BOOST_AUTO_TEST_CASE(concurrent_lookups)
+{
+  vector<string> keys = MakeKeys();
+  std::FILE *file = std::tmpfile();
+  {
+    BlockHashIndex saved(kOrderBits, kFingerPrintBits);
+    AddRanges(saved, keys);
+    saved.WaitAll();
+    saved.Save(file);
+  }
+
+  std::fseek(file, 0, SEEK_SET);
+  BlockHashIndex index(kOrderBits, kFingerPrintBits);
+  index.LoadIndex(file);
+  index.SetMaxLoadedRanges(kMaxLoaded);
+
+  const size_t threads = 8;
+  vector<size_t> errors(threads, 0);
+  boost::thread_group group;
+  for(size_t t = 0; t < threads; t++)
+    group.create_thread(boost::bind(&LookUpAll, boost::ref(index),
+                                    boost::cref(keys), 2 * t + 1, &errors[t]));
+  group.join_all();
+
+  for(size_t t = 0; t < threads; t++)
+    BOOST_CHECK_EQUAL(0u, errors[t]);
+  BOOST_CHECK(index.GetNumLoadedRanges() <= kMaxLoaded);
+  std::fclose(file);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
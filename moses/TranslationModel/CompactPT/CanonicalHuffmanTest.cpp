@@ -0,0 +1,124 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2016- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "util/exception.hh"
+#include "CanonicalHuffman.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(canonical_huffman)
+
+namespace
+{
+typedef map<unsigned, size_t> Counts;
+
+// encode symbols, then decode them with and without the lookup table
+void CheckRoundTrip(const Counts &counts, const vector<unsigned> &symbols)
+{
+  CanonicalHuffman<unsigned> tree(counts.begin(), counts.end());
+
+  string encoded;
+  BitWrapper<> out(encoded);
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    tree.Put(out, symbols[i]);
+  }
+
+  BitWrapper<> in(encoded);
+  BitWrapper<> inBitByBit(encoded);
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    BOOST_CHECK_EQUAL(symbols[i], tree.Read(in));
+    BOOST_CHECK_EQUAL(symbols[i], tree.ReadBitByBit(inBitByBit));
+    BOOST_REQUIRE_EQUAL(in.Tell(), inBitByBit.Tell());
+  }
+}
+}
+
+BOOST_AUTO_TEST_CASE(short_codes)
+{
+  Counts counts;
+  counts[7] = 10;
+  counts[8] = 5;
+  counts[9] = 1;
+  vector<unsigned> symbols;
+  for (size_t i = 0; i < 100; ++i) {
+    symbols.push_back(7 + i % 3);
+  }
+  CheckRoundTrip(counts, symbols);
+}
+
+BOOST_AUTO_TEST_CASE(long_codes)
+{
+  // fibonacci counts give codes of up to 30 bits, longer than the lookup table
+  Counts counts;
+  size_t a = 1, b = 1;
+  for (unsigned symbol = 0; symbol < 30; ++symbol) {
+    counts[symbol] = a;
+    size_t next = a + b;
+    a = b;
+    b = next;
+  }
+  // and many codes of similar length
+  for (unsigned symbol = 100; symbol < 1100; ++symbol) {
+    counts[symbol] = 1000;
+  }
+
+  vector<unsigned> symbols;
+  unsigned seed = 1;
+  for (size_t i = 0; i < 10000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    size_t ind = (seed >> 8) % counts.size();
+    Counts::const_iterator iter = counts.begin();
+    advance(iter, ind);
+    symbols.push_back(iter->first);
+  }
+  CheckRoundTrip(counts, symbols);
+}
+
+BOOST_AUTO_TEST_CASE(seek_then_read)
+{
+  Counts counts;
+  for (unsigned symbol = 0; symbol < 300; ++symbol) {
+    counts[symbol] = symbol + 1;
+  }
+  CanonicalHuffman<unsigned> tree(counts.begin(), counts.end());
+
+  string encoded;
+  BitWrapper<> out(encoded);
+  vector<size_t> positions;
+  for (unsigned symbol = 0; symbol < 300; ++symbol) {
+    positions.push_back(out.Tell());
+    tree.Put(out, symbol);
+  }
+
+  // as the decoder resumes partly decoded collections
+  BitWrapper<> in(encoded);
+  for (unsigned symbol = 299; symbol > 0; --symbol) {
+    in.Seek(positions[symbol]);
+    BOOST_CHECK_EQUAL(symbol, tree.Read(in));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
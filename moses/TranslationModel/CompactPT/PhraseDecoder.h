@@ -135,8 +135,6 @@ public:
                                          const Phrase &sourcePhrase,
                                          bool topLevel,
                                          bool eval);
-
-  void PruneCache();
 };
 
 }
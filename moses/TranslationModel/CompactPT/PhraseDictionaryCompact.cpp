@@ -50,6 +50,7 @@ PhraseDictionaryCompact::PhraseDictionaryCompact(const std::string &line)
   :PhraseDictionary(line, true)
   ,m_inMemory(s_inMemoryByDefault)
   ,m_useAlignmentInfo(true)
+  ,m_decodingCacheBytes(TargetPhraseCollectionCache::DEFAULT_MAX_BYTES)
   ,m_hash(10, 16)
   ,m_phraseDecoder(0)
 {
@@ -97,6 +98,15 @@ void PhraseDictionaryCompact::Load(AllOptions::ptr const& opts)
                  "Not successfully loaded");
 }
 
+void PhraseDictionaryCompact::SetParameter(const std::string& key, const std::string& value)
+{
+  if (key == "decoding-cache-bytes") {
+    m_decodingCacheBytes = Scan<size_t>(value);
+  } else {
+    PhraseDictionary::SetParameter(key, value);
+  }
+}
+
 TargetPhraseCollection::shared_ptr
 PhraseDictionaryCompact::
 GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &sourcePhrase) const
@@ -152,8 +162,20 @@ GetTargetPhraseCollectionRaw(const Phrase &sourcePhrase) const
 PhraseDictionaryCompact::
 ~PhraseDictionaryCompact()
 {
-  if(m_phraseDecoder)
+  if(m_phraseDecoder) {
+    const TargetPhraseCollectionCache &cache = m_phraseDecoder->m_decodingCache;
+    if(cache.IsEnabled()) {
+      TargetPhraseCollectionCache::Stats stats = cache.GetStats();
+      size_t lookups = stats.hits + stats.misses;
+      VERBOSE(1, GetScoreProducerDescription() << " decoding cache: "
+              << lookups << " lookups, " << stats.hits << " hits ("
+              << (lookups ? 100.0 * stats.hits / lookups : 0.0) << "%), "
+              << stats.insertions << " insertions, " << stats.evictions
+              << " evictions, " << stats.entries << " entries, "
+              << stats.bytes << " bytes" << std::endl);
+    }
     delete m_phraseDecoder;
+  }
 }
 
 void
@@ -177,7 +199,6 @@ CleanUpAfterSentenceProcessing(const InputType &source)
   if(!m_sentenceCache.get())
     m_sentenceCache.reset(new PhraseCache());
 
-  m_phraseDecoder->PruneCache();
   m_sentenceCache->clear();
 
   ReduceCache();
@@ -51,6 +51,7 @@ protected:
   static bool s_inMemoryByDefault;
   bool m_inMemory;
   bool m_useAlignmentInfo;
+  size_t m_decodingCacheBytes;
 
   typedef std::vector<TargetPhraseCollection::shared_ptr > PhraseCache;
   typedef boost::thread_specific_ptr<PhraseCache> SentenceCache;
@@ -68,6 +69,7 @@ public:
   ~PhraseDictionaryCompact();
 
   void Load(AllOptions::ptr const& opts);
+  void SetParameter(const std::string& key, const std::string& value);
 
   TargetPhraseCollection::shared_ptr  GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &source) const;
   TargetPhraseVectorPtr GetTargetPhraseCollectionRaw(const Phrase &source) const;
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ThrowingFwrite.h"
 #include "util/file.hh"
 #include "util/exception.hh"
+#include "util/usage.hh"
 
 namespace Moses
 {
@@ -52,7 +53,8 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
                                        bool multipleScoreTrees,
                                        size_t quantize,
                                        size_t maxRank,
-                                       bool warnMe
+                                       bool warnMe,
+                                       size_t memory
 #ifdef WITH_THREADS
                                        , size_t threads
 #endif
@@ -63,21 +65,29 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
     m_coding(coding), m_orderBits(orderBits), m_fingerPrintBits(fingerPrintBits),
     m_useAlignmentInfo(useAlignmentInfo),
     m_multipleScoreTrees(multipleScoreTrees),
-    m_quantize(quantize), m_maxRank(maxRank),
+    m_quantize(quantize), m_maxRank(maxRank), m_memory(memory),
 #ifdef WITH_THREADS
     m_threads(threads),
-    m_srcHash(m_orderBits, m_fingerPrintBits, 1),
+    m_srcHash(m_orderBits, m_fingerPrintBits, m_threads),
     m_rnkHash(10, 24, m_threads),
 #else
     m_srcHash(m_orderBits, m_fingerPrintBits),
     m_rnkHash(m_orderBits, m_fingerPrintBits),
 #endif
+    m_rnkFile(0),
     m_maxPhraseLength(0),
     m_lastFlushedLine(-1), m_lastFlushedSourceNum(0),
     m_lastFlushedSourcePhrase("")
 {
   PrintInfo();
 
+#ifdef WITH_THREADS
+  // ranges are hashed in parallel and saved in order as they are done, only
+  // the ones waiting for a thread are kept back
+  m_srcHash.SetQueueLimit(m_threads);
+  m_rnkHash.SetQueueLimit(m_threads);
+#endif
+
   AddTargetSymbolId(m_phraseStopSymbol);
 
   size_t cur_pass = 1;
@@ -103,7 +113,9 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
   } else if(m_coding == PREnc) {
     std::cerr << "Pass " << cur_pass << "/" << all_passes << ": Creating hash function for rank assignment" << std::endl;
     cur_pass++;
+    double start = util::WallTime();
     CreateRankHash();
+    PrintPassInfo(start);
   }
 
   // 1st pass
@@ -116,7 +128,9 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
   } else {
     m_encodedTargetPhrases = new StringVectorTemp<unsigned char, unsigned long, MmapAllocator>();
   }
+  double start = util::WallTime();
   EncodeTargetPhrases();
+  PrintPassInfo(start);
 
   cur_pass++;
 
@@ -132,7 +146,9 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
   } else {
     m_compressedTargetPhrases = new StringVector<unsigned char, unsigned long, MmapAllocator>(true);
   }
+  start = util::WallTime();
   CompressTargetPhrases();
+  PrintPassInfo(start);
 
   std::cerr << "Saving to " << m_outPath << std::endl;
   Save();
@@ -152,6 +168,9 @@ PhraseTableCreator::~PhraseTableCreator()
 
   delete m_encodedTargetPhrases;
   delete m_compressedTargetPhrases;
+
+  if(m_rnkFile)
+    std::fclose(m_rnkFile);
 }
 
 void PhraseTableCreator::PrintInfo()
@@ -179,6 +198,11 @@ void PhraseTableCreator::PrintInfo()
   else
     std::cerr << "no" << std::endl;
   std::cerr << "\tExplicitly included alignment information: " << (m_useAlignmentInfo ? "yes" : "no") << std::endl;
+  std::cerr << "\tMemory budget: ";
+  if(m_memory)
+    std::cerr << (m_memory >> 20) << " MB" << std::endl;
+  else
+    std::cerr << "none" << std::endl;
 
 #ifdef WITH_THREADS
   std::cerr << "\tRunning with " << m_threads << " threads" << std::endl;
@@ -186,6 +210,17 @@ void PhraseTableCreator::PrintInfo()
   std::cerr << std::endl;
 }
 
+void PhraseTableCreator::PrintPassInfo(double start)
+{
+  uint64_t peak = util::RSSMax();
+  std::cerr << "\tDone in " << (util::WallTime() - start) << "s, peak RSS "
+            << (peak >> 20) << " MB" << std::endl;
+  if(m_memory && peak > m_memory)
+    std::cerr << "\tWarning: peak RSS exceeds the memory budget of "
+              << (m_memory >> 20) << " MB" << std::endl;
+  std::cerr << std::endl;
+}
+
 void PhraseTableCreator::Save()
 {
   // Save type of encoding
@@ -315,6 +350,13 @@ void PhraseTableCreator::CreateRankHash()
 {
   InputFileStream inFile(m_inPath);
 
+  // With a memory budget, ranges of the rank hash go to a temporary file as
+  // soon as they are hashed, instead of all staying in memory
+  if(m_memory) {
+    m_rnkFile = m_tempfilePath.size() ? util::FMakeTemp(m_tempfilePath) : std::tmpfile();
+    m_rnkHash.BeginSave(m_rnkFile);
+  }
+
 #ifdef WITH_THREADS
   boost::thread_group threads;
   for (size_t i = 0; i < m_threads; ++i) {
@@ -832,6 +874,31 @@ std::string PhraseTableCreator::CompressEncodedCollection(std::string encodedCol
   return compressedEncodedCollection;
 }
 
+void PhraseTableCreator::LimitRankHash()
+{
+  m_rnkHash.SaveLastRange();
+  m_rnkHash.DropLastRange();
+  m_rnkHash.FinalizeSave();
+
+  // Encoding looks up sub-phrases anywhere in the table, so the rank hash is
+  // the one structure that has to stay accessible. Give it half of what is
+  // left after the ranks, and load the rest back from disk on demand. The
+  // saved ranges tell how big one is for the widths the hash was built with
+  size_t ranksBytes = m_ranks.size() * sizeof(unsigned);
+  size_t budget = m_memory > ranksBytes ? (m_memory - ranksBytes) / 2 : 0;
+  size_t rangeBytes = std::max<size_t>(m_rnkHash.GetRangeBytes(), 1);
+  size_t threads = 1;
+#ifdef WITH_THREADS
+  threads = m_threads;
+#endif
+  size_t maxRanges = std::max(budget / rangeBytes, 2 * threads);
+
+  std::cerr << "\tKeeping " << std::min(maxRanges, m_rnkHash.GetNumRanges())
+            << " of " << m_rnkHash.GetNumRanges()
+            << " rank hash ranges in memory" << std::endl;
+  m_rnkHash.SetMaxLoadedRanges(maxRanges);
+}
+
 void PhraseTableCreator::AddRankedLine(PackedItem& pi)
 {
   m_queue.push(pi);
@@ -849,6 +916,10 @@ void PhraseTableCreator::FlushRankedQueue(bool force)
 
     if(m_lastSourceRange.size() == step) {
       m_rnkHash.AddRange(m_lastSourceRange);
+      if(m_rnkFile) {
+        m_rnkHash.SaveLastRange();
+        m_rnkHash.DropLastRange();
+      }
       m_lastSourceRange.clear();
     }
 
@@ -894,6 +965,9 @@ void PhraseTableCreator::FlushRankedQueue(bool force)
       m_rankQueue.pop();
     }
 
+    if(m_rnkFile)
+      LimitRankHash();
+
     m_lastFlushedLine = -1;
     m_lastFlushedSourceNum = 0;
 
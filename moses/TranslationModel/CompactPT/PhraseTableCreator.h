@@ -198,6 +198,7 @@ private:
   bool m_multipleScoreTrees;
   size_t m_quantize;
   size_t m_maxRank;
+  size_t m_memory;
 
   static std::string m_phraseStopSymbol;
   static std::string m_separator;
@@ -209,6 +210,9 @@ private:
 
   BlockHashIndex m_srcHash;
   BlockHashIndex m_rnkHash;
+  // rank hash ranges are saved here while hashing if m_memory is set, and
+  // loaded back on demand
+  std::FILE* m_rnkFile;
 
   size_t m_maxPhraseLength;
 
@@ -274,6 +278,7 @@ private:
 
   void Save();
   void PrintInfo();
+  void PrintPassInfo(double start);
 
   void AddSourceSymbolId(std::string& symbol);
   unsigned GetSourceSymbolId(std::string& symbol);
@@ -313,6 +318,7 @@ private:
   void LoadLexicalTable(std::string filePath);
 
   void CreateRankHash();
+  void LimitRankHash();
   void EncodeTargetPhrases();
   void CalcHuffmanCodes();
   void CompressTargetPhrases();
@@ -342,7 +348,8 @@ public:
                      bool multipleScoreTrees = true,
                      size_t quantize = 0,
                      size_t maxRank = 100,
-                     bool warnMe = true
+                     bool warnMe = true,
+                     size_t memory = 0
 #ifdef WITH_THREADS
                                    , size_t threads = 2
 #endif
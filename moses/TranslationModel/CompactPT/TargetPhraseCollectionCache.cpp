@@ -24,9 +24,186 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 namespace Moses
 {
 
+const size_t TargetPhraseCollectionCache::DEFAULT_MAX_BYTES;
 
-boost::thread_specific_ptr<TargetPhraseCollectionCache::CacheMap>
-TargetPhraseCollectionCache::m_phraseCache;
+TargetPhraseCollectionCache::TargetPhraseCollectionCache(size_t maxBytes,
+    size_t numShards)
+  : m_maxBytes(maxBytes), m_maxBytesPerShard(maxBytes / numShards),
+    m_shards(numShards)
+{
+  for(size_t i = 0; i < numShards; ++i)
+    m_shards[i] = new Shard();
+}
+
+TargetPhraseCollectionCache::~TargetPhraseCollectionCache()
+{
+  Clear();
+  for(size_t i = 0; i < m_shards.size(); ++i)
+    delete m_shards[i];
+}
+
+size_t TargetPhraseCollectionCache::EstimateBytes(const Phrase &sourcePhrase,
+    const TargetPhraseVector &tpv)
+{
+  // words and the objects holding them, not the score vectors' heap memory
+  size_t bytes = sizeof(Slot) + sizeof(TargetPhraseVector)
+                 + sourcePhrase.GetSize() * sizeof(Word);
+  for(TargetPhraseVector::const_iterator it = tpv.begin(); it != tpv.end(); ++it)
+    bytes += sizeof(TargetPhrase) + it->GetSize() * sizeof(Word);
+  return bytes;
+}
+
+void TargetPhraseCollectionCache::Cache(const Phrase &sourcePhrase,
+                                        TargetPhraseVectorPtr tpv,
+                                        size_t bitsLeft, size_t maxRank)
+{
+  if(!IsEnabled())
+    return;
+
+  if(maxRank && tpv->size() > maxRank) {
+    TargetPhraseVectorPtr tpv_temp(new TargetPhraseVector());
+    tpv_temp->resize(maxRank);
+    std::copy(tpv->begin(), tpv->begin() + maxRank, tpv_temp->begin());
+    tpv = tpv_temp;
+  }
+
+  size_t bytes = EstimateBytes(sourcePhrase, *tpv);
+  if(bytes > m_maxBytesPerShard)
+    return;
+
+  size_t hash = hash_value(sourcePhrase);
+  Shard &shard = GetShard(hash);
+#ifdef WITH_THREADS
+  boost::unique_lock<boost::shared_mutex> lock(shard.accessLock);
+#endif
+
+  // check if source phrase is already in cache
+  Map::iterator it = shard.map.find(hash);
+  if(it != shard.map.end()) {
+    Slot &slot = *shard.clock[it->second];
+    if(slot.sourcePhrase == sourcePhrase) {
+      // cached by another thread in the meantime, or extended. Keep the
+      // longer one
+      if(slot.bitsLeft && (bitsLeft == 0 || tpv->size() > slot.tpv->size())) {
+        shard.bytes += bytes - slot.bytes;
+        slot.tpv = tpv;
+        slot.bitsLeft = bitsLeft;
+        slot.bytes = bytes;
+      }
+      slot.referenced = true;
+      while(shard.bytes > m_maxBytesPerShard)
+        Evict(shard);
+      return;
+    }
+    Erase(shard, it);
+  }
+
+  size_t ind;
+  if(shard.freeSlots.empty()) {
+    ind = shard.clock.size();
+    shard.clock.push_back(NULL);
+  } else {
+    ind = shard.freeSlots.back();
+    shard.freeSlots.pop_back();
+  }
+  shard.clock[ind] = new Slot(hash, sourcePhrase, tpv, bitsLeft, bytes);
+  shard.map[hash] = ind;
+  shard.bytes += bytes;
+  ++shard.insertions;
+
+  while(shard.bytes > m_maxBytesPerShard)
+    Evict(shard);
+}
 
+std::pair<TargetPhraseVectorPtr, size_t>
+TargetPhraseCollectionCache::Retrieve(const Phrase &sourcePhrase)
+{
+  if(!IsEnabled())
+    return std::make_pair(TargetPhraseVectorPtr(), 0);
+
+  size_t hash = hash_value(sourcePhrase);
+  Shard &shard = GetShard(hash);
+#ifdef WITH_THREADS
+  boost::shared_lock<boost::shared_mutex> lock(shard.accessLock);
+#endif
+
+  Map::const_iterator it = shard.map.find(hash);
+  if(it != shard.map.end()) {
+    Slot &slot = *shard.clock[it->second];
+    if(slot.sourcePhrase == sourcePhrase) {
+      if(!slot.referenced.load(boost::memory_order_relaxed))
+        slot.referenced.store(true, boost::memory_order_relaxed);
+      shard.hits.fetch_add(1, boost::memory_order_relaxed);
+      return std::make_pair(slot.tpv, slot.bitsLeft);
+    }
+  }
+  shard.misses.fetch_add(1, boost::memory_order_relaxed);
+  return std::make_pair(TargetPhraseVectorPtr(), 0);
 }
 
+void TargetPhraseCollectionCache::Erase(Shard &shard, Map::iterator it)
+{
+  Slot *slot = shard.clock[it->second];
+  shard.bytes -= slot->bytes;
+  shard.clock[it->second] = NULL;
+  shard.freeSlots.push_back(it->second);
+  shard.map.erase(it);
+  delete slot;
+}
+
+void TargetPhraseCollectionCache::Evict(Shard &shard)
+{
+  // sweep until an entry that wasn't used since the last pass. There is at
+  // least one entry, so this ends within 2 rounds
+  while(true) {
+    Slot *slot = shard.clock[shard.hand];
+    shard.hand = (shard.hand + 1) % shard.clock.size();
+    if(!slot)
+      continue;
+    if(slot->referenced) {
+      slot->referenced = false;
+      continue;
+    }
+
+    Erase(shard, shard.map.find(slot->hash));
+    ++shard.evictions;
+    return;
+  }
+}
+
+void TargetPhraseCollectionCache::Clear()
+{
+  for(size_t i = 0; i < m_shards.size(); ++i) {
+    Shard &shard = *m_shards[i];
+#ifdef WITH_THREADS
+    boost::unique_lock<boost::shared_mutex> lock(shard.accessLock);
+#endif
+    for(size_t j = 0; j < shard.clock.size(); ++j)
+      delete shard.clock[j];
+    shard.map.clear();
+    shard.clock.clear();
+    shard.freeSlots.clear();
+    shard.hand = 0;
+    shard.bytes = 0;
+  }
+}
+
+TargetPhraseCollectionCache::Stats TargetPhraseCollectionCache::GetStats() const
+{
+  Stats ret;
+  for(size_t i = 0; i < m_shards.size(); ++i) {
+    const Shard &shard = *m_shards[i];
+#ifdef WITH_THREADS
+    boost::shared_lock<boost::shared_mutex> lock(shard.accessLock);
+#endif
+    ret.hits += shard.hits;
+    ret.misses += shard.misses;
+    ret.insertions += shard.insertions;
+    ret.evictions += shard.evictions;
+    ret.entries += shard.map.size();
+    ret.bytes += shard.bytes;
+  }
+  return ret;
+}
+
+}
@@ -22,12 +22,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef moses_TargetPhraseCollectionCache_h
 #define moses_TargetPhraseCollectionCache_h
 
-#include <map>
-#include <set>
 #include <vector>
+#include <stdint.h>
 
-#include <boost/thread/tss.hpp>
+#include <boost/atomic.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread/shared_mutex.hpp>
+#endif
 
 #include "moses/Phrase.h"
 #include "moses/TargetPhraseCollection.h"
@@ -39,123 +43,106 @@ namespace Moses
 typedef std::vector<TargetPhrase> TargetPhraseVector;
 typedef boost::shared_ptr<TargetPhraseVector> TargetPhraseVectorPtr;
 
-/** Implementation of Persistent Cache **/
+/** Implementation of Persistent Cache
+ *
+ * Decoded target phrase collections, shared by all decoding threads of one
+ * phrase table and kept across sentences. Split into shards by the hash of the
+ * source phrase. Each shard is bounded by the approximate bytes of its entries
+ * and evicts in CLOCK order. Lookups only take the shard's lock for reading,
+ * so concurrent lookups of the same shard don't wait for each other.
+ * Cached collections are never modified, callers that extend one copy it.
+ **/
 class TargetPhraseCollectionCache
 {
-private:
-  size_t m_max;
-  float m_tolerance;
-
-  struct LastUsed {
-    clock_t m_clock;
-    TargetPhraseVectorPtr m_tpv;
-    size_t m_bitsLeft;
-
-    LastUsed() : m_clock(0), m_bitsLeft(0) {}
+public:
+  struct Stats {
+    size_t hits, misses, insertions, evictions, entries, bytes;
 
-    LastUsed(clock_t clock, TargetPhraseVectorPtr tpv, size_t bitsLeft = 0)
-      : m_clock(clock), m_tpv(tpv), m_bitsLeft(bitsLeft) {}
+    Stats()
+      : hits(0), misses(0), insertions(0), evictions(0), entries(0), bytes(0) {
+    }
   };
 
-  typedef std::map<Phrase, LastUsed> CacheMap;
-  static boost::thread_specific_ptr<CacheMap> m_phraseCache;
+  static const size_t DEFAULT_MAX_BYTES = 128 * 1024 * 1024;
 
-public:
+  //! maxBytes == 0 disables the cache
+  TargetPhraseCollectionCache(size_t maxBytes = DEFAULT_MAX_BYTES,
+                              size_t numShards = 64);
 
-  typedef CacheMap::iterator iterator;
-  typedef CacheMap::const_iterator const_iterator;
+  ~TargetPhraseCollectionCache();
 
-  TargetPhraseCollectionCache(size_t max = 5000, float tolerance = 0.2)
-    : m_max(max), m_tolerance(tolerance) {
+  bool IsEnabled() const {
+    return m_maxBytes;
   }
 
-  iterator Begin() {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    return m_phraseCache->begin();
-  }
+  /** add translations for source phrase to persistent cache, the first
+   *  maxRank of them if maxRank is set. bitsLeft is where decoding of the
+   *  encoded collection stopped, 0 if it is complete **/
+  void Cache(const Phrase &sourcePhrase, TargetPhraseVectorPtr tpv,
+             size_t bitsLeft = 0, size_t maxRank = 0);
 
-  const_iterator Begin() const {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    return m_phraseCache->begin();
-  }
+  /** retrieve translations for source phrase from persistent cache **/
+  std::pair<TargetPhraseVectorPtr, size_t> Retrieve(const Phrase &sourcePhrase);
 
-  iterator End() {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    return m_phraseCache->end();
-  }
+  void Clear();
 
-  const_iterator End() const {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    return m_phraseCache->end();
-  }
+  Stats GetStats() const;
 
-  /** retrieve translations for source phrase from persistent cache **/
-  void Cache(const Phrase &sourcePhrase, TargetPhraseVectorPtr tpv,
-             size_t bitsLeft = 0, size_t maxRank = 0) {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    // check if source phrase is already in cache
-    iterator it = m_phraseCache->find(sourcePhrase);
-    if(it != m_phraseCache->end())
-      // if found, just update clock
-      it->second.m_clock = clock();
-    else {
-      // else, add to cache
-      if(maxRank && tpv->size() > maxRank) {
-        TargetPhraseVectorPtr tpv_temp(new TargetPhraseVector());
-        tpv_temp->resize(maxRank);
-        std::copy(tpv->begin(), tpv->begin() + maxRank, tpv_temp->begin());
-        (*m_phraseCache)[sourcePhrase] = LastUsed(clock(), tpv_temp, bitsLeft);
-      } else
-        (*m_phraseCache)[sourcePhrase] = LastUsed(clock(), tpv, bitsLeft);
+private:
+  struct Slot {
+    size_t hash;
+    Phrase sourcePhrase;
+    TargetPhraseVectorPtr tpv;
+    size_t bitsLeft;
+    size_t bytes;
+    // set by readers holding the shared lock
+    boost::atomic<bool> referenced;
+
+    Slot(size_t hash, const Phrase &sourcePhrase, TargetPhraseVectorPtr tpv,
+         size_t bitsLeft, size_t bytes)
+      : hash(hash), sourcePhrase(sourcePhrase), tpv(tpv), bitsLeft(bitsLeft),
+        bytes(bytes), referenced(false) {
     }
-  }
+  };
 
-  std::pair<TargetPhraseVectorPtr, size_t> Retrieve(const Phrase &sourcePhrase) {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    iterator it = m_phraseCache->find(sourcePhrase);
-    if(it != m_phraseCache->end()) {
-      LastUsed &lu = it->second;
-      lu.m_clock = clock();
-      return std::make_pair(lu.m_tpv, lu.m_bitsLeft);
-    } else
-      return std::make_pair(TargetPhraseVectorPtr(), 0);
-  }
+  // hash of source phrase -> index in clock. Source phrases with the same
+  // hash replace each other
+  typedef boost::unordered_map<size_t, size_t> Map;
 
-  // if cache full, reduce
-  void Prune() {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    if(m_phraseCache->size() > m_max * (1 + m_tolerance)) {
-      typedef std::set<std::pair<clock_t, Phrase> > Cands;
-      Cands cands;
-      for(CacheMap::iterator it = m_phraseCache->begin();
-          it != m_phraseCache->end(); it++) {
-        LastUsed &lu = it->second;
-        cands.insert(std::make_pair(lu.m_clock, it->first));
-      }
-
-      for(Cands::iterator it = cands.begin(); it != cands.end(); it++) {
-        const Phrase& p = it->second;
-        m_phraseCache->erase(p);
-
-        if(m_phraseCache->size() < (m_max * (1 - m_tolerance)))
-          break;
-      }
+  struct Shard {
+#ifdef WITH_THREADS
+    mutable boost::shared_mutex accessLock;
+#endif
+    Map map;
+    std::vector<Slot*> clock; // NULL for free slots
+    std::vector<size_t> freeSlots;
+    size_t hand;
+    size_t bytes;
+
+    // counted by readers holding the shared lock
+    boost::atomic<size_t> hits, misses;
+    size_t insertions, evictions;
+
+    Shard()
+      : hand(0), bytes(0), hits(0), misses(0), insertions(0), evictions(0) {
     }
-  }
+  };
 
-  void CleanUp() {
-    if(!m_phraseCache.get())
-      m_phraseCache.reset(new CacheMap());
-    m_phraseCache->clear();
+  size_t m_maxBytes, m_maxBytesPerShard;
+  std::vector<Shard*> m_shards;
+
+  Shard &GetShard(size_t hash) {
+    return *m_shards[(static_cast<uint64_t>(hash) >> 32 ^ hash) % m_shards.size()];
   }
 
+  static size_t EstimateBytes(const Phrase &sourcePhrase,
+                              const TargetPhraseVector &tpv);
+
+  void Erase(Shard &shard, Map::iterator it);
+  void Evict(Shard &shard);
+
+  TargetPhraseCollectionCache(const TargetPhraseCollectionCache &);
+  TargetPhraseCollectionCache &operator=(const TargetPhraseCollectionCache &);
 };
 
 }
@@ -130,6 +130,10 @@ void ProbingPT::SetParameter(const std::string& key, const std::string& value)
       load_method = util::READ;
     } else if (value == "parallel_read") {
       load_method = util::PARALLEL_READ;
+    } else if (value == "huge_read") {
+      load_method = util::HUGE_READ;
+    } else if (value == "background") {
+      load_method = util::BACKGROUND_POPULATE;
     } else {
       UTIL_THROW2("load method not supported" << value);
     }
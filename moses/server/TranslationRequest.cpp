@@ -21,6 +21,7 @@ using Moses::TranslationOptionList;
 using Moses::TranslationOption;
 using Moses::TargetPhrase;
 using Moses::FValue;
+using Moses::FDenseVector;
 using Moses::PhraseDictionaryMultiModel;
 using Moses::FindPhraseDictionary;
 using Moses::Sentence;
@@ -210,7 +211,7 @@ insertTranslationOptions(Moses::Manager& manager,
         toptXml["start"]  = xmlrpc_c::value_int(s);
         toptXml["end"]    = xmlrpc_c::value_int(e);
         vector<xmlrpc_c::value> scoresXml;
-        const std::valarray<FValue> &scores
+        const FDenseVector &scores
 	  = topt->GetScoreBreakdown().getCoreFeatures();
         for (size_t j = 0; j < scores.size(); ++j)
           scoresXml.push_back(xmlrpc_c::value_double(scores[j]));
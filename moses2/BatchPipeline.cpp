@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <limits>
+#include "BatchPipeline.h"
+#include "System.h"
+#include "TranslationTask.h"
+#include "legacy/Timer.h"
+
+using namespace std;
+
+namespace Moses2
+{
+
+namespace
+{
+size_t CountWords(const std::string &line)
+{
+  size_t ret = 0;
+  bool inWord = false;
+  for (size_t i = 0; i < line.size(); ++i) {
+    bool space = (line[i] == ' ' || line[i] == '\t');
+    if (!space && !inWord) {
+      ++ret;
+    }
+    inWord = !space;
+  }
+  return ret;
+}
+}
+
+BatchPipeline::BatchPipeline(System &system, ThreadPool &pool, size_t window)
+  :m_system(system)
+  ,m_pool(pool)
+  ,m_window(window)
+  ,m_numRead(0)
+  ,m_readTime(0)
+  ,m_stallTime(0)
+  ,m_numDecoded(0)
+  ,m_decodeTime(0)
+  ,m_totalTime(0)
+{
+  const size_t maxWords[] = { 10, 20, 40, 80, std::numeric_limits<size_t>::max() };
+  for (size_t i = 0; i < sizeof(maxWords) / sizeof(maxWords[0]); ++i) {
+    LengthBucket bucket = { maxWords[i], 0, 0, 0 };
+    m_lengthBuckets.push_back(bucket);
+  }
+}
+
+void BatchPipeline::Run(std::istream &inStream)
+{
+  Timer totalTimer;
+  totalTimer.start();
+
+  long translationId = 0;
+  string line;
+  while (true) {
+    Timer readTimer;
+    readTimer.start();
+    if (!getline(inStream, line)) {
+      break;
+    }
+    boost::shared_ptr<TranslationTask> task(new TranslationTask(m_system, line, translationId));
+    m_readTime += readTimer.get_elapsed_time();
+
+    // back-pressure. Wait for the writer to catch up, then for a free queue slot
+    Timer stallTimer;
+    stallTimer.start();
+    m_system.bestCollector->WaitForWindow(translationId, m_window);
+
+    boost::shared_ptr<Task> pipelineTask(new BatchPipelineTask(*this, task, CountWords(line)));
+    m_pool.Submit(pipelineTask);
+    m_stallTime += stallTimer.get_elapsed_time();
+
+    ++translationId;
+  }
+  m_numRead = translationId;
+
+  m_pool.Stop(true);
+
+  m_totalTime = totalTimer.get_elapsed_time();
+}
+
+void BatchPipeline::AddDecoded(double seconds, size_t numWords)
+{
+  boost::mutex::scoped_lock lock(m_decodeMutex);
+  ++m_numDecoded;
+  m_decodeTime += seconds;
+
+  size_t i = 0;
+  while (numWords > m_lengthBuckets[i].maxWords) {
+    ++i;
+  }
+  LengthBucket &bucket = m_lengthBuckets[i];
+  ++bucket.numDecoded;
+  bucket.decodeTime += seconds;
+  bucket.maxTime = std::max(bucket.maxTime, seconds);
+}
+
+void BatchPipeline::OutputStats(std::ostream &out) const
+{
+  long numDecoded;
+  double decodeTime;
+  std::vector<LengthBucket> lengthBuckets;
+  {
+    boost::mutex::scoped_lock lock(m_decodeMutex);
+    numDecoded = m_numDecoded;
+    decodeTime = m_decodeTime;
+    lengthBuckets = m_lengthBuckets;
+  }
+  const OutputCollector &writer = *m_system.bestCollector;
+
+  out << "Reader: " << m_numRead << " sentences, "
+      << m_readTime << "s reading, "
+      << m_stallTime << "s waiting for decoder/writer" << endl;
+  out << "Decoder: " << numDecoded << " sentences, "
+      << decodeTime << "s worker time";
+  if (numDecoded) {
+    out << ", " << decodeTime / numDecoded << "s per sentence";
+  }
+  out << endl;
+
+  size_t minWords = 0;
+  for (size_t i = 0; i < lengthBuckets.size(); ++i) {
+    const LengthBucket &bucket = lengthBuckets[i];
+    if (bucket.numDecoded) {
+      out << "  " << minWords << "-";
+      if (bucket.maxWords != std::numeric_limits<size_t>::max()) {
+        out << bucket.maxWords;
+      }
+      out << " words: " << bucket.numDecoded << " sentences, "
+          << bucket.decodeTime / bucket.numDecoded << "s mean latency, "
+          << bucket.maxTime << "s max" << endl;
+    }
+    minWords = bucket.maxWords + 1;
+  }
+  out << "Writer: " << writer.GetNumWritten() << " sentences, "
+      << "max reorder buffer " << writer.GetMaxPending()
+      << " (in-flight window " << m_window << ")" << endl;
+
+  MemPool::Stats pools = MemPool::GetGlobalStats();
+  out << "Pools: " << pools.resets << " resets, "
+      << pools.pagesAllocated << " pages allocated, "
+      << pools.pagesReused << " reused, "
+      << pools.pagesFreed << " freed" << endl;
+
+  if (m_totalTime > 0) {
+    out << "Throughput: " << m_numRead / m_totalTime << " sentences/s" << endl;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+BatchPipelineTask::BatchPipelineTask(BatchPipeline &pipeline, boost::shared_ptr<TranslationTask> task,
+                                     size_t numWords)
+  :m_pipeline(pipeline)
+  ,m_task(task)
+  ,m_numWords(numWords)
+{
+}
+
+void BatchPipelineTask::Run()
+{
+  Timer timer;
+  timer.start();
+  m_task->Run();
+  m_pipeline.AddDecoded(timer.get_elapsed_time(), m_numWords);
+}
+
+}
+
@@ -0,0 +1,78 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "legacy/ThreadPool.h"
+
+namespace Moses2
+{
+
+class System;
+class TranslationTask;
+
+/** Batch translation as three stages: this thread reads input and submits
+ *  sentences, the ThreadPool decodes them, and System::bestCollector writes
+ *  them back in order.
+ *  The reader never gets more than 'window' sentences ahead of the writer, so
+ *  one slow sentence stalls the reader instead of growing the reorder buffer.
+ *  Decoding times are also kept by sentence length, to show the latency of
+ *  long sentences on their own.
+ */
+class BatchPipeline
+{
+public:
+  BatchPipeline(System &system, ThreadPool &pool, size_t window);
+
+  //! read, translate and write every line of inStream. Returns when all output is written
+  void Run(std::istream &inStream);
+
+  void OutputStats(std::ostream &out) const;
+
+  //! called by decode tasks when a sentence is finished
+  void AddDecoded(double seconds, size_t numWords);
+
+protected:
+  System &m_system;
+  ThreadPool &m_pool;
+  size_t m_window;
+
+  // reader stage
+  long m_numRead;
+  double m_readTime, m_stallTime;
+
+  // decode stage
+  mutable boost::mutex m_decodeMutex;
+  long m_numDecoded;
+  double m_decodeTime;
+
+  // decode stage, by sentence length
+  struct LengthBucket {
+    size_t maxWords; // and more than the previous bucket's
+    long numDecoded;
+    double decodeTime, maxTime;
+  };
+  std::vector<LengthBucket> m_lengthBuckets;
+
+  // whole pipeline
+  double m_totalTime;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+//! wraps a TranslationTask to time it for the pipeline's decode counters
+class BatchPipelineTask: public Task
+{
+public:
+  BatchPipelineTask(BatchPipeline &pipeline, boost::shared_ptr<TranslationTask> task,
+                    size_t numWords);
+  virtual void Run();
+
+protected:
+  BatchPipeline &m_pipeline;
+  boost::shared_ptr<TranslationTask> m_task;
+  size_t m_numWords;
+};
+
+}
+
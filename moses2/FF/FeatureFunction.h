@@ -25,6 +25,7 @@ class TargetPhraseImpl;
 class Scores;
 class ManagerBase;
 class MemPool;
+class SnapshotWriter;
 
 namespace SCFG
 {
@@ -42,6 +43,10 @@ public:
   virtual void Load(System &system) {
   }
 
+  //! save what Load() can read back from system.GetSnapshot() at the next start
+  virtual void Freeze(SnapshotWriter &writer) const {
+  }
+
   size_t GetStartInd() const {
     return m_startInd;
   }
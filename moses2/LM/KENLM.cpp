@@ -271,15 +271,12 @@ void KENLM<Model>::EvaluateWhenApplied(const ManagerBase &mgr,
 
   if (hypo.GetBitmap().IsComplete()) {
     // Score end of sentence.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
-    const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    score += m_ngram->FullScoreForgotState(&indices.front(), last,
-                                           m_ngram->GetVocabulary().EndSentence(), stateCast.state).prob;
+    KENLMContext<Model> context(*m_ngram, hypo.GetCurrTargetWordsRange().GetEndPos(), HypoIDs(*this, hypo));
+    score += context.ScoreEndSentence(stateCast.state);
   } else if (adjust_end < end) {
     // Get state after adding a long phrase.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
-    const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    m_ngram->GetState(&indices.front(), last, stateCast.state);
+    KENLMContext<Model> context(*m_ngram, hypo.GetCurrTargetWordsRange().GetEndPos(), HypoIDs(*this, hypo));
+    context.GetState(stateCast.state);
   } else if (state0 != &stateCast.state) {
     // Short enough phrase that we can just reuse the state.
     stateCast.state = *state0;
@@ -289,7 +286,7 @@ void KENLM<Model>::EvaluateWhenApplied(const ManagerBase &mgr,
 
   bool OOVFeatureEnabled = false;
   if (OOVFeatureEnabled) {
-    std::vector<float> scoresVec(2);
+    float scoresVec[2];
     scoresVec[0] = score;
     scoresVec[1] = 0.0;
     scores.PlusEquals(system, *this, scoresVec);
@@ -298,6 +295,24 @@ void KENLM<Model>::EvaluateWhenApplied(const ManagerBase &mgr,
   }
 }
 
+template<class Model>
+void KENLM<Model>::EvaluateWhenAppliedBatch(const System &system,
+    const Batch &batch) const
+{
+  // The first lookup of each hypothesis only depends on its previous state,
+  // so request all of them before resolving any.
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const Hypothesis &hypo = *batch[i];
+    if (hypo.GetTargetPhrase().GetSize()) {
+      const lm::ngram::State &in_state =
+        static_cast<const KenLMState*>(hypo.GetPrevHypo()->GetState(m_statefulInd))->state;
+      m_ngram->Prefetch(in_state, TranslateID(hypo.GetCurrWord(0)));
+    }
+  }
+
+  StatefulFeatureFunction::EvaluateWhenAppliedBatch(system, batch);
+}
+
 template<class Model>
 void KENLM<Model>::CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScore,
                              float &ngramScore, std::size_t &oovCount) const
@@ -394,22 +409,10 @@ void KENLM<Model>::CalcScore(const Phrase<SCFG::Word> &phrase, float &fullScore,
   fullScore = TransformLMScore(fullScore);
 }
 
-// Convert last words of hypothesis into vocab ids, returning an end pointer.
 template<class Model>
-lm::WordIndex *KENLM<Model>::LastIDs(const Hypothesis &hypo,
-                                     lm::WordIndex *indices) const
+lm::WordIndex KENLM<Model>::HypoIDs::operator()(int position) const
 {
-  lm::WordIndex *index = indices;
-  lm::WordIndex *end = indices + m_ngram->Order() - 1;
-  int position = hypo.GetCurrTargetWordsRange().GetEndPos();
-  for (;; ++index, --position) {
-    if (index == end) return index;
-    if (position == -1) {
-      *index = m_ngram->GetVocabulary().BeginSentence();
-      return index + 1;
-    }
-    *index = TranslateID(hypo.GetWord(position));
-  }
+  return m_owner.TranslateID(m_hypo.GetWord(position));
 }
 
 template<class Model>
@@ -460,7 +463,7 @@ void KENLM<Model>::EvaluateWhenApplied(const SCFG::Manager &mgr,
 
   bool OOVFeatureEnabled = false;
   if (OOVFeatureEnabled) {
-    std::vector<float> scoresVec(2);
+    float scoresVec[2];
     scoresVec[0] = score;
     scoresVec[1] = 0.0;
     scores.PlusEquals(mgr.system, *this, scoresVec);
@@ -525,6 +528,10 @@ FeatureFunction *ConstructKenLM(size_t startInd, const std::string &lineOrig)
         load_method = util::READ;
       } else if (value == "parallel_read") {
         load_method = util::PARALLEL_READ;
+      } else if (value == "huge_read") {
+        load_method = util::HUGE_READ;
+      } else if (value == "background") {
+        load_method = util::BACKGROUND_POPULATE;
       } else {
         UTIL_THROW2("Unknown KenLM load method " << value);
       }
@@ -8,6 +8,7 @@
 #include <boost/shared_ptr.hpp>
 #include "../FF/StatefulFeatureFunction.h"
 #include "lm/model.hh"
+#include "KENLMContext.h"
 #include "../legacy/Factor.h"
 #include "../legacy/Util2.h"
 #include "../Word.h"
@@ -53,6 +54,10 @@ public:
                                    const Hypothesis &hypo, const FFState &prevState, Scores &scores,
                                    FFState &state) const;
 
+  //! prefetch the n-grams every hypothesis starts with, then score as usual
+  virtual void EvaluateWhenAppliedBatch(const System &system,
+                                        const Batch &batch) const;
+
   virtual void EvaluateWhenApplied(const SCFG::Manager &mgr,
                                    const SCFG::Hypothesis &hypo, int featureID, Scores &scores,
                                    FFState &state) const;
@@ -76,8 +81,20 @@ protected:
     std::size_t factor = word[m_factorType]->GetId();
     return (factor >= m_lmIdLookup.size() ? 0 : m_lmIdLookup[factor]);
   }
-  // Convert last words of hypothesis into vocab ids, returning an end pointer.
-  lm::WordIndex *LastIDs(const Hypothesis &hypo, lm::WordIndex *indices) const;
+
+  //! vocab ids of the target words of a hypothesis, for KENLMContext
+  class HypoIDs
+  {
+  public:
+    HypoIDs(const KENLM &owner, const Hypothesis &hypo)
+      :m_owner(owner)
+      ,m_hypo(hypo) {
+    }
+    lm::WordIndex operator()(int position) const;
+  protected:
+    const KENLM &m_owner;
+    const Hypothesis &m_hypo;
+  };
 
   std::vector<lm::WordIndex> m_lmIdLookup;
 
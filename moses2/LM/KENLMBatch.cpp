@@ -203,15 +203,12 @@ void KENLMBatch::EvaluateWhenApplied(const ManagerBase &mgr,
 
   if (hypo.GetBitmap().IsComplete()) {
     // Score end of sentence.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
-    const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    score += m_ngram->FullScoreForgotState(&indices.front(), last,
-                                           m_ngram->GetVocabulary().EndSentence(), stateCast.state).prob;
+    KENLMContext<Model> context(*m_ngram, hypo.GetCurrTargetWordsRange().GetEndPos(), HypoIDs(*this, hypo));
+    score += context.ScoreEndSentence(stateCast.state);
   } else if (adjust_end < end) {
     // Get state after adding a long phrase.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
-    const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    m_ngram->GetState(&indices.front(), last, stateCast.state);
+    KENLMContext<Model> context(*m_ngram, hypo.GetCurrTargetWordsRange().GetEndPos(), HypoIDs(*this, hypo));
+    context.GetState(stateCast.state);
   } else if (state0 != &stateCast.state) {
     // Short enough phrase that we can just reuse the state.
     stateCast.state = *state0;
@@ -221,7 +218,7 @@ void KENLMBatch::EvaluateWhenApplied(const ManagerBase &mgr,
 
   bool OOVFeatureEnabled = false;
   if (OOVFeatureEnabled) {
-    std::vector<float> scoresVec(2);
+    float scoresVec[2];
     scoresVec[0] = score;
     scoresVec[1] = 0.0;
     scores.PlusEquals(system, *this, scoresVec);
@@ -272,21 +269,9 @@ void KENLMBatch::CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScore,
   fullScore = TransformLMScore(fullScore);
 }
 
-// Convert last words of hypothesis into vocab ids, returning an end pointer.
-lm::WordIndex *KENLMBatch::LastIDs(const Hypothesis &hypo,
-                                   lm::WordIndex *indices) const
+lm::WordIndex KENLMBatch::HypoIDs::operator()(int position) const
 {
-  lm::WordIndex *index = indices;
-  lm::WordIndex *end = indices + m_ngram->Order() - 1;
-  int position = hypo.GetCurrTargetWordsRange().GetEndPos();
-  for (;; ++index, --position) {
-    if (index == end) return index;
-    if (position == -1) {
-      *index = m_ngram->GetVocabulary().BeginSentence();
-      return index + 1;
-    }
-    *index = TranslateID(hypo.GetWord(position));
-  }
+  return m_owner.TranslateID(m_hypo.GetWord(position));
 }
 
 void KENLMBatch::SetParameter(const std::string& key,
@@ -314,6 +299,10 @@ void KENLMBatch::SetParameter(const std::string& key,
       m_load_method = util::READ;
     } else if (value == "parallel_read") {
       m_load_method = util::PARALLEL_READ;
+    } else if (value == "huge_read") {
+      m_load_method = util::HUGE_READ;
+    } else if (value == "background") {
+      m_load_method = util::BACKGROUND_POPULATE;
     } else {
       UTIL_THROW2("Unknown KenLM load method " << value);
     }
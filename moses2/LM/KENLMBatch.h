@@ -15,6 +15,7 @@
 
 #include "../FF/StatefulFeatureFunction.h"
 #include "lm/model.hh"
+#include "KENLMContext.h"
 #include "../legacy/Factor.h"
 #include "../legacy/Util2.h"
 #include "../Word.h"
@@ -81,8 +82,20 @@ protected:
     std::size_t factor = word[m_factorType]->GetId();
     return (factor >= m_lmIdLookup.size() ? 0 : m_lmIdLookup[factor]);
   }
-  // Convert last words of hypothesis into vocab ids, returning an end pointer.
-  lm::WordIndex *LastIDs(const Hypothesis &hypo, lm::WordIndex *indices) const;
+
+  //! vocab ids of the target words of a hypothesis, for KENLMContext
+  class HypoIDs
+  {
+  public:
+    HypoIDs(const KENLMBatch &owner, const Hypothesis &hypo)
+      :m_owner(owner)
+      ,m_hypo(hypo) {
+    }
+    lm::WordIndex operator()(int position) const;
+  protected:
+    const KENLMBatch &m_owner;
+    const Hypothesis &m_hypo;
+  };
 
   std::vector<lm::WordIndex> m_lmIdLookup;
 
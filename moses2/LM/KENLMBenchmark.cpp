@@ -0,0 +1,159 @@
+/*
+ * KENLMBenchmark.cpp
+ *
+ * Micro-benchmark for the batched KenLM scoring used by cube pruning.
+ * Builds hypothesis extensions from a text file (a state reached somewhere in
+ * the text, followed by a short phrase from elsewhere) and scores them
+ *   - one hypothesis at a time, as KENLM::EvaluateWhenApplied() does
+ *   - a batch at a time, prefetching the first lookup of every extension
+ *     first, as KENLM::EvaluateWhenAppliedBatch() does
+ * The model should be binarized and much larger than the CPU caches.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "lm/model.hh"
+#include "util/exception.hh"
+#include "util/file_piece.hh"
+#include "util/tokenize_piece.hh"
+#include "util/usage.hh"
+
+using namespace std;
+
+namespace
+{
+
+const size_t STACK_SIZE = 512;
+
+struct Extension {
+  size_t state; // index into the states
+  size_t phrase; // offset into the words
+};
+
+template<class Model>
+float Score(const Model &model, const lm::ngram::State &in_state,
+            const lm::WordIndex *words, size_t phraseLen)
+{
+  lm::ngram::State aux[2];
+  float score = model.Score(in_state, words[0], aux[0]);
+  for (size_t i = 1; i < phraseLen; ++i) {
+    score += model.Score(aux[(i - 1) & 1], words[i], aux[i & 1]);
+  }
+  return score;
+}
+
+template<class Model>
+void Run(const char *modelPath, const char *textPath, size_t numExtensions,
+         size_t batchSize, size_t phraseLen)
+{
+  lm::ngram::Config config;
+  config.load_method = util::POPULATE_OR_READ;
+  Model model(modelPath, config);
+
+  // states reached at every position of the text, and the text itself
+  vector<lm::ngram::State> states;
+  vector<lm::WordIndex> words;
+  util::FilePiece in(textPath);
+  StringPiece line;
+  while (in.ReadLineOrEOF(line)) {
+    lm::ngram::State state = model.BeginSentenceState(), out;
+    for (util::TokenIter<util::BoolCharacter, true> word(line, util::kSpaces); word; ++word) {
+      lm::WordIndex id = model.GetVocabulary().Index(*word);
+      model.Score(state, id, out);
+      state = out;
+      states.push_back(state);
+      words.push_back(id);
+    }
+  }
+  UTIL_THROW_IF2(words.size() <= phraseLen, "Need more than " << phraseLen << " words of text");
+
+  // a decoder extends the few hundred hypotheses of one stack, whose states
+  // stay in cache. Only the n-gram lookups should miss
+  srand(1);
+  vector<lm::ngram::State> stack(std::min<size_t>(STACK_SIZE, states.size()));
+  for (size_t i = 0; i < stack.size(); ++i) {
+    stack[i] = states[rand() % states.size()];
+  }
+  states.swap(stack);
+
+  vector<Extension> extensions(numExtensions);
+  for (size_t i = 0; i < numExtensions; ++i) {
+    extensions[i].state = rand() % states.size();
+    extensions[i].phrase = rand() % (words.size() - phraseLen);
+  }
+
+  double start = util::CPUTime();
+  double single = 0;
+  for (size_t i = 0; i < numExtensions; ++i) {
+    const Extension &ext = extensions[i];
+    single += Score(model, states[ext.state], &words[ext.phrase], phraseLen);
+  }
+  double singleTime = util::CPUTime() - start;
+
+  start = util::CPUTime();
+  double batched = 0;
+  for (size_t begin = 0; begin < numExtensions; begin += batchSize) {
+    size_t end = std::min(begin + batchSize, numExtensions);
+    for (size_t i = begin; i < end; ++i) {
+      const Extension &ext = extensions[i];
+      model.Prefetch(states[ext.state], words[ext.phrase]);
+    }
+    for (size_t i = begin; i < end; ++i) {
+      const Extension &ext = extensions[i];
+      batched += Score(model, states[ext.state], &words[ext.phrase], phraseLen);
+    }
+  }
+  double batchedTime = util::CPUTime() - start;
+
+  UTIL_THROW_IF2(single != batched, "Scores differ: " << single << " " << batched);
+  cout << "Extensions: " << numExtensions << " of " << phraseLen
+       << " words, batch size " << batchSize << endl;
+  cout << "Per-hypothesis: " << singleTime << "s, "
+       << numExtensions / singleTime << " extensions/s" << endl;
+  cout << "Batched: " << batchedTime << "s, "
+       << numExtensions / batchedTime << " extensions/s" << endl;
+  cout << "Speedup: " << singleTime / batchedTime << endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 3) {
+    cerr << "Usage: " << argv[0] << " model text-file [extensions=1000000] [batch-size=64] [phrase-length=2]" << endl;
+    return EXIT_FAILURE;
+  }
+  size_t numExtensions = argc > 3 ? atoi(argv[3]) : 1000000;
+  size_t batchSize = argc > 4 ? atoi(argv[4]) : 64;
+  size_t phraseLen = argc > 5 ? atoi(argv[5]) : 2;
+  UTIL_THROW_IF2(numExtensions == 0 || batchSize == 0 || phraseLen == 0, "Arguments must be positive");
+
+  lm::ngram::ModelType modelType;
+  if (!lm::ngram::RecognizeBinary(argv[1], modelType)) {
+    modelType = lm::ngram::PROBING;
+  }
+  switch (modelType) {
+  case lm::ngram::PROBING:
+    Run<lm::ngram::ProbingModel>(argv[1], argv[2], numExtensions, batchSize, phraseLen);
+    break;
+  case lm::ngram::REST_PROBING:
+    Run<lm::ngram::RestProbingModel>(argv[1], argv[2], numExtensions, batchSize, phraseLen);
+    break;
+  case lm::ngram::TRIE:
+    Run<lm::ngram::TrieModel>(argv[1], argv[2], numExtensions, batchSize, phraseLen);
+    break;
+  case lm::ngram::QUANT_TRIE:
+    Run<lm::ngram::QuantTrieModel>(argv[1], argv[2], numExtensions, batchSize, phraseLen);
+    break;
+  case lm::ngram::ARRAY_TRIE:
+    Run<lm::ngram::ArrayTrieModel>(argv[1], argv[2], numExtensions, batchSize, phraseLen);
+    break;
+  case lm::ngram::QUANT_ARRAY_TRIE:
+    Run<lm::ngram::QuantArrayTrieModel>(argv[1], argv[2], numExtensions, batchSize, phraseLen);
+    break;
+  default:
+    UTIL_THROW2("Unrecognized kenlm model type " << modelType);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+/*
+ * KENLMContext.h
+ *
+ * The words before the end of a hypothesis, as KenLM ids, for scoring </s>
+ * or recomputing the state after a long phrase. Only depends on lm/ so it can
+ * be tested without the decoder.
+ */
+#pragma once
+#include "lm/max_order.hh"
+#include "lm/state.hh"
+#include "lm/word_index.hh"
+
+namespace Moses2
+{
+
+/** Last Order() - 1 ids, most recent first, ending with <s> if the sentence is
+ *  shorter. Order() <= KENLM_MAX_ORDER is checked when the model is loaded, so
+ *  they are kept on the stack rather than allocated for every hypothesis.
+ */
+template<class Model>
+class KENLMContext
+{
+public:
+  //! ids(position) is the LM id of the target word at position. lastPos is the last word of the hypothesis
+  template<class IDs>
+  KENLMContext(const Model &model, int lastPos, const IDs &ids)
+    :m_model(model)
+    ,m_end(m_indices) {
+    lm::WordIndex *limit = m_indices + model.Order() - 1;
+    for (int position = lastPos; m_end != limit; ++m_end, --position) {
+      if (position == -1) {
+        *m_end++ = model.GetVocabulary().BeginSentence();
+        break;
+      }
+      *m_end = ids(position);
+    }
+  }
+
+  //! log10 p(</s> | context). out is the state after </s>
+  float ScoreEndSentence(lm::ngram::State &out) const {
+    return m_model.FullScoreForgotState(m_indices, m_end, m_model.GetVocabulary().EndSentence(), out).prob;
+  }
+
+  void GetState(lm::ngram::State &out) const {
+    m_model.GetState(m_indices, m_end, out);
+  }
+
+  const lm::WordIndex *begin() const {
+    return m_indices;
+  }
+  const lm::WordIndex *end() const {
+    return m_end;
+  }
+
+protected:
+  const Model &m_model;
+  lm::WordIndex m_indices[KENLM_MAX_ORDER - 1];
+  lm::WordIndex *m_end;
+};
+
+}
+
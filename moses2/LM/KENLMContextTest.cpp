@@ -0,0 +1,122 @@
+/*
+ * KENLMContextTest.cpp
+ *
+ * KENLM and KENLMBatch build a KENLMContext for every completed hypothesis and
+ * for every phrase longer than the LM context, so it must not touch the heap.
+ * Counts calls to operator new while scoring.
+ */
+#include <cstdlib>
+#include <new>
+#include "KENLMContext.h"
+#include "lm/model.hh"
+
+#define BOOST_TEST_MODULE KENLMContextTest
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+unsigned long kAllocations = 0;
+}
+
+void *operator new(std::size_t size)
+{
+  ++kAllocations;
+  void *ret = std::malloc(size ? size : 1);
+  if (!ret) throw std::bad_alloc();
+  return ret;
+}
+
+void operator delete(void *ptr) throw()
+{
+  std::free(ptr);
+}
+
+namespace Moses2
+{
+namespace
+{
+
+const char *TestLocation()
+{
+  if (boost::unit_test::framework::master_test_suite().argc < 2) {
+    return "test.arpa";
+  }
+  return boost::unit_test::framework::master_test_suite().argv[1];
+}
+
+const char *const kWords[] = {"looking", "on", "a", "little", "more", "loin", "also", "call", "for", "higher", "<unk>"};
+const int kNumWords = sizeof(kWords) / sizeof(const char*);
+
+// Stands in for the target words of a hypothesis
+class ArrayIDs
+{
+public:
+  explicit ArrayIDs(const lm::WordIndex *ids) : m_ids(ids) {}
+  lm::WordIndex operator()(int position) const {
+    return m_ids[position];
+  }
+private:
+  const lm::WordIndex *m_ids;
+};
+
+// For every sentence length, the context must give the same </s> score and
+// state as scoring the sentence word by word from <s>.
+template<class Model> void EndSentence()
+{
+  Model m(TestLocation());
+  lm::WordIndex ids[kNumWords];
+  for (int i = 0; i < kNumWords; ++i) {
+    ids[i] = m.GetVocabulary().Index(kWords[i]);
+  }
+
+  float expected[kNumWords];
+  lm::ngram::State after[kNumWords];
+  {
+    lm::ngram::State states[2], ignored;
+    const lm::ngram::State *in = &m.BeginSentenceState();
+    for (int i = 0; i < kNumWords; ++i) {
+      m.FullScore(*in, ids[i], states[i & 1]);
+      in = &states[i & 1];
+      after[i] = *in;
+      expected[i] = m.FullScore(*in, m.GetVocabulary().EndSentence(), ignored).prob;
+    }
+  }
+
+  unsigned long before = kAllocations;
+  float got[kNumWords];
+  lm::ngram::State gotState[kNumWords], out;
+  for (unsigned int iteration = 0; iteration < 100; ++iteration) {
+    for (int last = 0; last < kNumWords; ++last) {
+      KENLMContext<Model> context(m, last, ArrayIDs(ids));
+      got[last] = context.ScoreEndSentence(out);
+      context.GetState(gotState[last]);
+    }
+  }
+  BOOST_CHECK_EQUAL(0UL, kAllocations - before);
+
+  for (int last = 0; last < kNumWords; ++last) {
+    BOOST_CHECK_CLOSE(expected[last], got[last], 0.001);
+    BOOST_CHECK(after[last] == gotState[last]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(probing)
+{
+  EndSentence<lm::ngram::ProbingModel>();
+}
+BOOST_AUTO_TEST_CASE(rest_probing)
+{
+  EndSentence<lm::ngram::RestProbingModel>();
+}
+BOOST_AUTO_TEST_CASE(trie)
+{
+  EndSentence<lm::ngram::TrieModel>();
+}
+BOOST_AUTO_TEST_CASE(quant_array_trie)
+{
+  EndSentence<lm::ngram::QuantArrayTrieModel>();
+}
+
+}
+}
+
@@ -2,17 +2,20 @@
 #include <memory>
 #include <boost/pool/pool_alloc.hpp>
 #include "Main.h"
+#include "BatchPipeline.h"
 #include "System.h"
 #include "Phrase.h"
 #include "TranslationTask.h"
 #include "MemPoolAllocator.h"
 #include "server/Server.h"
+#include "server/EventServer.h"
 #include "legacy/InputFileStream.h"
 #include "legacy/Parameter.h"
 #include "legacy/ThreadPool.h"
 #include "legacy/Timer.h"
 #include "legacy/Util2.h"
 #include "util/usage.hh"
+#include "util/exception.hh"
 
 using namespace std;
 
@@ -37,6 +40,12 @@ int main(int argc, char** argv)
     return EXIT_SUCCESS;
   }
 
+  const Moses2::PARAM_VEC *freezePath = params.GetParam("freeze-snapshot");
+  if (freezePath && freezePath->size()) {
+    system.Freeze((*freezePath)[0]);
+    return EXIT_SUCCESS;
+  }
+
   //cerr << "system.numThreads=" << system.options.server.numThreads << endl;
 
   Moses2::ThreadPool pool(system.options.server.numThreads, system.cpuAffinityOffset, system.cpuAffinityOffsetIncr);
@@ -44,7 +53,7 @@ int main(int argc, char** argv)
 
   if (params.GetParam("server")) {
     std::cerr << "RUN SERVER" << std::endl;
-    run_as_server(system);
+    run_as_server(system, pool);
   } else {
     std::cerr << "RUN BATCH" << std::endl;
     batch_run(params, system, pool);
@@ -57,10 +66,21 @@ int main(int argc, char** argv)
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
-void run_as_server(Moses2::System &system)
+void run_as_server(Moses2::System &system, Moses2::ThreadPool &pool)
 {
-  Moses2::Server server(system.options.server, system);
-  server.run(system); // actually: don't return. see Server::run()
+  if (system.options.server.protocol == "binary") {
+#ifdef __linux
+    Moses2::EventServer server(system.options.server, system, pool);
+    server.run(); // doesn't return
+#else
+    UTIL_THROW2("server-protocol binary is only available on Linux");
+#endif
+  } else {
+    UTIL_THROW_IF2(system.options.server.protocol != "xmlrpc",
+                   "Unknown server-protocol " << system.options.server.protocol);
+    Moses2::Server server(system.options.server, system);
+    server.run(system); // actually: don't return. see Server::run()
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,19 +100,12 @@ void batch_run(Moses2::Parameter &params, Moses2::System &system, Moses2::Thread
 {
   istream &inStream = GetInputStream(params);
 
-  long translationId = 0;
-  string line;
-  while (getline(inStream, line)) {
-    //cerr << "line=" << line << endl;
-    boost::shared_ptr<Moses2::TranslationTask> task(new Moses2::TranslationTask(system, line, translationId));
-
-    //cerr << "START pool.Submit()" << endl;
-    pool.Submit(task);
-    //task->Run();
-    ++translationId;
-  }
+  size_t window;
+  params.SetParameter(window, "max-in-flight", size_t(16 * system.options.server.numThreads));
 
-  pool.Stop(true);
+  Moses2::BatchPipeline pipeline(system, pool, window);
+  pipeline.Run(inStream);
+  pipeline.OutputStats(cerr);
 
   if (&inStream != &cin) {
     delete &inStream;
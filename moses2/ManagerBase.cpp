@@ -20,6 +20,8 @@ using namespace std;
 
 namespace Moses2
 {
+thread_local ManagerBase::ThreadMemory *ManagerBase::s_threadMemory = NULL;
+
 ManagerBase::ManagerBase(System &sys, const TranslationTask &task,
                          const std::string &inputStr, long translationId)
   :system(sys)
@@ -47,7 +49,10 @@ ManagerBase::~ManagerBase()
 void ManagerBase::InitPools()
 {
   m_pool = &system.GetManagerPool();
+  m_pool->SetMaxRetained(system.memPoolMaxRetained);
+  m_pool->SetHugePages(system.memPoolHugePages);
   m_systemPool = &system.GetSystemPool();
+  m_systemPool->SetHugePages(system.memPoolHugePages);
   m_hypoRecycle = &system.GetHypoRecycler();
 }
 
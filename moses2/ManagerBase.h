@@ -11,6 +11,8 @@
 #include <cstddef>
 #include <string>
 #include <deque>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include "Phrase.h"
 #include "MemPool.h"
 #include "Recycler.h"
@@ -33,6 +35,30 @@ class HypothesisBase;
 class ManagerBase
 {
 public:
+  /** Memory for a helper thread while it works on this sentence, eg. in a
+   *  search that runs in several threads. The hypotheses the thread creates
+   *  live in it, so it must be kept until the sentence is finished.
+   */
+  struct ThreadMemory {
+    MemPool pool;
+    Recycler<HypothesisBase*> hypoRecycle;
+  };
+
+  //! while in scope, GetPool(), GetSystemPool() and GetHypoRecycle() in this thread return memory
+  class ScopedThreadMemory
+  {
+  public:
+    ScopedThreadMemory(ThreadMemory &memory)
+      :m_prev(s_threadMemory) {
+      s_threadMemory = &memory;
+    }
+    ~ScopedThreadMemory() {
+      s_threadMemory = m_prev;
+    }
+  private:
+    ThreadMemory *m_prev;
+  };
+
   const System &system;
   const TranslationTask &task;
   mutable ArcLists arcLists;
@@ -46,15 +72,15 @@ public:
   virtual std::string OutputTransOpt() = 0;
 
   MemPool &GetPool() const {
-    return *m_pool;
+    return s_threadMemory ? s_threadMemory->pool : *m_pool;
   }
 
   MemPool &GetSystemPool() const {
-    return *m_systemPool;
+    return s_threadMemory ? s_threadMemory->pool : *m_systemPool;
   }
 
   Recycler<HypothesisBase*> &GetHypoRecycle() const {
-    return *m_hypoRecycle;
+    return s_threadMemory ? s_threadMemory->hypoRecycle : *m_hypoRecycle;
   }
 
   const InputType &GetInput() const {
@@ -65,6 +91,11 @@ public:
     return m_translationId;
   }
 
+  //! keep obj alive until this sentence is done, eg. shared cache entries it uses
+  void Pin(const boost::shared_ptr<const void> &obj) const {
+    m_pinned.push_back(obj);
+  }
+
 protected:
   std::string m_inputStr;
   long m_translationId;
@@ -72,6 +103,9 @@ protected:
 
   mutable MemPool *m_pool, *m_systemPool;
   mutable Recycler<HypothesisBase*> *m_hypoRecycle;
+  mutable std::vector<boost::shared_ptr<const void> > m_pinned;
+
+  thread_local static ThreadMemory *s_threadMemory;
 
   void InitPools();
 
@@ -6,6 +6,7 @@
  */
 
 #include <boost/foreach.hpp>
+#include <boost/thread/mutex.hpp>
 #include "MemPool.h"
 #include "util/scoped.hh"
 #include "legacy/Util2.h"
@@ -15,23 +16,53 @@ using namespace std;
 namespace Moses2
 {
 
-MemPool::Page::Page(std::size_t vSize) :
+namespace
+{
+const size_t HUGE_PAGE_SIZE = 1 << 21;
+
+boost::mutex s_statsMutex;
+MemPool::Stats s_globalStats;
+}
+
+MemPool::Stats &MemPool::Stats::operator+=(const Stats &other)
+{
+  pagesAllocated += other.pagesAllocated;
+  pagesReused += other.pagesReused;
+  pagesFreed += other.pagesFreed;
+  resets += other.resets;
+  return *this;
+}
+
+MemPool::Page::Page(std::size_t vSize, bool useHuge) :
   size(vSize)
 {
-  mem = (uint8_t*) util::MallocOrThrow(size);
+  if (useHuge && size >= HUGE_PAGE_SIZE) {
+    // round up so the tail of the page isn't a partial huge page
+    size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+    // populate now. Pages are first touched by the worker thread that owns the
+    // pool, so they are placed on its NUMA node when cpu-affinity-offset is set
+    util::HugeMalloc(size, true, huge);
+    mem = (uint8_t*) huge.get();
+  } else {
+    mem = (uint8_t*) util::MallocOrThrow(size);
+  }
   end = mem + size;
 }
 
 MemPool::Page::~Page()
 {
-  free(mem);
+  if (huge.get() == NULL) {
+    free(mem);
+  }
 }
 ////////////////////////////////////////////////////
 MemPool::MemPool(size_t initSize) :
-  m_currSize(initSize), m_currPage(0)
+  m_currSize(initSize), m_currPage(0), m_maxRetained(0), m_hugePages(false)
 {
-  Page *page = new Page(m_currSize);
+  Page *page = new Page(m_currSize, false);
   m_pages.push_back(page);
+  ++m_stats.pagesAllocated;
 
   current_ = page->mem;
   //cerr << "new memory pool";
@@ -51,8 +82,9 @@ uint8_t *MemPool::More(std::size_t size)
     m_currSize <<= 1;
     std::size_t amount = std::max(m_currSize, size);
 
-    Page *page = new Page(amount);
+    Page *page = new Page(amount, m_hugePages);
     m_pages.push_back(page);
+    ++m_stats.pagesAllocated;
 
     uint8_t *ret = page->mem;
     current_ = ret + size;
@@ -60,6 +92,7 @@ uint8_t *MemPool::More(std::size_t size)
   } else {
     // use existing page
     Page &page = *m_pages[m_currPage];
+    ++m_stats.pagesReused;
     if (size <= page.size) {
       uint8_t *ret = page.mem;
       current_ = ret + size;
@@ -73,8 +106,51 @@ uint8_t *MemPool::More(std::size_t size)
 
 void MemPool::Reset()
 {
+  if (m_maxRetained) {
+    // high-water mark trim
+    size_t numKeep = m_currPage + 1;
+    size_t retained = 0;
+    for (size_t i = 0; i < numKeep; ++i) {
+      retained += m_pages[i]->size;
+    }
+    while (numKeep < m_pages.size()
+           && retained + m_pages[numKeep]->size <= m_maxRetained) {
+      retained += m_pages[numKeep]->size;
+      ++numKeep;
+    }
+
+    while (m_pages.size() > numKeep) {
+      delete m_pages.back();
+      m_pages.pop_back();
+      ++m_stats.pagesFreed;
+    }
+    m_currSize = m_pages.back()->size;
+  }
+
   m_currPage = 0;
   current_ = m_pages[0]->mem;
+  ++m_stats.resets;
+
+  {
+    boost::mutex::scoped_lock lock(s_statsMutex);
+    s_globalStats += m_stats;
+  }
+  m_stats = Stats();
+}
+
+size_t MemPool::Size() const
+{
+  size_t ret = 0;
+  for (size_t i = 0; i < m_pages.size(); ++i) {
+    ret += m_pages[i]->size;
+  }
+  return ret;
+}
+
+MemPool::Stats MemPool::GetGlobalStats()
+{
+  boost::mutex::scoped_lock lock(s_statsMutex);
+  return s_globalStats;
 }
 
 }
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <limits>
 #include <iostream>
+#include "util/mmap.hh"
 
 namespace Moses2
 {
@@ -24,14 +25,25 @@ class MemPool
     uint8_t *mem;
     uint8_t *end;
     size_t size;
+    util::scoped_memory huge; // set if the page is backed by huge pages
 
     Page() {
     }
-    Page(std::size_t size);
+    Page(std::size_t size, bool useHuge);
     ~Page();
   };
 
 public:
+  //! page traffic, to check that pools are being recycled between sentences
+  struct Stats {
+    size_t pagesAllocated, pagesReused, pagesFreed, resets;
+
+    Stats()
+      :pagesAllocated(0), pagesReused(0), pagesFreed(0), resets(0) {
+    }
+    Stats &operator+=(const Stats &other);
+  };
+
   MemPool(std::size_t initSize = 10000);
 
   ~MemPool();
@@ -64,9 +76,26 @@ public:
     return (T*) ret;
   }
 
-  // re-use pool
+  // re-use pool. Pages used since the last reset are always kept, pages
+  // beyond that are freed once the pool holds more than maxRetained bytes
   void Reset();
 
+  //! 0 = never free pages on Reset()
+  void SetMaxRetained(size_t bytes) {
+    m_maxRetained = bytes;
+  }
+
+  //! back new pages of 2MB or more with huge pages, populated by the calling thread
+  void SetHugePages(bool val) {
+    m_hugePages = val;
+  }
+
+  //! bytes held in all pages, used or not
+  size_t Size() const;
+
+  //! totals over all pools in the process, up to their last Reset()
+  static Stats GetGlobalStats();
+
 private:
   uint8_t *More(std::size_t size);
 
@@ -76,6 +105,10 @@ private:
   size_t m_currPage;
   uint8_t *current_;
 
+  size_t m_maxRetained;
+  bool m_hugePages;
+  Stats m_stats; // since the last Reset()
+
   // no copying
   MemPool(const MemPool &);
   MemPool &operator=(const MemPool &);
@@ -75,10 +75,6 @@ void QueueItem::CreateHypothesis(Manager &mgr)
   hypo = Hypothesis::Create(mgr.GetSystemPool(), mgr);
   hypo->Init(mgr, *prevHypo, edge->path, tp, edge->newBitmap,
              edge->estimatedScore);
-
-  if (!mgr.system.options.cube.lazy_scoring) {
-    hypo->EvaluateWhenApplied();
-  }
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -107,7 +103,7 @@ bool CubeEdge::SetSeenPosition(const size_t x, const size_t y,
   return pairRet.second;
 }
 
-void CubeEdge::CreateFirst(Manager &mgr, Queue &queue,
+void CubeEdge::CreateFirst(Manager &mgr, QueueItems &newItems,
                            SeenPositions &seenPositions,
                            QueueItemRecycler &queueItemRecycler)
 {
@@ -116,12 +112,12 @@ void CubeEdge::CreateFirst(Manager &mgr, Queue &queue,
 
   QueueItem *item = QueueItem::Create(NULL, mgr, *this, 0, 0,
                                       queueItemRecycler);
-  queue.push(item);
+  newItems.push_back(item);
   bool setSeen = SetSeenPosition(0, 0, seenPositions);
   assert(setSeen);
 }
 
-void CubeEdge::CreateNext(Manager &mgr, QueueItem *item, Queue &queue,
+void CubeEdge::CreateNext(Manager &mgr, QueueItem *item, QueueItems &newItems,
                           SeenPositions &seenPositions,
                           QueueItemRecycler &queueItemRecycler)
 {
@@ -134,7 +130,7 @@ void CubeEdge::CreateNext(Manager &mgr, QueueItem *item, Queue &queue,
     QueueItem *newItem = QueueItem::Create(item, mgr, *this, hypoIndex + 1,
                                            tpIndex, queueItemRecycler);
     assert(newItem == item);
-    queue.push(newItem);
+    newItems.push_back(newItem);
     item = NULL;
   }
 
@@ -142,7 +138,7 @@ void CubeEdge::CreateNext(Manager &mgr, QueueItem *item, Queue &queue,
       && SetSeenPosition(hypoIndex, tpIndex + 1, seenPositions)) {
     QueueItem *newItem = QueueItem::Create(item, mgr, *this, hypoIndex,
                                            tpIndex + 1, queueItemRecycler);
-    queue.push(newItem);
+    newItems.push_back(newItem);
     item = NULL;
   }
 
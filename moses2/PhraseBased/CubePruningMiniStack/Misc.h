@@ -69,6 +69,9 @@ public:
   typedef std::priority_queue<QueueItem*,
           std::vector<QueueItem*, MemPoolAllocator<QueueItem*> >, QueueItemOrderer> Queue;
 
+  // new items, waiting to be scored together before they go into the queue
+  typedef std::vector<QueueItem*, MemPoolAllocator<QueueItem*> > QueueItems;
+
   typedef std::pair<const CubeEdge*, int> SeenPositionItem;
   typedef boost::unordered_set<SeenPositionItem, boost::hash<SeenPositionItem>,
           std::equal_to<SeenPositionItem>, MemPoolAllocator<SeenPositionItem> > SeenPositions;
@@ -85,9 +88,9 @@ public:
   bool SetSeenPosition(const size_t x, const size_t y,
                        SeenPositions &seenPositions) const;
 
-  void CreateFirst(Manager &mgr, Queue &queue, SeenPositions &seenPositions,
+  void CreateFirst(Manager &mgr, QueueItems &newItems, SeenPositions &seenPositions,
                    QueueItemRecycler &queueItemRecycler);
-  void CreateNext(Manager &mgr, QueueItem *item, Queue &queue,
+  void CreateNext(Manager &mgr, QueueItem *item, QueueItems &newItems,
                   SeenPositions &seenPositions,
                   QueueItemRecycler &queueItemRecycler);
 
@@ -4,6 +4,8 @@
  *  Created on: 16 Nov 2015
  *      Author: hieu
  */
+#include <algorithm>
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include "Search.h"
 #include "Stack.h"
@@ -16,6 +18,7 @@
 #include "../../InputPathBase.h"
 #include "../../System.h"
 #include "../../TranslationTask.h"
+#include "../../WorkerGroup.h"
 #include "../../legacy/Util2.h"
 #include "../../PhraseBased/TargetPhrases.h"
 
@@ -27,30 +30,69 @@ namespace Moses2
 namespace NSCubePruningMiniStack
 {
 
-////////////////////////////////////////////////////////////////////////
-Search::Search(Manager &mgr) :
-  Moses2::Search(mgr), m_stack(mgr), m_cubeEdgeAlloc(mgr.GetPool())
-
-  , m_queue(QueueItemOrderer(),
-            std::vector<QueueItem*, MemPoolAllocator<QueueItem*> >(
-              MemPoolAllocator<QueueItem*>(mgr.GetPool())))
+namespace
+{
+// orders mini-stacks by number of edges, most first
+class MiniStackSizeOrderer
+{
+public:
+  MiniStackSizeOrderer(const std::vector<size_t> &sizes) : m_sizes(sizes) {
+  }
+  bool operator()(size_t a, size_t b) const {
+    return m_sizes[a] > m_sizes[b];
+  }
+protected:
+  const std::vector<size_t> &m_sizes;
+};
+}
 
-  , m_seenPositions(
-    MemPoolAllocator<CubeEdge::SeenPositionItem>(mgr.GetPool()))
+////////////////////////////////////////////////////////////////////////
+Search::CubeQueue::CubeQueue(MemPool &pool)
+  : queue(QueueItemOrderer(),
+          std::vector<QueueItem*, MemPoolAllocator<QueueItem*> >(
+            MemPoolAllocator<QueueItem*>(pool)))
+  , seenPositions(MemPoolAllocator<CubeEdge::SeenPositionItem>(pool))
+  , newItems(MemPoolAllocator<QueueItem*>(pool))
+  , batch(pool)
+  , queueItemRecycler(MemPoolAllocator<QueueItem*>(pool))
+{
+}
 
-  , m_queueItemRecycler(MemPoolAllocator<QueueItem*>(mgr.GetPool()))
+Search::Worker::Worker()
+  : cube(memory.pool)
+{
+}
 
+////////////////////////////////////////////////////////////////////////
+Search::Search(Manager &mgr) :
+  Moses2::Search(mgr), m_stack(mgr), m_cube(mgr.GetPool())
+  , m_cubeEdgeAlloc(mgr.GetPool())
+  , m_workers(NULL)
+  , m_numMiniStacks(0)
+  , m_miniStackPopLimit(0)
 {
 }
 
 Search::~Search()
 {
+  // stop the threads before their memory goes
+  delete m_workers;
+  RemoveAllInColl(m_workerData);
 }
 
 void Search::Decode()
 {
   const Sentence &sentence = static_cast<const Sentence&>(mgr.GetInput());
 
+  const CubePruningOptions &cubeOptions = mgr.system.options.cube;
+  if (cubeOptions.threads > 1
+      && sentence.GetSize() >= cubeOptions.threads_min_words) {
+    m_workers = new WorkerGroup(cubeOptions.threads);
+    for (size_t i = 0; i < m_workers->GetNumWorkers(); ++i) {
+      m_workerData.push_back(new Worker());
+    }
+  }
+
   // init cue edges
   m_cubeEdges.resize(sentence.GetSize() + 1);
   for (size_t i = 0; i < m_cubeEdges.size(); ++i) {
@@ -81,12 +123,24 @@ void Search::Decode()
 }
 
 void Search::Decode(size_t stackInd)
+{
+  CubeEdges &edges = *m_cubeEdges[stackInd];
+  if (m_workers) {
+    DecodeParallel(edges);
+  } else {
+    Decode(m_cube, edges.empty() ? NULL : &edges[0], edges.size(),
+           mgr.system.options.cube.pop_limit, NULL);
+  }
+}
+
+void Search::Decode(CubeQueue &cube, CubeEdge *const *edges, size_t numEdges,
+                    size_t popLimit, std::vector<Hypothesis*> *out)
 {
   Recycler<HypothesisBase*> &hypoRecycler = mgr.GetHypoRecycle();
 
   // reuse queue from previous stack. Clear it first
   std::vector<QueueItem*, MemPoolAllocator<QueueItem*> > &container = Container(
-        m_queue);
+        cube.queue);
   //cerr << "container=" << container.size() << endl;
   BOOST_FOREACH(QueueItem *item, container) {
     // recycle unused hypos from queue
@@ -94,19 +148,18 @@ void Search::Decode(size_t stackInd)
     hypoRecycler.Recycle(hypo);
 
     // recycle queue item
-    m_queueItemRecycler.push_back(item);
+    cube.queueItemRecycler.push_back(item);
   }
   container.clear();
 
-  m_seenPositions.clear();
+  cube.seenPositions.clear();
 
   // add top hypo from every edge into queue
-  CubeEdges &edges = *m_cubeEdges[stackInd];
-
-  BOOST_FOREACH(CubeEdge *edge, edges) {
-    //cerr << *edge << " ";
-    edge->CreateFirst(mgr, m_queue, m_seenPositions, m_queueItemRecycler);
+  for (size_t i = 0; i < numEdges; ++i) {
+    //cerr << *edges[i] << " ";
+    edges[i]->CreateFirst(mgr, cube.newItems, cube.seenPositions, cube.queueItemRecycler);
   }
+  Push(cube);
 
   /*
   cerr << "edges: ";
@@ -120,11 +173,11 @@ void Search::Decode(size_t stackInd)
    */
 
   size_t pops = 0;
-  while (!m_queue.empty() && pops < mgr.system.options.cube.pop_limit) {
+  while (!cube.queue.empty() && pops < popLimit) {
     // get best hypo from queue, add to stack
     //cerr << "queue=" << queue.size() << endl;
-    QueueItem *item = m_queue.top();
-    m_queue.pop();
+    QueueItem *item = cube.queue.top();
+    cube.queue.pop();
 
     CubeEdge *edge = item->edge;
 
@@ -136,29 +189,98 @@ void Search::Decode(size_t stackInd)
     }
 
     //cerr << "hypo=" << *hypo << " " << hypo->GetBitmap() << endl;
-    m_stack.Add(hypo, hypoRecycler, mgr.arcLists);
+    if (out) {
+      out->push_back(hypo);
+    } else {
+      m_stack.Add(hypo, hypoRecycler, mgr.arcLists);
+    }
 
-    edge->CreateNext(mgr, item, m_queue, m_seenPositions, m_queueItemRecycler);
+    edge->CreateNext(mgr, item, cube.newItems, cube.seenPositions, cube.queueItemRecycler);
+    Push(cube);
 
     ++pops;
   }
 
   // create hypo from every edge. Increase diversity
   if (mgr.system.options.cube.diversity) {
-    while (!m_queue.empty()) {
-      QueueItem *item = m_queue.top();
-      m_queue.pop();
+    while (!cube.queue.empty()) {
+      QueueItem *item = cube.queue.top();
+      cube.queue.pop();
 
       if (item->hypoIndex == 0 && item->tpIndex == 0) {
         // add hypo to stack
         Hypothesis *hypo = item->hypo;
         //cerr << "hypo=" << *hypo << " " << hypo->GetBitmap() << endl;
-        m_stack.Add(hypo, hypoRecycler, mgr.arcLists);
+        if (out) {
+          out->push_back(hypo);
+        } else {
+          m_stack.Add(hypo, hypoRecycler, mgr.arcLists);
+        }
       }
     }
   }
 }
 
+void Search::DecodeParallel(const CubeEdges &edges)
+{
+  // group the edges by the mini-stack their hypos go into, in the order the
+  // mini-stacks are first seen
+  m_miniStackInds.clear();
+  m_numMiniStacks = 0;
+  BOOST_FOREACH(CubeEdge *edge, edges) {
+    Stack::HypoCoverage key(&edge->newBitmap, edge->path.range.GetEndPos());
+    std::pair<boost::unordered_map<Stack::HypoCoverage, size_t>::iterator, bool> ret =
+      m_miniStackInds.insert(std::make_pair(key, m_numMiniStacks));
+    if (ret.second) {
+      if (m_numMiniStacks == m_miniStacks.size()) {
+        m_miniStacks.push_back(MiniStackEdges());
+      }
+      m_miniStacks[m_numMiniStacks].edges.clear();
+      ++m_numMiniStacks;
+    }
+    m_miniStacks[ret.first->second].edges.push_back(edge);
+  }
+  if (m_numMiniStacks == 0) {
+    return;
+  }
+
+  std::vector<size_t> sizes(m_numMiniStacks);
+  m_miniStackOrder.resize(m_numMiniStacks);
+  for (size_t i = 0; i < m_numMiniStacks; ++i) {
+    sizes[i] = m_miniStacks[i].edges.size();
+    m_miniStackOrder[i] = i;
+  }
+  std::stable_sort(m_miniStackOrder.begin(), m_miniStackOrder.end(),
+                   MiniStackSizeOrderer(sizes));
+
+  // there's no queue across mini-stacks to share the pops out by score
+  size_t popLimit = mgr.system.options.cube.pop_limit;
+  m_miniStackPopLimit = std::max<size_t>(1, (popLimit + m_numMiniStacks - 1) / m_numMiniStacks);
+
+  m_workers->Run(m_numMiniStacks,
+                 boost::bind(&Search::DecodeMiniStack, this, _1, _2));
+
+  Recycler<HypothesisBase*> &hypoRecycler = mgr.GetHypoRecycle();
+  for (size_t i = 0; i < m_numMiniStacks; ++i) {
+    BOOST_FOREACH(Hypothesis *hypo, m_miniStacks[i].hypos) {
+      m_stack.Add(hypo, hypoRecycler, mgr.arcLists);
+    }
+  }
+}
+
+void Search::DecodeMiniStack(size_t task, size_t worker)
+{
+  MiniStackEdges &miniStack = m_miniStacks[m_miniStackOrder[task]];
+  Worker &workerData = *m_workerData[worker];
+
+  // hypos, queue items and feature function states come from the worker's memory
+  ManagerBase::ScopedThreadMemory scopedMemory(workerData.memory);
+
+  miniStack.hypos.clear();
+  Decode(workerData.cube, &miniStack.edges[0], miniStack.edges.size(),
+         m_miniStackPopLimit, &miniStack.hypos);
+}
+
 void Search::PostDecode(size_t stackInd)
 {
   MemPool &pool = mgr.GetPool();
@@ -221,6 +343,22 @@ void Search::PostDecode(size_t stackInd)
   }
 }
 
+void Search::Push(CubeQueue &cube)
+{
+  if (!mgr.system.options.cube.lazy_scoring) {
+    cube.batch.clear();
+    BOOST_FOREACH(QueueItem *item, cube.newItems) {
+      cube.batch.push_back(item->hypo);
+    }
+    mgr.system.featureFunctions.EvaluateWhenAppliedBatch(cube.batch);
+  }
+
+  BOOST_FOREACH(QueueItem *item, cube.newItems) {
+    cube.queue.push(item);
+  }
+  cube.newItems.clear();
+}
+
 const Hypothesis *Search::GetBestHypo() const
 {
   const Hypothesis *bestHypo = m_stack.GetBestHypo();
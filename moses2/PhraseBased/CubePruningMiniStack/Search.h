@@ -6,12 +6,15 @@
  */
 
 #pragma once
+#include <vector>
 #include <boost/pool/pool_alloc.hpp>
+#include <boost/unordered_map.hpp>
 #include "../Search.h"
 #include "Misc.h"
 #include "Stack.h"
 #include "../../legacy/Range.h"
 #include "../../MemPoolAllocator.h"
+#include "../../ManagerBase.h"
 
 namespace Moses2
 {
@@ -21,6 +24,7 @@ class Hypothesis;
 class InputPath;
 class TargetPhrases;
 class TargetPhraseImpl;
+class WorkerGroup;
 
 namespace NSCubePruningMiniStack
 {
@@ -37,10 +41,34 @@ public:
   void AddInitialTrellisPaths(TrellisPaths<TrellisPath> &paths) const;
 
 protected:
-  Stack m_stack;
+  // queue of the hypos being created from some cube edges
+  struct CubeQueue {
+    CubeQueue(MemPool &pool);
+
+    CubeEdge::Queue queue;
+    CubeEdge::SeenPositions seenPositions;
+    CubeEdge::QueueItems newItems;
+    Batch batch;
+    QueueItemRecycler queueItemRecycler;
+  };
+
+  // a thread of a multi-threaded search. Its memory holds the hypos it
+  // creates, so is kept until the sentence is done
+  struct Worker {
+    Worker();
 
-  CubeEdge::Queue m_queue;
-  CubeEdge::SeenPositions m_seenPositions;
+    ManagerBase::ThreadMemory memory;
+    CubeQueue cube;
+  };
+
+  // the edges into one mini-stack of the stack being decoded, and the hypos they gave
+  struct MiniStackEdges {
+    std::vector<CubeEdge*> edges;
+    std::vector<Hypothesis*> hypos;
+  };
+
+  Stack m_stack;
+  CubeQueue m_cube;
 
   // CUBE PRUNING VARIABLES
   // setup
@@ -48,12 +76,32 @@ protected:
   typedef std::vector<CubeEdge*, MemPoolAllocator<CubeEdge*> > CubeEdges;
   std::vector<CubeEdges*> m_cubeEdges;
 
-  QueueItemRecycler m_queueItemRecycler;
+  // multi-threaded search. NULL for short sentences, or if it's turned off
+  WorkerGroup *m_workers;
+  std::vector<Worker*> m_workerData;
+  boost::unordered_map<Stack::HypoCoverage, size_t> m_miniStackInds;
+  std::vector<MiniStackEdges> m_miniStacks; // reused between stacks, the first m_numMiniStacks are in use
+  size_t m_numMiniStacks;
+  std::vector<size_t> m_miniStackOrder; // most edges first, so the longest tasks start first
+  size_t m_miniStackPopLimit;
 
   // CUBE PRUNING
   // decoding
   void Decode(size_t stackInd);
   void PostDecode(size_t stackInd);
+
+  // pop the best hypos that can be made from the edges. They are put into out
+  // in the order they were popped, or straight into the stack if out is NULL
+  void Decode(CubeQueue &cube, CubeEdge *const *edges, size_t numEdges,
+              size_t popLimit, std::vector<Hypothesis*> *out);
+
+  // decode every mini-stack on its own, in parallel, then add their hypos to
+  // the stack in a fixed order, so the output doesn't depend on the threads
+  void DecodeParallel(const CubeEdges &edges);
+  void DecodeMiniStack(size_t task, size_t worker);
+
+  // score the new items as one batch, then queue them
+  void Push(CubeQueue &cube);
 };
 
 }
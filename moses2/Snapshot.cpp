@@ -0,0 +1,172 @@
+#include <cstring>
+#include <sys/stat.h>
+#include <boost/foreach.hpp>
+#include "Snapshot.h"
+#include "legacy/Parameter.h"
+#include "util/murmur_hash.hh"
+
+using namespace std;
+
+namespace Moses2
+{
+
+namespace
+{
+const char MAGIC[8] = { 'M', 'o', 's', 'e', 's', '2', 'S', 'n' };
+// change when the layout of the file, or of any section, changes
+const uint32_t VERSION = 1;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t padding;
+  uint64_t fingerprint;
+};
+}
+
+////////////////////////////////////////////////////////////////////////////
+SnapshotWriter::SnapshotWriter(const std::string &path, uint64_t fingerprint)
+  :m_path(path)
+  ,m_file(util::CreateOrThrow(path.c_str()))
+  ,m_inSection(false)
+{
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.fingerprint = fingerprint;
+  util::WriteOrThrow(m_file.get(), &header, sizeof(header));
+}
+
+void SnapshotWriter::BeginSection(const std::string &name)
+{
+  EndSection();
+  m_inSection = true;
+  m_buffer.clear();
+  WriteString(name);
+  // size of the contents, filled in by EndSection()
+  Write<uint64_t>(0);
+}
+
+void SnapshotWriter::Finish()
+{
+  EndSection();
+  util::FSyncOrThrow(m_file.get());
+  m_file.reset();
+}
+
+void SnapshotWriter::EndSection()
+{
+  if (!m_inSection) {
+    return;
+  }
+  uint32_t nameSize;
+  memcpy(&nameSize, m_buffer.data(), sizeof(nameSize));
+  size_t sizePos = sizeof(nameSize) + nameSize;
+  uint64_t size = m_buffer.size() - sizePos - sizeof(uint64_t);
+  memcpy(&m_buffer[sizePos], &size, sizeof(size));
+
+  util::WriteOrThrow(m_file.get(), m_buffer.data(), m_buffer.size());
+  m_inSection = false;
+}
+
+void SnapshotWriter::Write(const void *data, size_t size)
+{
+  m_buffer.append(static_cast<const char*>(data), size);
+}
+
+void SnapshotWriter::WriteString(const StringPiece &str)
+{
+  Write<uint32_t>(str.size());
+  Write(str.data(), str.size());
+}
+
+////////////////////////////////////////////////////////////////////////////
+SnapshotReader::SnapshotReader(const std::string &path, uint64_t fingerprint)
+  :m_path(path)
+  ,m_file(util::OpenReadOrThrow(path.c_str()))
+{
+  uint64_t size = util::SizeOrThrow(m_file.get());
+  UTIL_THROW_IF2(size < sizeof(Header), path << " is not a snapshot");
+  util::MapRead(util::POPULATE_OR_READ, m_file.get(), 0, size, m_mem);
+
+  const char *begin = static_cast<const char*>(m_mem.get());
+  const char *end = begin + size;
+
+  Header header;
+  memcpy(&header, begin, sizeof(header));
+  UTIL_THROW_IF2(memcmp(header.magic, MAGIC, sizeof(MAGIC)), path << " is not a snapshot");
+  UTIL_THROW_IF2(header.version != VERSION,
+                 path << " is snapshot version " << header.version << ", this decoder reads version "
+                 << VERSION << ". Freeze it again");
+  UTIL_THROW_IF2(header.fingerprint != fingerprint,
+                 path << " was frozen with different features or weights. Freeze it again");
+
+  SnapshotSection sections("", begin + sizeof(header), end);
+  while (!sections.AtEnd()) {
+    string name = sections.ReadString().as_string();
+    uint64_t sectionSize = sections.Read<uint64_t>();
+    const char *sectionBegin = static_cast<const char*>(sections.Read(sectionSize));
+    m_sections[name] = std::make_pair(sectionBegin, sectionBegin + sectionSize);
+  }
+}
+
+SnapshotSection SnapshotReader::GetSection(const std::string &name) const
+{
+  Sections::const_iterator iter = m_sections.find(name);
+  UTIL_THROW_IF2(iter == m_sections.end(), m_path << " has no section " << name);
+  return SnapshotSection(name, iter->second.first, iter->second.second);
+}
+
+////////////////////////////////////////////////////////////////////////////
+namespace
+{
+// what the feature functions are and what they load. Search, input and
+// output options can change without freezing again
+const char *const MODEL_PARAMS[] = {
+  "feature", "weight", "weight-file",
+  "feature-add", "weight-add", "feature-overwrite", "weight-overwrite",
+  // model files of the deprecated feature options
+  "distortion-file", "generation-file", "global-lexical-file",
+  "lmodel-file", "slmodel-file", "ttable-file"
+};
+}
+
+uint64_t SnapshotFingerprint(const Parameter &params)
+{
+  uint64_t ret = 0;
+  for (size_t i = 0; i < sizeof(MODEL_PARAMS) / sizeof(MODEL_PARAMS[0]); ++i) {
+    const PARAM_VEC *values = params.GetParam(MODEL_PARAMS[i]);
+    if (!values) {
+      continue;
+    }
+    ret = util::MurmurHashNative(MODEL_PARAMS[i], strlen(MODEL_PARAMS[i]), ret);
+    BOOST_FOREACH(const std::string &value, *values) {
+      ret = util::MurmurHashNative(value.data(), value.size(), ret + 1);
+    }
+  }
+  return ret;
+}
+
+void WriteFileStamp(SnapshotWriter &writer, const std::string &path)
+{
+  struct stat st;
+  UTIL_THROW_IF2(stat(path.c_str(), &st), "Can't stat " << path);
+  writer.Write<uint64_t>(st.st_size);
+  writer.Write<int64_t>(st.st_mtime);
+}
+
+bool SameFileStamp(SnapshotSection &section, const std::string &path)
+{
+  uint64_t size = section.Read<uint64_t>();
+  int64_t mtime = section.Read<int64_t>();
+
+  struct stat st;
+  if (stat(path.c_str(), &st)) {
+    return false;
+  }
+  return uint64_t(st.st_size) == size && int64_t(st.st_mtime) == mtime;
+}
+
+}
+
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/mmap.hh"
+#include "util/string_piece.hh"
+
+namespace Moses2
+{
+
+class Parameter;
+
+/** Start-up state that is slow to rebuild from the model files, eg. phrase
+ *  table vocabularies, saved with -freeze-snapshot and mapped back at the next
+ *  start with -thaw-snapshot.
+ *  The file is a header then named sections, one per feature function that
+ *  saves anything. It is only valid for the features and weights it was made
+ *  with, which a fingerprint of those parameters checks. Each feature function
+ *  checks that its own model files haven't changed.
+ */
+class SnapshotWriter
+{
+public:
+  SnapshotWriter(const std::string &path, uint64_t fingerprint);
+
+  //! a section ends when the next begins, or at Finish()
+  void BeginSection(const std::string &name);
+  void Finish();
+
+  void Write(const void *data, size_t size);
+
+  template<typename T>
+  void Write(const T &value) {
+    Write(&value, sizeof(T));
+  }
+
+  void WriteString(const StringPiece &str);
+
+protected:
+  std::string m_path;
+  util::scoped_fd m_file;
+  bool m_inSection;
+  std::string m_buffer; // the open section, written in one go when it ends
+
+  void EndSection();
+};
+
+//! reads one section of a mapped snapshot, in the order it was written
+class SnapshotSection
+{
+public:
+  SnapshotSection(const std::string &name, const char *begin, const char *end)
+    :m_name(name), m_cur(begin), m_end(end) {
+  }
+
+  const void *Read(size_t size) {
+    UTIL_THROW_IF2(size > size_t(m_end - m_cur), "Snapshot section " << m_name << " is truncated");
+    const char *ret = m_cur;
+    m_cur += size;
+    return ret;
+  }
+
+  template<typename T>
+  T Read() {
+    T ret;
+    memcpy(&ret, Read(sizeof(T)), sizeof(T));
+    return ret;
+  }
+
+  //! points into the mapping
+  StringPiece ReadString() {
+    uint32_t size = Read<uint32_t>();
+    return StringPiece(static_cast<const char*>(Read(size)), size);
+  }
+
+  bool AtEnd() const {
+    return m_cur == m_end;
+  }
+
+protected:
+  std::string m_name;
+  const char *m_cur, *m_end;
+};
+
+class SnapshotReader
+{
+public:
+  //! throws if path isn't a snapshot of this version, or was made with other parameters
+  SnapshotReader(const std::string &path, uint64_t fingerprint);
+
+  bool HasSection(const std::string &name) const {
+    return m_sections.find(name) != m_sections.end();
+  }
+
+  //! throws if there is no section of this name
+  SnapshotSection GetSection(const std::string &name) const;
+
+protected:
+  std::string m_path;
+  util::scoped_fd m_file;
+  util::scoped_memory m_mem;
+
+  typedef std::map<std::string, std::pair<const char*, const char*> > Sections;
+  Sections m_sections;
+};
+
+//! of the feature lines, weights and model file parameters. Differs if the model changed
+uint64_t SnapshotFingerprint(const Parameter &params);
+
+//! size and modification time, so a section can tell if a model file changed since it was frozen
+void WriteFileStamp(SnapshotWriter &writer, const std::string &path);
+bool SameFileStamp(SnapshotSection &section, const std::string &path);
+
+}
+
@@ -10,8 +10,10 @@
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include "System.h"
+#include "Snapshot.h"
 #include "FF/FeatureFunction.h"
 #include "TranslationModel/UnknownWordPenalty.h"
+#include "legacy/Timer.h"
 #include "legacy/Util2.h"
 #include "util/exception.hh"
 
@@ -34,6 +36,8 @@ System::System(const Parameter &paramsArg) :
 
   params.SetParameter(cpuAffinityOffset, "cpu-affinity-offset", -1);
   params.SetParameter(cpuAffinityOffsetIncr, "cpu-affinity-increment", 1);
+  params.SetParameter(memPoolMaxRetained, "mempool-max-retained", size_t(0));
+  params.SetParameter(memPoolHugePages, "mempool-huge-pages", false);
 
   const PARAM_VEC *section;
 
@@ -55,8 +59,26 @@ System::System(const Parameter &paramsArg) :
     //return;
   }
 
+  // a thawed phrase table doesn't have all it would need to freeze itself
+  UTIL_THROW_IF2(params.GetParam("thaw-snapshot") && params.GetParam("freeze-snapshot"),
+                 "Can't both freeze and thaw a snapshot");
+  const PARAM_VEC *thawPath = params.GetParam("thaw-snapshot");
+  if (thawPath && thawPath->size()) {
+    Timer thawTimer;
+    thawTimer.start();
+    m_snapshot.reset(new SnapshotReader((*thawPath)[0], SnapshotFingerprint(params)));
+    cerr << "Mapped snapshot " << (*thawPath)[0] << " in " << thawTimer.get_elapsed_time() << " s" << endl;
+  }
+
+  Timer loadTimer;
+  loadTimer.start();
   cerr << "START featureFunctions.Load()" << endl;
   featureFunctions.Load();
+  cerr << "Loaded feature functions in " << loadTimer.get_elapsed_time() << " s" << endl;
+
+  // feature functions have what they need from it
+  m_snapshot.reset();
+
   cerr << "START LoadMappings()" << endl;
   LoadMappings();
   cerr << "END LoadMappings()" << endl;
@@ -185,6 +207,20 @@ Recycler<HypothesisBase*> &System::GetHypoRecycler() const
   return m_hypoRecycler;
 }
 
+void System::Freeze(const std::string &path) const
+{
+  Timer timer;
+  timer.start();
+
+  SnapshotWriter writer(path, SnapshotFingerprint(params));
+  BOOST_FOREACH(const FeatureFunction *ff, featureFunctions.GetFeatureFunctions()) {
+    ff->Freeze(writer);
+  }
+  writer.Finish();
+
+  cerr << "Froze snapshot " << path << " in " << timer.get_elapsed_time() << " s" << endl;
+}
+
 Batch &System::GetBatch(MemPool &pool) const
 {
   Batch *obj;
@@ -11,6 +11,7 @@
 #include <boost/thread/tss.hpp>
 #include <boost/pool/object_pool.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 #include "FF/FeatureFunctions.h"
 #include "Weights.h"
 #include "MemPool.h"
@@ -33,6 +34,7 @@ class FeatureFunction;
 class StatefulFeatureFunction;
 class PhraseTable;
 class HypothesisBase;
+class SnapshotReader;
 
 class System
 {
@@ -51,6 +53,8 @@ public:
   // moses.ini params
   int cpuAffinityOffset;
   int cpuAffinityOffsetIncr;
+  size_t memPoolMaxRetained;
+  bool memPoolHugePages;
 
   System(const Parameter &paramsArg);
   virtual ~System();
@@ -63,8 +67,17 @@ public:
 
   Batch &GetBatch(MemPool &pool) const;
 
+  //! while loading with -thaw-snapshot, otherwise NULL
+  const SnapshotReader *GetSnapshot() const {
+    return m_snapshot.get();
+  }
+
+  //! for -freeze-snapshot
+  void Freeze(const std::string &path) const;
+
 protected:
   mutable FactorCollection m_vocab;
+  boost::scoped_ptr<SnapshotReader> m_snapshot;
   //mutable boost::thread_specific_ptr<MemPool> m_managerPool;
   //mutable boost::thread_specific_ptr<MemPool> m_systemPool;
   thread_local static MemPool m_managerPool;
@@ -23,8 +23,11 @@
 #define moses_CanonicalHuffman_h
 
 #include <string>
+#include <stdint.h>
 #include <algorithm>
+#include <vector>
 #include <boost/dynamic_bitset.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
 #include <boost/unordered_map.hpp>
 
 #include "ThrowingFwrite.h"
@@ -43,6 +46,21 @@ private:
   typedef boost::unordered_map<Data, boost::dynamic_bitset<> > EncodeMap;
   EncodeMap m_encodeMap;
 
+  // decodes the next m_lookupBits bits in one step. Entries with length 0
+  // start with a longer code, code holds what was decoded of it
+  struct LookupEntry {
+    Data symbol;
+    unsigned short code;
+    unsigned char length;
+  };
+  static const size_t LOOKUP_BITS = 10;
+  size_t m_lookupBits;
+  std::vector<LookupEntry> m_lookup;
+
+  // longer codes are decoded from this many bits read at once
+  static const size_t MAX_PEEK_BITS = 57;
+  size_t m_peekBits;
+
   struct MinHeapSorter {
     std::vector<size_t>& m_vec;
 
@@ -143,6 +161,36 @@ private:
     m_symbols.swap(t_symbols);
   }
 
+  void CreateLookup() {
+    m_lookup.clear();
+    if (m_firstCodes.size() < 2) return;
+
+    size_t maxLength = m_firstCodes.size() - 1;
+    m_lookupBits = maxLength < LOOKUP_BITS ? maxLength : LOOKUP_BITS;
+    m_peekBits = maxLength < MAX_PEEK_BITS ? maxLength : MAX_PEEK_BITS;
+    m_lookup.resize(size_t(1) << m_lookupBits);
+    for (size_t bits = 0; bits < m_lookup.size(); bits++) {
+      // as ReadBitByBit(), with the first bit of the stream in the lowest bit
+      LookupEntry& entry = m_lookup[bits];
+      entry.length = 0;
+
+      size_t intCode = bits & 1;
+      size_t len = 1;
+      while (intCode < m_firstCodes[len] && len < m_lookupBits) {
+        intCode = 2 * intCode + ((bits >> len) & 1);
+        len++;
+      }
+      if (intCode < m_firstCodes[len]) {
+        entry.code = intCode;
+        continue;
+      }
+
+      size_t pos = m_lengthIndex[len] + (intCode - m_firstCodes[len]);
+      entry.symbol = pos < m_symbols.size() ? m_symbols[pos] : Data();
+      entry.length = len;
+    }
+  }
+
   void CreateCodeMap() {
     for (size_t l = 1; l < m_lengthIndex.size(); l++) {
       size_t intCode = m_firstCodes[l];
@@ -179,12 +227,14 @@ public:
     std::vector<size_t> lengths;
     CalcLengths(begin, end, lengths);
     CalcCodes(lengths);
+    CreateLookup();
 
     if (forEncoding) CreateCodeMap();
   }
 
   CanonicalHuffman(std::FILE* pFile, bool forEncoding = false) {
     Load(pFile);
+    CreateLookup();
 
     if (forEncoding) CreateCodeMap();
   }
@@ -196,6 +246,35 @@ public:
 
   template<class BitWrapper>
   Data Read(BitWrapper& bitWrapper) {
+    size_t bitsLeft = bitWrapper.TellFromEnd();
+    if (m_lookup.empty() || bitsLeft < m_lookupBits)
+      return ReadBitByBit(bitWrapper);
+
+    uint64_t bits = bitWrapper.Peek(m_peekBits);
+    const LookupEntry& entry = m_lookup[bits & ((uint64_t(1) << m_lookupBits) - 1)];
+    if (entry.length) {
+      bitWrapper.Skip(entry.length);
+      return entry.symbol;
+    }
+
+    // longer code, continue after the bits in the table
+    size_t intCode = entry.code;
+    size_t len = m_lookupBits;
+    while (intCode < m_firstCodes[len] && len < m_peekBits) {
+      intCode = 2 * intCode + ((bits >> len) & 1);
+      len++;
+    }
+    if (intCode < m_firstCodes[len] || len > bitsLeft) {
+      // longer than we can peek at, or runs past the end
+      return ReadBitByBit(bitWrapper);
+    }
+    bitWrapper.Skip(len);
+    return m_symbols[m_lengthIndex[len] + (intCode - m_firstCodes[len])];
+  }
+
+  //! one bit per step, for codes longer than the lookup table
+  template<class BitWrapper>
+  Data ReadBitByBit(BitWrapper& bitWrapper) {
     if (bitWrapper.TellFromEnd()) {
       size_t intCode = bitWrapper.Read();
       size_t len = 1;
@@ -293,6 +372,38 @@ public:
     return m_data.size() * m_valueBits - m_bitPos;
   }
 
+  //! the next bits (up to 57), without reading them. The first bit is the
+  //! lowest, bits past the end are 0
+  uint64_t Peek(size_t bits) const {
+    typedef typename boost::make_unsigned<typename Container::value_type>::type Value;
+    const size_t valueBits = sizeof(Value) * 8;
+    const size_t numValues = sizeof(uint64_t) / sizeof(Value);
+    size_t ind = m_bitPos / valueBits;
+    size_t offset = m_bitPos % valueBits;
+
+    uint64_t ret = 0;
+    if (ind + numValues <= m_data.size()) {
+      // fixed number of values, so the compiler can make it one load
+      for (size_t i = 0; i < numValues; i++)
+        ret |= uint64_t(Value(m_data[ind + i])) << (i * valueBits);
+    } else {
+      for (size_t i = 0; ind + i < m_data.size() && i < numValues; i++)
+        ret |= uint64_t(Value(m_data[ind + i])) << (i * valueBits);
+    }
+    return (ret >> offset) & ((uint64_t(1) << bits) - 1);
+  }
+
+  //! as Seek(Tell() + bits), with the divisions by constants
+  void Skip(size_t bits) {
+    const size_t valueBits = sizeof(typename Container::value_type) * 8;
+    if (bits) {
+      m_bitPos += bits;
+      m_iterator = m_data.begin() + (m_bitPos - 1) / valueBits;
+      m_currentValue = (*m_iterator) >> ((m_bitPos - 1) % valueBits);
+      m_iterator++;
+    }
+  }
+
   void Seek(size_t bitPos) {
     m_bitPos = bitPos;
     m_iterator = m_data.begin() + int((m_bitPos - 1) / m_valueBits);
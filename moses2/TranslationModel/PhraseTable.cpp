@@ -6,6 +6,7 @@
  */
 #include <boost/foreach.hpp>
 #include <queue>
+#include <sstream>
 #include "PhraseTable.h"
 #include "../legacy/Util2.h"
 #include "../TypeDef.h"
@@ -74,6 +75,7 @@ bool PhraseTable::SatisfyBackoff(const Manager &mgr, const InputPath &path) cons
 
 void PhraseTable::Lookup(const Manager &mgr, InputPathsBase &inputPaths) const
 {
+  LookupStats stats;
   BOOST_FOREACH(InputPathBase *pathBase, inputPaths) {
     InputPath *path = static_cast<InputPath*>(pathBase);
     //cerr << "path=" << path->range << " ";
@@ -89,9 +91,29 @@ void PhraseTable::Lookup(const Manager &mgr, InputPathsBase &inputPaths) const
        */
 
       path->AddTargetPhrases(*this, tpsPtr);
+      ++stats.probed;
+      if (tpsPtr) {
+        ++stats.matched;
+      }
     }
   }
 
+  ReportLookupStats(mgr, stats);
+}
+
+void PhraseTable::ReportLookupStats(const Manager &mgr, const LookupStats &stats) const
+{
+  if (!mgr.system.options.output.ReportLookupStats) {
+    return;
+  }
+
+  // one write, so lines from different threads don't mix
+  stringstream out;
+  out << "Lookup " << GetName() << " sentence " << mgr.GetTranslationId() << ": "
+      << stats.probed << " spans probed, "
+      << stats.skipped << " skipped, "
+      << stats.matched << " matched" << endl;
+  cerr << out.str();
 }
 
 TargetPhrases *PhraseTable::Lookup(const Manager &mgr, MemPool &pool,
@@ -30,6 +30,18 @@ class Manager;
 class ActiveChartEntry;
 }
 
+////////////////////////////////////////////////////////////////////////
+//! what happened to the spans of one sentence in the lookup of one phrase table
+struct LookupStats {
+  size_t probed; // looked up in the table or its caches
+  size_t skipped; // known not to match without a lookup
+  size_t matched; // had translations
+
+  LookupStats()
+    :probed(0), skipped(0), matched(0) {
+  }
+};
+
 ////////////////////////////////////////////////////////////////////////
 class PhraseTable: public StatelessFeatureFunction
 {
@@ -91,6 +103,9 @@ protected:
   // cache
   size_t m_maxCacheSize; // 0 = no caching
 
+  //! to stderr, if -report-lookup-stats
+  void ReportLookupStats(const Manager &mgr, const LookupStats &stats) const;
+
   struct CacheCollEntry2 {
     TargetPhrases *tpsPtr;
     clock_t clock;
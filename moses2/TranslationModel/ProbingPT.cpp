@@ -6,9 +6,12 @@
  */
 #include <boost/foreach.hpp>
 #include "ProbingPT.h"
+#include "TargetPhrasesCache.h"
+#include "../Snapshot.h"
 #include "probingpt/querying.h"
 #include "probingpt/probing_hash_utils.h"
 #include "util/exception.hh"
+#include "util/prefetch.hh"
 #include "../System.h"
 #include "../Scores.h"
 #include "../Phrase.h"
@@ -70,74 +73,207 @@ std::pair<bool, uint64_t> ProbingPT::ActiveChartEntryProbing::GetKey(const SCFG:
 ProbingPT::ProbingPT(size_t startInd, const std::string &line)
   :PhraseTable(startInd, line)
   ,load_method(util::POPULATE_OR_READ)
+  ,m_runtimeCacheBytes(0)
+  ,m_runtimeCache(NULL)
 {
   ReadParameters();
 }
 
 ProbingPT::~ProbingPT()
 {
+  if (m_runtimeCache) {
+    TargetPhrasesCache::Stats stats = m_runtimeCache->GetStats();
+    size_t lookups = stats.hits + stats.misses;
+    cerr << GetName() << " runtime cache: " << stats.hits << " hits, "
+         << stats.misses << " misses, hit rate " << (lookups ? float(stats.hits) / lookups : 0)
+         << ", " << stats.insertions << " insertions, " << stats.evictions << " evictions, "
+         << stats.entries << " entries, " << stats.bytes << " bytes" << endl;
+    delete m_runtimeCache;
+  }
   delete m_engine;
 }
 
 void ProbingPT::Load(System &system)
 {
-  m_engine = new probingpt::QueryEngine(m_path.c_str(), load_method);
+  // a snapshot has everything but the hash table and target phrases,
+  // if the model hasn't changed since
+  const SnapshotReader *snapshot = system.GetSnapshot();
+  bool thaw = snapshot && snapshot->HasSection(GetName());
+  SnapshotSection section = thaw ? snapshot->GetSection(GetName()) : SnapshotSection(GetName(), NULL, NULL);
+  if (thaw && !SameModelFiles(section)) {
+    cerr << GetName() << " has changed since the snapshot was frozen. Loading it from " << m_path << endl;
+    thaw = false;
+  }
 
-  m_unkId = 456456546456;
+  m_engine = new probingpt::QueryEngine(m_path.c_str(), load_method, !thaw);
 
-  FactorCollection &vocab = system.GetVocab();
+  m_unkId = 456456546456;
 
-  // source vocab
-  const std::map<uint64_t, std::string> &sourceVocab =
-    m_engine->getSourceVocab();
-  std::map<uint64_t, std::string>::const_iterator iterSource;
-  for (iterSource = sourceVocab.begin(); iterSource != sourceVocab.end();
-       ++iterSource) {
-    string wordStr = iterSource->second;
-    bool isNT;
-    //cerr << "wordStr=" << wordStr << endl;
-    ReformatWord(system, wordStr, isNT);
-    //cerr << "wordStr=" << wordStr << endl;
+  if (thaw) {
+    Thaw(system, section);
+  } else {
+    // source vocab
+    const std::map<uint64_t, std::string> &sourceVocab =
+      m_engine->getSourceVocab();
+    std::map<uint64_t, std::string>::const_iterator iterSource;
+    for (iterSource = sourceVocab.begin(); iterSource != sourceVocab.end();
+         ++iterSource) {
+      AddSourceWord(system, iterSource->first, iterSource->second);
+    }
 
-    const Factor *factor = vocab.AddFactor(wordStr, system, isNT);
+    // target vocab
+    InputFileStream targetVocabStrme(m_path + "/TargetVocab.dat");
+    string line;
+    while (getline(targetVocabStrme, line)) {
+      vector<string> toks = Tokenize(line, "\t");
+      UTIL_THROW_IF2(toks.size() != 2, string("Incorrect format:") + line + "\n");
 
-    uint64_t probingId = iterSource->first;
-    size_t factorId = factor->GetId();
+      bool isNT;
+      //cerr << "wordStr=" << toks[0] << endl;
+      ReformatWord(system, toks[0], isNT);
+      //cerr << "wordStr=" << toks[0] << endl;
 
-    if (factorId >= m_sourceVocab.size()) {
-      m_sourceVocab.resize(factorId + 1, m_unkId);
+      uint32_t probingId = Scan<uint32_t>(toks[1]);
+      AddTargetWord(system, probingId, toks[0], isNT);
     }
-    m_sourceVocab[factorId] = probingId;
+
+    // alignments
+    CreateAlignmentMap(system, m_path + "/Alignments.dat");
+
+    // cache
+    CreateCache(system);
   }
 
-  // target vocab
-  InputFileStream targetVocabStrme(m_path + "/TargetVocab.dat");
-  string line;
-  while (getline(targetVocabStrme, line)) {
-    vector<string> toks = Tokenize(line, "\t");
-    UTIL_THROW_IF2(toks.size() != 2, string("Incorrect format:") + line + "\n");
+  if (m_runtimeCacheBytes) {
+    m_runtimeCache = new TargetPhrasesCache(system, m_runtimeCacheBytes);
+  }
+}
 
-    bool isNT;
-    //cerr << "wordStr=" << toks[0] << endl;
-    ReformatWord(system, toks[0], isNT);
-    //cerr << "wordStr=" << toks[0] << endl;
+void ProbingPT::AddSourceWord(System &system, uint64_t probingId, const std::string &str)
+{
+  string wordStr = str;
+  bool isNT;
+  //cerr << "wordStr=" << wordStr << endl;
+  ReformatWord(system, wordStr, isNT);
+  //cerr << "wordStr=" << wordStr << endl;
 
-    const Factor *factor = vocab.AddFactor(toks[0], system, isNT);
-    uint32_t probingId = Scan<uint32_t>(toks[1]);
+  const Factor *factor = system.GetVocab().AddFactor(wordStr, system, isNT);
 
-    if (probingId >= m_targetVocab.size()) {
-      m_targetVocab.resize(probingId + 1);
-    }
+  size_t factorId = factor->GetId();
+
+  if (factorId >= m_sourceVocab.size()) {
+    m_sourceVocab.resize(factorId + 1, m_unkId);
+  }
+  m_sourceVocab[factorId] = probingId;
+}
+
+void ProbingPT::AddTargetWord(System &system, uint32_t probingId, const StringPiece &wordStr, bool isNT)
+{
+  const Factor *factor = system.GetVocab().AddFactor(wordStr, system, isNT);
+
+  if (probingId >= m_targetVocab.size()) {
+    m_targetVocab.resize(probingId + 1);
+  }
+
+  std::pair<bool, const Factor*> ele(isNT, factor);
+  m_targetVocab[probingId] = ele;
+}
+
+void ProbingPT::Freeze(SnapshotWriter &writer) const
+{
+  writer.BeginSection(GetName());
+  WriteFileStamp(writer, m_path + "/source_vocabids");
+  WriteFileStamp(writer, m_path + "/TargetVocab.dat");
+  WriteFileStamp(writer, m_path + "/Alignments.dat");
+  WriteFileStamp(writer, m_path + "/cache");
+  writer.Write<uint64_t>(m_maxCacheSize);
+
+  // source vocab, as in the model, since that is what GetSourceProbingId() needs
+  const std::map<uint64_t, std::string> &sourceVocab = m_engine->getSourceVocab();
+  writer.Write<uint64_t>(sourceVocab.size());
+  std::map<uint64_t, std::string>::const_iterator iterSource;
+  for (iterSource = sourceVocab.begin(); iterSource != sourceVocab.end(); ++iterSource) {
+    writer.Write<uint64_t>(iterSource->first);
+    writer.WriteString(iterSource->second);
+  }
 
-    std::pair<bool, const Factor*> ele(isNT, factor);
-    m_targetVocab[probingId] = ele;
+  // target vocab, reformatted
+  uint64_t numTarget = 0;
+  for (size_t i = 0; i < m_targetVocab.size(); ++i) {
+    numTarget += m_targetVocab[i].second != NULL;
+  }
+  writer.Write<uint64_t>(numTarget);
+  for (size_t i = 0; i < m_targetVocab.size(); ++i) {
+    const std::pair<bool, const Factor*> &ele = m_targetVocab[i];
+    if (ele.second) {
+      writer.Write<uint32_t>(i);
+      writer.Write<char>(ele.first);
+      writer.WriteString(ele.second->GetString());
+    }
   }
 
   // alignments
-  CreateAlignmentMap(system, m_path + "/Alignments.dat");
+  const std::vector< std::vector<unsigned char> > &probingAlignColl = m_engine->getAlignments();
+  writer.Write<uint64_t>(probingAlignColl.size());
+  for (size_t i = 0; i < probingAlignColl.size(); ++i) {
+    const std::vector<unsigned char> &probingAligns = probingAlignColl[i];
+    writer.Write<uint32_t>(probingAligns.size());
+    if (probingAligns.size()) {
+      writer.Write(&probingAligns[0], probingAligns.size());
+    }
+  }
+
+  // cache: the keys and source phrases. Its target phrases are made again from the table
+  vector<pair<uint64_t, string> > cache;
+  ReadCacheFile(cache);
+  writer.Write<uint64_t>(cache.size());
+  for (size_t i = 0; i < cache.size(); ++i) {
+    writer.Write<uint64_t>(cache[i].first);
+    writer.WriteString(cache[i].second);
+  }
+}
 
-  // cache
-  CreateCache(system);
+bool ProbingPT::SameModelFiles(SnapshotSection &section) const
+{
+  bool ret = SameFileStamp(section, m_path + "/source_vocabids");
+  ret = SameFileStamp(section, m_path + "/TargetVocab.dat") && ret;
+  ret = SameFileStamp(section, m_path + "/Alignments.dat") && ret;
+  ret = SameFileStamp(section, m_path + "/cache") && ret;
+  ret = section.Read<uint64_t>() == m_maxCacheSize && ret;
+  return ret;
+}
+
+void ProbingPT::Thaw(System &system, SnapshotSection &section)
+{
+  uint64_t numSource = section.Read<uint64_t>();
+  for (uint64_t i = 0; i < numSource; ++i) {
+    uint64_t probingId = section.Read<uint64_t>();
+    AddSourceWord(system, probingId, section.ReadString().as_string());
+  }
+
+  uint64_t numTarget = section.Read<uint64_t>();
+  for (uint64_t i = 0; i < numTarget; ++i) {
+    uint32_t probingId = section.Read<uint32_t>();
+    bool isNT = section.Read<char>();
+    AddTargetWord(system, probingId, section.ReadString(), isNT);
+  }
+
+  uint64_t numAligns = section.Read<uint64_t>();
+  m_aligns.resize(numAligns, NULL);
+  for (uint64_t i = 0; i < numAligns; ++i) {
+    uint32_t size = section.Read<uint32_t>();
+    const unsigned char *probingAligns = static_cast<const unsigned char*>(section.Read(size));
+    m_aligns[i] = CreateAlignment(probingAligns, size);
+  }
+
+  MemPool tmpSourcePool;
+  uint64_t numCache = section.Read<uint64_t>();
+  for (uint64_t i = 0; i < numCache; ++i) {
+    uint64_t key = section.Read<uint64_t>();
+    AddToCache(system, tmpSourcePool, key, section.ReadString().as_string());
+  }
+
+  UTIL_THROW_IF2(!section.AtEnd(), "Snapshot section " << GetName() << " is longer than expected");
 }
 
 void ProbingPT::SetParameter(const std::string& key, const std::string& value)
@@ -153,9 +289,15 @@ void ProbingPT::SetParameter(const std::string& key, const std::string& value)
       load_method = util::READ;
     } else if (value == "parallel_read") {
       load_method = util::PARALLEL_READ;
+    } else if (value == "huge_read") {
+      load_method = util::HUGE_READ;
+    } else if (value == "background") {
+      load_method = util::BACKGROUND_POPULATE;
     } else {
       UTIL_THROW2("load method not supported" << value);
     }
+  } else if (key == "runtime-cache-bytes") {
+    m_runtimeCacheBytes = Scan<size_t>(value);
   } else {
     PhraseTable::SetParameter(key, value);
   }
@@ -167,33 +309,110 @@ void ProbingPT::CreateAlignmentMap(System &system, const std::string path)
   m_aligns.resize(probingAlignColl.size(), NULL);
 
   for (size_t i = 0; i < probingAlignColl.size(); ++i) {
-    AlignmentInfo::CollType aligns;
-
     const std::vector<unsigned char> &probingAligns = probingAlignColl[i];
-    for (size_t j = 0; j < probingAligns.size(); j += 2) {
-      size_t startPos = probingAligns[j];
-      size_t endPos = probingAligns[j+1];
-      //cerr << "startPos=" << startPos << " " << endPos << endl;
-      aligns.insert(std::pair<size_t,size_t>(startPos, endPos));
-    }
+    m_aligns[i] = CreateAlignment(probingAligns.empty() ? NULL : &probingAligns[0], probingAligns.size());
+    //cerr << "align=" << m_aligns[i]->Debug(system) << endl;
+  }
+}
 
-    const AlignmentInfo *align = AlignmentInfoCollection::Instance().Add(aligns);
-    m_aligns[i] = align;
-    //cerr << "align=" << align->Debug(system) << endl;
+const AlignmentInfo *ProbingPT::CreateAlignment(const unsigned char probingAligns[], size_t size)
+{
+  AlignmentInfo::CollType aligns;
+  for (size_t j = 0; j < size; j += 2) {
+    size_t startPos = probingAligns[j];
+    size_t endPos = probingAligns[j+1];
+    //cerr << "startPos=" << startPos << " " << endPos << endl;
+    aligns.insert(std::pair<size_t,size_t>(startPos, endPos));
   }
+
+  return AlignmentInfoCollection::Instance().Add(aligns);
 }
 
 void ProbingPT::Lookup(const Manager &mgr, InputPathsBase &inputPaths) const
 {
+  MemPool &pool = mgr.GetPool();
+  LookupStats stats;
+
+  // hash every span first. Spans that are cached or contain unknown words
+  // are done straight away, and so are spans that no source phrase starts with.
+  // Then the longer spans from the same position can't match either. The
+  // paths come by start position, then length
+  size_t deadStart = NOT_FOUND;
+  Vector<InputPath*> paths(pool);
+  Vector<uint64_t> keys(pool);
+  Vector<char> admit(pool);
   BOOST_FOREACH(InputPathBase *pathBase, inputPaths) {
     InputPath *path = static_cast<InputPath*>(pathBase);
+    if (!SatisfyBackoff(mgr, *path)) {
+      continue;
+    }
 
-    if (SatisfyBackoff(mgr, *path)) {
-      TargetPhrases *tpsPtr;
-      tpsPtr = Lookup(mgr, mgr.GetPool(), *path);
-      path->AddTargetPhrases(*this, tpsPtr);
+    size_t startPos = path->range.GetStartPos();
+    if (startPos == deadStart) {
+      path->AddTargetPhrases(*this, NULL);
+      ++stats.skipped;
+      continue;
     }
+
+    std::pair<bool, uint64_t> keyStruct = GetKey(path->subPhrase);
+    if (!keyStruct.first || !m_engine->mayBePrefix(keyStruct.second)) {
+      path->AddTargetPhrases(*this, NULL);
+      ++stats.skipped;
+      deadStart = startPos;
+      continue;
+    }
+
+    CachePb::const_iterator iter = m_cachePb.find(keyStruct.second);
+    if (iter != m_cachePb.end()) {
+      path->AddTargetPhrases(*this, iter->second);
+      ++stats.probed;
+      ++stats.matched;
+      continue;
+    }
+
+    bool admitKey = false;
+    if (m_runtimeCache) {
+      const TargetPhrasesCache::Entry *entry = m_runtimeCache->Find(mgr, keyStruct.second, admitKey);
+      if (entry) {
+        path->AddTargetPhrases(*this, entry->tps);
+        ++stats.probed;
+        if (entry->tps) {
+          ++stats.matched;
+        }
+        continue;
+      }
+    }
+
+    paths.push_back(path);
+    keys.push_back(keyStruct.second);
+    admit.push_back(admitKey);
+  }
+
+  if (!paths.empty()) {
+    // then look up the rest together, so their cache misses overlap
+    Vector<std::pair<bool, uint64_t> > results(pool, keys.size());
+    m_engine->query_batch(&keys[0], keys.size(), &results[0]);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+      if (results[i].first) {
+        util::Prefetch(m_engine->memTPS + results[i].second);
+      }
+    }
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+      InputPath &path = *paths[i];
+      TargetPhrases *tps = NULL;
+      if (results[i].first) {
+        tps = CreateTargetPhrasesCached(mgr, pool, path.subPhrase, keys[i], admit[i],
+                                        m_engine->memTPS + results[i].second);
+        ++stats.matched;
+      }
+      path.AddTargetPhrases(*this, tps);
+    }
+    stats.probed += paths.size();
   }
+
+  ReportLookupStats(mgr, stats);
 }
 
 TargetPhrases* ProbingPT::Lookup(const Manager &mgr, MemPool &pool,
@@ -226,10 +445,35 @@ TargetPhrases* ProbingPT::Lookup(const Manager &mgr, MemPool &pool,
     return tps;
   }
 
+  bool admit = false;
+  if (m_runtimeCache) {
+    const TargetPhrasesCache::Entry *entry = m_runtimeCache->Find(mgr, keyStruct.second, admit);
+    if (entry) {
+      return entry->tps;
+    }
+  }
+
   // query pt
-  TargetPhrases *tps = CreateTargetPhrases(pool, mgr.system, sourcePhrase,
-                       keyStruct.second);
-  return tps;
+  std::pair<bool, uint64_t> query_result = m_engine->query(keyStruct.second);
+  if (!query_result.first) {
+    return NULL;
+  }
+  return CreateTargetPhrasesCached(mgr, pool, sourcePhrase, keyStruct.second, admit,
+                                   m_engine->memTPS + query_result.second);
+}
+
+TargetPhrases *ProbingPT::CreateTargetPhrasesCached(const Manager &mgr, MemPool &pool,
+    const Phrase<Moses2::Word> &sourcePhrase, uint64_t key, bool admit,
+    const char *offset) const
+{
+  if (!admit) {
+    return CreateTargetPhrases(pool, mgr.system, sourcePhrase, offset);
+  }
+
+  // create in the entry's own pool, which lives as long as the entry
+  TargetPhrasesCache::EntryPtr entry = m_runtimeCache->CreateEntry();
+  entry->tps = CreateTargetPhrases(entry->GetPool(), mgr.system, sourcePhrase, offset);
+  return m_runtimeCache->Add(mgr, key, entry)->tps;
 }
 
 std::pair<bool, uint64_t> ProbingPT::GetKey(const Phrase<Moses2::Word> &sourcePhrase) const
@@ -264,27 +508,36 @@ TargetPhrases *ProbingPT::CreateTargetPhrases(MemPool &pool,
   //cerr << "key2=" << query_result.second << endl;
 
   if (query_result.first) {
-    const char *offset = m_engine->memTPS + query_result.second;
-    uint64_t *numTP = (uint64_t*) offset;
+    tps = CreateTargetPhrases(pool, system, sourcePhrase,
+                              m_engine->memTPS + query_result.second);
+  }
+
+  return tps;
+}
 
-    tps = new (pool.Allocate<TargetPhrases>()) TargetPhrases(pool, *numTP);
+TargetPhrases *ProbingPT::CreateTargetPhrases(MemPool &pool,
+    const System &system, const Phrase<Moses2::Word> &sourcePhrase,
+    const char *offset) const
+{
+  uint64_t *numTP = (uint64_t*) offset;
 
-    offset += sizeof(uint64_t);
-    for (size_t i = 0; i < *numTP; ++i) {
-      TargetPhraseImpl *tp = CreateTargetPhrase(pool, system, offset);
-      assert(tp);
-      const FeatureFunctions &ffs = system.featureFunctions;
-      ffs.EvaluateInIsolation(pool, system, sourcePhrase, *tp);
+  TargetPhrases *tps = new (pool.Allocate<TargetPhrases>()) TargetPhrases(pool, *numTP);
 
-      tps->AddTargetPhrase(*tp);
+  offset += sizeof(uint64_t);
+  for (size_t i = 0; i < *numTP; ++i) {
+    TargetPhraseImpl *tp = CreateTargetPhrase(pool, system, offset);
+    assert(tp);
+    const FeatureFunctions &ffs = system.featureFunctions;
+    ffs.EvaluateInIsolation(pool, system, sourcePhrase, *tp);
 
-    }
+    tps->AddTargetPhrase(*tp);
 
-    tps->SortAndPrune(m_tableLimit);
-    system.featureFunctions.EvaluateAfterTablePruning(pool, *tps, sourcePhrase);
-    //cerr << *tps << endl;
   }
 
+  tps->SortAndPrune(m_tableLimit);
+  system.featureFunctions.EvaluateAfterTablePruning(pool, *tps, sourcePhrase);
+  //cerr << *tps << endl;
+
   return tps;
 }
 
@@ -401,6 +654,17 @@ uint64_t ProbingPT::GetSourceProbingId(const Word &word) const
 }
 
 void ProbingPT::CreateCache(System &system)
+{
+  vector<pair<uint64_t, string> > cache;
+  ReadCacheFile(cache);
+
+  MemPool tmpSourcePool;
+  for (size_t i = 0; i < cache.size(); ++i) {
+    AddToCache(system, tmpSourcePool, cache[i].first, cache[i].second);
+  }
+}
+
+void ProbingPT::ReadCacheFile(std::vector<std::pair<uint64_t, std::string> > &cache) const
 {
   if (m_maxCacheSize == 0) {
     return;
@@ -413,45 +677,44 @@ void ProbingPT::CreateCache(System &system)
   getline(strme, line);
   //float totalCount = Scan<float>(line);
 
-  MemPool &pool = system.GetSystemPool();
-  FactorCollection &vocab = system.GetVocab();
-
-  MemPool tmpSourcePool;
-
-  size_t lineCount = 0;
-  while (getline(strme, line) && lineCount < m_maxCacheSize) {
+  while (cache.size() < m_maxCacheSize && getline(strme, line)) {
     vector<string> toks = Tokenize(line, "\t");
     assert(toks.size() == 3);
     uint64_t key = Scan<uint64_t>(toks[1]);
     //cerr << "line=" << line << endl;
+    cache.push_back(pair<uint64_t, string>(key, toks[2]));
+  }
+}
 
-    if (system.isPb) {
-      PhraseImpl *sourcePhrase = PhraseImpl::CreateFromString(tmpSourcePool, vocab, system, toks[2]);
+void ProbingPT::AddToCache(System &system, MemPool &tmpSourcePool, uint64_t key, const std::string &sourceStr)
+{
+  MemPool &pool = system.GetSystemPool();
+  FactorCollection &vocab = system.GetVocab();
 
-      /*
-      std::pair<bool, uint64_t> retStruct = GetKey(*sourcePhrase);
-      if (!retStruct.first) {
-      UTIL_THROW2("Unknown cache entry");
-      }
-      cerr << "key=" << retStruct.second << " " << key << endl;
-      */
-      TargetPhrases *tps = CreateTargetPhrases(pool, system, *sourcePhrase, key);
-      assert(tps);
+  if (system.isPb) {
+    PhraseImpl *sourcePhrase = PhraseImpl::CreateFromString(tmpSourcePool, vocab, system, sourceStr);
 
-      m_cachePb[key] = tps;
-    } else {
-      // SCFG
-      SCFG::PhraseImpl *sourcePhrase = SCFG::PhraseImpl::CreateFromString(tmpSourcePool, vocab, system, toks[2], false);
-      //cerr << "sourcePhrase=" << sourcePhrase->Debug(system) << endl;
+    /*
+    std::pair<bool, uint64_t> retStruct = GetKey(*sourcePhrase);
+    if (!retStruct.first) {
+    UTIL_THROW2("Unknown cache entry");
+    }
+    cerr << "key=" << retStruct.second << " " << key << endl;
+    */
+    TargetPhrases *tps = CreateTargetPhrases(pool, system, *sourcePhrase, key);
+    assert(tps);
 
-      std::pair<bool, SCFG::TargetPhrases*> tpsPair = CreateTargetPhrasesSCFG(pool, system, *sourcePhrase, key);
-      assert(tpsPair.first && tpsPair.second);
+    m_cachePb[key] = tps;
+  } else {
+    // SCFG
+    SCFG::PhraseImpl *sourcePhrase = SCFG::PhraseImpl::CreateFromString(tmpSourcePool, vocab, system, sourceStr, false);
+    //cerr << "sourcePhrase=" << sourcePhrase->Debug(system) << endl;
 
-      m_cacheSCFG[key] = tpsPair.second;
-    }
-    ++lineCount;
-  }
+    std::pair<bool, SCFG::TargetPhrases*> tpsPair = CreateTargetPhrasesSCFG(pool, system, *sourcePhrase, key);
+    assert(tpsPair.first && tpsPair.second);
 
+    m_cacheSCFG[key] = tpsPair.second;
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
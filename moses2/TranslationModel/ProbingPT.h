@@ -16,6 +16,7 @@
 #include "../Phrase.h"
 #include "../SCFG/ActiveChart.h"
 #include "util/mmap.hh"
+#include "util/string_piece.hh"
 
 namespace probingpt
 {
@@ -29,6 +30,9 @@ class AlignmentInfo;
 class MemPool;
 class System;
 class RecycleData;
+class TargetPhrasesCache;
+class SnapshotWriter;
+class SnapshotSection;
 
 namespace SCFG
 {
@@ -74,6 +78,7 @@ public:
   ProbingPT(size_t startInd, const std::string &line);
   virtual ~ProbingPT();
   void Load(System &system);
+  void Freeze(SnapshotWriter &writer) const;
 
   virtual void SetParameter(const std::string& key, const std::string& value);
   void Lookup(const Manager &mgr, InputPathsBase &inputPaths) const;
@@ -104,12 +109,24 @@ protected:
   uint64_t m_unkId;
   probingpt::QueryEngine *m_engine;
 
+  void AddSourceWord(System &system, uint64_t probingId, const std::string &str);
+  void AddTargetWord(System &system, uint32_t probingId, const StringPiece &wordStr, bool isNT);
+
   void CreateAlignmentMap(System &system, const std::string path);
+  //! from pairs of source and target positions
+  static const AlignmentInfo *CreateAlignment(const unsigned char probingAligns[], size_t size);
+
+  //! false if the files the snapshot was made from have changed
+  bool SameModelFiles(SnapshotSection &section) const;
+  void Thaw(System &system, SnapshotSection &section);
 
   TargetPhrases *Lookup(const Manager &mgr, MemPool &pool,
                         InputPath &inputPath) const;
   TargetPhrases *CreateTargetPhrases(MemPool &pool, const System &system,
                                      const Phrase<Moses2::Word> &sourcePhrase, uint64_t key) const;
+  //! from the target phrases stored at offset in the target phrase file
+  TargetPhrases *CreateTargetPhrases(MemPool &pool, const System &system,
+                                     const Phrase<Moses2::Word> &sourcePhrase, const char *offset) const;
   TargetPhraseImpl *CreateTargetPhrase(MemPool &pool, const System &system,
                                        const char *&offset) const;
 
@@ -135,6 +152,18 @@ protected:
   CacheSCFG m_cacheSCFG;
 
   void CreateCache(System &system);
+  //! first m_maxCacheSize (key, source phrase) pairs of the cache file
+  void ReadCacheFile(std::vector<std::pair<uint64_t, std::string> > &cache) const;
+  void AddToCache(System &system, MemPool &tmpSourcePool, uint64_t key, const std::string &sourceStr);
+
+  // filled while decoding, for phrases not in the static cache
+  size_t m_runtimeCacheBytes; // 0 = off
+  TargetPhrasesCache *m_runtimeCache;
+
+  //! in pool, or in a new entry of the runtime cache if admit
+  TargetPhrases *CreateTargetPhrasesCached(const Manager &mgr, MemPool &pool,
+      const Phrase<Moses2::Word> &sourcePhrase, uint64_t key, bool admit,
+      const char *offset) const;
 
   void ReformatWord(System &system, std::string &wordStr, bool &isNT);
 
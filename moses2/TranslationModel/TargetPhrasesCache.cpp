@@ -0,0 +1,184 @@
+/*
+ * TargetPhrasesCache.cpp
+ */
+#include "TargetPhrasesCache.h"
+#include "../ManagerBase.h"
+#include "../System.h"
+
+using namespace std;
+
+namespace Moses2
+{
+const size_t TargetPhrasesCache::DOORKEEPER_BITS;
+
+TargetPhrasesCache::Entry::Entry(const System &system)
+  :tps(NULL)
+  ,m_pool(1024)
+  ,m_weightsHash(system.weights.Hash())
+{
+}
+
+////////////////////////////////////////////////////////////////////////////
+TargetPhrasesCache::TargetPhrasesCache(const System &system, size_t maxBytes, size_t numShards)
+  :m_system(system)
+  ,m_maxBytes(maxBytes)
+  ,m_maxBytesPerShard(maxBytes / numShards)
+  ,m_shards(numShards)
+{
+  for (size_t i = 0; i < numShards; ++i) {
+    m_shards[i] = new Shard();
+  }
+}
+
+TargetPhrasesCache::~TargetPhrasesCache()
+{
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    delete m_shards[i];
+  }
+}
+
+void TargetPhrasesCache::Erase(Shard &shard, Map::iterator iter)
+{
+  Slot &slot = shard.clock[iter->second];
+  shard.bytes -= slot.bytes;
+  slot.entry.reset();
+  shard.freeSlots.push_back(iter->second);
+  shard.map.erase(iter);
+}
+
+void TargetPhrasesCache::Evict(Shard &shard)
+{
+  // sweep until an entry that wasn't used since the last pass. There is at
+  // least one entry, so this ends within 2 rounds
+  while (true) {
+    Slot &slot = shard.clock[shard.hand];
+    shard.hand = (shard.hand + 1) % shard.clock.size();
+    if (!slot.entry) {
+      continue;
+    }
+    if (slot.referenced) {
+      slot.referenced = false;
+      continue;
+    }
+
+    Erase(shard, shard.map.find(slot.key));
+    ++shard.stats.evictions;
+    return;
+  }
+}
+
+const TargetPhrasesCache::Entry *TargetPhrasesCache::Find(const ManagerBase &mgr, uint64_t key, bool &admit)
+{
+  admit = false;
+  if (!IsEnabled()) {
+    return NULL;
+  }
+  size_t weightsHash = m_system.weights.Hash();
+
+  Shard &shard = GetShard(key);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  Map::iterator iter = shard.map.find(key);
+  if (iter != shard.map.end()) {
+    Slot &slot = shard.clock[iter->second];
+    if (slot.entry->m_weightsHash == weightsHash) {
+      slot.referenced = true;
+      ++shard.stats.hits;
+      mgr.Pin(slot.entry);
+      return slot.entry.get();
+    }
+
+    // scored with old weights
+    Erase(shard, iter);
+  }
+  ++shard.stats.misses;
+
+  // admit on the second miss. Start afresh once the doorkeeper fills up, so it
+  // only remembers recent misses
+  size_t bit = (key * 0x9E3779B97F4A7C15ULL >> 32) % DOORKEEPER_BITS;
+  if (shard.doorkeeper[bit]) {
+    admit = true;
+  } else {
+    shard.doorkeeper[bit] = true;
+    if (++shard.doorkeeperAdds > DOORKEEPER_BITS / 2) {
+      shard.doorkeeper.assign(DOORKEEPER_BITS, false);
+      shard.doorkeeperAdds = 0;
+    }
+  }
+  return NULL;
+}
+
+const TargetPhrasesCache::Entry *TargetPhrasesCache::Add(const ManagerBase &mgr, uint64_t key, const EntryPtr &entry)
+{
+  mgr.Pin(entry);
+  size_t bytes = entry->m_pool.Size() + sizeof(Entry);
+  if (bytes > m_maxBytesPerShard) {
+    return entry.get();
+  }
+
+  Shard &shard = GetShard(key);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  Map::iterator iter = shard.map.find(key);
+  if (iter != shard.map.end()) {
+    Slot &slot = shard.clock[iter->second];
+    if (slot.entry->m_weightsHash == entry->m_weightsHash) {
+      // another thread looked it up at the same time
+      mgr.Pin(slot.entry);
+      return slot.entry.get();
+    }
+    Erase(shard, iter);
+  }
+
+  size_t ind;
+  if (shard.freeSlots.empty()) {
+    ind = shard.clock.size();
+    shard.clock.push_back(Slot());
+  } else {
+    ind = shard.freeSlots.back();
+    shard.freeSlots.pop_back();
+  }
+
+  Slot &slot = shard.clock[ind];
+  slot.key = key;
+  slot.entry = entry;
+  slot.bytes = bytes;
+  slot.referenced = false;
+  shard.map[key] = ind;
+  shard.bytes += bytes;
+  ++shard.stats.insertions;
+
+  while (shard.bytes > m_maxBytesPerShard) {
+    Evict(shard);
+  }
+  return entry.get();
+}
+
+void TargetPhrasesCache::Clear()
+{
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    Shard &shard = *m_shards[i];
+    boost::mutex::scoped_lock lock(shard.mutex);
+    shard.map.clear();
+    shard.clock.clear();
+    shard.freeSlots.clear();
+    shard.hand = 0;
+    shard.bytes = 0;
+  }
+}
+
+TargetPhrasesCache::Stats TargetPhrasesCache::GetStats() const
+{
+  Stats ret;
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    const Shard &shard = *m_shards[i];
+    boost::mutex::scoped_lock lock(shard.mutex);
+    ret.hits += shard.stats.hits;
+    ret.misses += shard.stats.misses;
+    ret.insertions += shard.stats.insertions;
+    ret.evictions += shard.stats.evictions;
+    ret.entries += shard.map.size();
+    ret.bytes += shard.bytes;
+  }
+  return ret;
+}
+
+}
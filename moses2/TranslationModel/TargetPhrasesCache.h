@@ -0,0 +1,132 @@
+/*
+ * TargetPhrasesCache.h
+ *
+ * Decoded target phrases of recently looked up source phrases, shared by all
+ * decoding threads. Split into independently locked shards, each bounded by
+ * the bytes of its entries and evicted in CLOCK order. A phrase is only
+ * admitted the second time it misses, so phrases seen once don't push out the
+ * hot ones.
+ *
+ * Every entry owns the pool its target phrases were created in. Lookups pin
+ * the entry to the sentence's manager, so eviction never frees target phrases
+ * that a sentence in flight still uses.
+ */
+#pragma once
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+#include "../MemPool.h"
+
+namespace Moses2
+{
+class ManagerBase;
+class System;
+class TargetPhrases;
+
+class TargetPhrasesCache
+{
+public:
+  struct Stats {
+    size_t hits, misses, insertions, evictions, entries, bytes;
+
+    Stats()
+      :hits(0), misses(0), insertions(0), evictions(0), entries(0), bytes(0) {
+    }
+  };
+
+  class Entry
+  {
+  public:
+    Entry(const System &system);
+
+    //! the target phrases must be created in this pool
+    MemPool &GetPool() {
+      return m_pool;
+    }
+
+    //! NULL if the phrase table has no translations
+    TargetPhrases *tps;
+
+  protected:
+    friend class TargetPhrasesCache;
+    MemPool m_pool;
+    size_t m_weightsHash;
+  };
+  typedef boost::shared_ptr<Entry> EntryPtr;
+
+  //! maxBytes == 0 disables the cache
+  TargetPhrasesCache(const System &system, size_t maxBytes, size_t numShards = 16);
+  ~TargetPhrasesCache();
+
+  bool IsEnabled() const {
+    return m_maxBytes;
+  }
+
+  /** Return the entry for key, pinned until mgr is destroyed. If it isn't
+   *  cached, return NULL and tell whether the caller should create it
+   */
+  const Entry *Find(const ManagerBase &mgr, uint64_t key, bool &admit);
+
+  //! new entry, to be filled by the caller and then added
+  EntryPtr CreateEntry() const {
+    return EntryPtr(new Entry(m_system));
+  }
+
+  /** Add the entry filled by the caller and pin it to mgr. If another thread
+   *  added the same key in the meantime, its entry wins
+   */
+  const Entry *Add(const ManagerBase &mgr, uint64_t key, const EntryPtr &entry);
+
+  void Clear();
+
+  Stats GetStats() const;
+
+protected:
+  struct Slot {
+    uint64_t key;
+    EntryPtr entry; // empty if the slot is free
+    size_t bytes;
+    bool referenced;
+  };
+  typedef boost::unordered_map<uint64_t, size_t> Map; // key -> slot
+
+  struct Shard {
+    mutable boost::mutex mutex;
+    Map map;
+    std::vector<Slot> clock;
+    std::vector<size_t> freeSlots;
+    size_t hand;
+    size_t bytes;
+
+    // keys that missed once since the last reset, hashed into bits
+    std::vector<bool> doorkeeper;
+    size_t doorkeeperAdds;
+
+    Stats stats;
+
+    Shard() : hand(0), bytes(0), doorkeeper(DOORKEEPER_BITS), doorkeeperAdds(0) {
+    }
+  };
+
+  static const size_t DOORKEEPER_BITS = 1 << 14;
+
+  const System &m_system;
+  size_t m_maxBytes, m_maxBytesPerShard;
+  std::vector<Shard*> m_shards;
+
+  Shard &GetShard(uint64_t key) {
+    return *m_shards[(key >> 32 ^ key) % m_shards.size()];
+  }
+
+  void Erase(Shard &shard, Map::iterator iter);
+  void Evict(Shard &shard);
+
+private:
+  TargetPhrasesCache(const TargetPhrasesCache &);
+  TargetPhrasesCache &operator=(const TargetPhrasesCache &);
+};
+
+}
+
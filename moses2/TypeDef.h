@@ -22,6 +22,7 @@ const size_t DEFAULT_MAX_CHART_SPAN     = 20;
 const size_t DEFAULT_MAX_HYPOSTACK_SIZE = 200;
 const size_t DEFAULT_CUBE_PRUNING_POP_LIMIT = 1000;
 const size_t DEFAULT_CUBE_PRUNING_DIVERSITY = 0;
+const size_t DEFAULT_CUBE_PRUNING_THREADS_MIN_WORDS = 40;
 const size_t DEFAULT_MAX_TRANS_OPT_SIZE = 5000;
 
 const size_t DEFAULT_MAX_PART_TRANS_OPT_SIZE = 10000;
@@ -7,6 +7,7 @@
 #include <cassert>
 #include <string>
 #include <vector>
+#include <boost/functional/hash.hpp>
 #include "FF/FeatureFunction.h"
 #include "FF/FeatureFunctions.h"
 #include "Weights.h"
@@ -57,5 +58,10 @@ void Weights::SetWeights(const FeatureFunctions &ffs, const std::string &ffName,
   }
 }
 
+size_t Weights::Hash() const
+{
+  return boost::hash_range(m_weights.begin(), m_weights.end());
+}
+
 }
 
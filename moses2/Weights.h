@@ -30,6 +30,9 @@ public:
 
   void SetWeights(const FeatureFunctions &ffs, const std::string &ffName, const std::vector<float> &weights);
 
+  //! changes whenever any weight changes
+  size_t Hash() const;
+
 protected:
   std::vector<SCORE> m_weights;
 };
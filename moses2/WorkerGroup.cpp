@@ -0,0 +1,115 @@
+#include <boost/bind.hpp>
+#include "WorkerGroup.h"
+
+namespace Moses2
+{
+
+WorkerGroup::WorkerGroup(size_t numWorkers)
+  :m_numWorkers(numWorkers ? numWorkers : 1)
+  ,m_stopping(false)
+  ,m_round(0)
+  ,m_func(NULL)
+  ,m_numTasks(0)
+  ,m_nextTask(0)
+  ,m_busy(0)
+{
+  for (size_t worker = 1; worker < m_numWorkers; ++worker) {
+    m_threads.create_thread(boost::bind(&WorkerGroup::Execute, this, worker));
+  }
+}
+
+WorkerGroup::~WorkerGroup()
+{
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_stopping = true;
+  }
+  m_workToDo.notify_all();
+  m_threads.join_all();
+}
+
+void WorkerGroup::Run(size_t numTasks, const Func &func)
+{
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_func = &func;
+    m_numTasks = numTasks;
+    m_nextTask = 0;
+    m_error = std::exception_ptr();
+    ++m_round;
+  }
+  if (m_numWorkers > 1 && numTasks > 1) {
+    m_workToDo.notify_all();
+  }
+
+  Work(0);
+
+  // wait for helpers still in a task. Helpers that wake up later find no tasks left
+  std::exception_ptr error;
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_busy) {
+      m_workDone.wait(lock);
+    }
+    m_func = NULL;
+    error = m_error;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkerGroup::Execute(size_t worker)
+{
+  size_t round = 0;
+  while (true) {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      while (!m_stopping && round == m_round) {
+        m_workToDo.wait(lock);
+      }
+      if (m_stopping) {
+        return;
+      }
+      round = m_round;
+      ++m_busy;
+    }
+
+    Work(worker);
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (--m_busy == 0) {
+      m_workDone.notify_all();
+    }
+  }
+}
+
+void WorkerGroup::Work(size_t worker)
+{
+  while (true) {
+    size_t task;
+    const Func *func;
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      if (m_nextTask >= m_numTasks) {
+        return;
+      }
+      task = m_nextTask++;
+      func = m_func;
+    }
+
+    try {
+      (*func)(task, worker);
+    } catch (...) {
+      boost::mutex::scoped_lock lock(m_mutex);
+      if (!m_error) {
+        m_error = std::current_exception();
+      }
+      // skip the tasks nobody has started
+      m_nextTask = m_numTasks;
+    }
+  }
+}
+
+}
+
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <exception>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace Moses2
+{
+
+/** Threads that help the thread decoding a sentence with work it can split
+ *  up, eg. the mini-stacks of one stack in cube pruning. Run() shares the
+ *  tasks out between the helpers and the calling thread, and returns when all
+ *  of them are done.
+ *  Every thread takes the next task as soon as it is free, so a thread that
+ *  got small tasks takes over work that would otherwise wait for a busy one.
+ *  Tasks are all known when Run() is called, so a shared counter does what a
+ *  work-stealing queue per thread would.
+ */
+class WorkerGroup
+{
+public:
+  //! func(task, worker). Worker 0 is the calling thread, the helpers are 1 to GetNumWorkers()-1
+  typedef boost::function<void (size_t, size_t)> Func;
+
+  //! numWorkers includes the calling thread
+  explicit WorkerGroup(size_t numWorkers);
+  ~WorkerGroup();
+
+  size_t GetNumWorkers() const {
+    return m_numWorkers;
+  }
+
+  //! tasks are taken in order 0 to numTasks-1. Rethrows the first exception from a task
+  void Run(size_t numTasks, const Func &func);
+
+protected:
+  size_t m_numWorkers;
+  boost::thread_group m_threads;
+
+  boost::mutex m_mutex;
+  boost::condition_variable m_workToDo, m_workDone;
+  bool m_stopping;
+  size_t m_round; // number of Run() calls, so helpers can tell there's new work
+  const Func *m_func;
+  size_t m_numTasks, m_nextTask;
+  size_t m_busy; // helpers in Work()
+  std::exception_ptr m_error;
+
+  //! main loop of the helpers
+  void Execute(size_t worker);
+
+  //! run tasks until there are none left
+  void Work(size_t worker);
+};
+
+}
+
@@ -21,12 +21,14 @@
 
 #ifdef WITH_THREADS
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #endif
 
 #ifdef BOOST_HAS_PTHREADS
 #include <pthread.h>
 #endif
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <ostream>
@@ -44,12 +46,12 @@ class OutputCollector
 public:
   OutputCollector(std::ostream* outStream = &std::cout,
                   std::ostream* debugStream = &std::cerr) :
-    m_nextOutput(0), m_outStream(outStream), m_debugStream(debugStream), m_isHoldingOutputStream(
+    m_nextOutput(0), m_maxPending(0), m_outStream(outStream), m_debugStream(debugStream), m_isHoldingOutputStream(
       false), m_isHoldingDebugStream(false) {
   }
 
   OutputCollector(std::string xout, std::string xerr = "") :
-    m_nextOutput(0) {
+    m_nextOutput(0), m_maxPending(0) {
     // TO DO open magic streams instead of regular ofstreams! [UG]
 
     if (xout == "/dev/stderr") {
@@ -122,23 +124,56 @@ public:
           m_debugs.erase(debugIter);
         }
       }
+#ifdef WITH_THREADS
+      m_written.notify_all();
+#endif
     } else {
       //save for later
       m_outputs[sourceId] = output;
       m_debugs[sourceId] = debug;
+      m_maxPending = std::max(m_maxPending, m_outputs.size());
+    }
+  }
+
+  /**
+   * Block until the output for sourceId is less than 'window' sentences
+   * ahead of the next one to be written. Bounds the reorder buffer when
+   * a slow sentence holds back the rest. window == 0 means unlimited.
+   **/
+  void WaitForWindow(int sourceId, size_t window) {
+#ifdef WITH_THREADS
+    if (window == 0) {
+      return;
     }
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (sourceId - m_nextOutput >= (int) window) {
+      m_written.wait(lock);
+    }
+#endif
+  }
+
+  //! number of outputs written so far
+  int GetNumWritten() const {
+    return m_nextOutput;
+  }
+
+  //! largest number of outputs held back waiting for an earlier one
+  size_t GetMaxPending() const {
+    return m_maxPending;
   }
 
 private:
   std::map<int, std::string> m_outputs;
   std::map<int, std::string> m_debugs;
   int m_nextOutput;
+  size_t m_maxPending;
   std::ostream* m_outStream;
   std::ostream* m_debugStream;
   bool m_isHoldingOutputStream;
   bool m_isHoldingDebugStream;
 #ifdef WITH_THREADS
   boost::mutex m_mutex;
+  boost::condition_variable m_written;
 #endif
 
 public:
@@ -54,6 +54,8 @@ Parameter::Parameter()
 
   AddParam(main_opts, "verbose", "v", "verbosity level of the logging");
   AddParam(main_opts, "show-weights", "print feature weights and exit");
+  AddParam(main_opts, "freeze-snapshot", "after loading, save the start-up state of the feature functions to this file and exit");
+  AddParam(main_opts, "thaw-snapshot", "start up from a file made by -freeze-snapshot with the same parameters, instead of rebuilding its state from the model files");
   //AddParam(main_opts, "time-out",
   //    "seconds after which is interrupted (-1=no time-out, default is -1)");
 
@@ -124,6 +126,8 @@ Parameter::Parameter()
   //    "if present, allow dropping of source words"); //da = drop any (word); see -du for comparison
   AddParam(search_opts, "threads", "th",
            "number of threads to use in decoding (defaults to single-threaded)");
+  AddParam(search_opts, "max-in-flight",
+           "batch mode: maximum number of sentences read ahead of the last one written (default 16 * threads, 0 = unlimited)");
 
   // distortion options
   po::options_description disto_opts("Distortion options");
@@ -144,6 +148,10 @@ Parameter::Parameter()
            "How many hypotheses should be created for each coverage. (default = 0)");
   AddParam(cube_opts, "cube-pruning-lazy-scoring", "cbls",
            "Don't fully score a hypothesis until it is popped");
+  AddParam(cube_opts, "cube-pruning-threads", "cbt",
+           "Threads that search each sentence, expanding the mini-stacks of a stack in parallel. Each mini-stack gets an equal share of the pop limit (default = 1)");
+  AddParam(cube_opts, "cube-pruning-threads-min-words",
+           "Sentences shorter than this are searched in one thread (default = 40)");
   //AddParam(cube_opts, "cube-pruning-deterministic-search", "cbds",
   //    "Break ties deterministically during search");
 
@@ -239,6 +247,8 @@ Parameter::Parameter()
            "report phrase segmentation in the output");
   AddParam(output_opts, "report-segmentation-enriched", "tt",
            "report phrase segmentation in the output with additional information");
+  AddParam(output_opts, "report-lookup-stats",
+           "For each sentence and phrase table, report to stderr how many spans were looked up, skipped without a lookup, and matched. Default is false");
 
   // translation-all-details was introduced in the context of DIMwid: Decoder Inspection for Moses (using Widgets)
   // see here: https://ufal.mff.cuni.cz/pbml/100/art-kurtz-seemann-braune-maletti.pdf
@@ -290,6 +300,10 @@ Parameter::Parameter()
   AddParam(server_opts, "server", "Run moses as a translation server.");
   AddParam(server_opts, "server-port", "Port for moses server");
   AddParam(server_opts, "server-log", "Log destination for moses server");
+  AddParam(server_opts, "server-protocol",
+           "xmlrpc (default) or binary: length-prefixed segment batches over an epoll event loop");
+  AddParam(server_opts, "server-cache-size",
+           "Bytes of translations to cache across requests, for repeated segments. Default = 0 (no cache)");
   //AddParam(server_opts, "session-timeout",
   //    "Timeout for sessions, e.g. '2h30m' or 1d (=24h)");
   //AddParam(server_opts, "session-cache-size",
@@ -358,6 +372,10 @@ Parameter::Parameter()
   AddParam(misc_opts, "cpu-affinity-offset", "CPU Affinity. Default = -1 (no affinity)");
   AddParam(misc_opts, "cpu-affinity-increment",
            "Set to 1 (default) to put each thread on different cores. 0 to run all threads on one core");
+  AddParam(misc_opts, "mempool-max-retained",
+           "Bytes each thread's sentence memory pool keeps between sentences. Default = 0 (keep everything)");
+  AddParam(misc_opts, "mempool-huge-pages",
+           "Back large memory pool pages with 2MB huge pages, allocated on the decoding thread's NUMA node. Default = false");
 
   // Compact phrase table and reordering table.
   po::options_description cpt_opts(
@@ -128,6 +128,12 @@ void ThreadPool::Submit(boost::shared_ptr<Task> task)
   m_threadNeeded.notify_all();
 }
 
+bool ThreadPool::IsFull()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  return m_queueLimit > 0 && m_tasks.size() >= m_queueLimit;
+}
+
 void ThreadPool::Stop(bool processRemainingJobs)
 {
   {
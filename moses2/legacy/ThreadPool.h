@@ -89,6 +89,11 @@ public:
     m_queueLimit = limit;
   }
 
+  /**
+   * Would Submit() block now? Only reliable if one thread submits
+   **/
+  bool IsFull();
+
 private:
   /**
    * The main loop executed by each thread.
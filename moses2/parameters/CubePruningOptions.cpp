@@ -12,6 +12,8 @@ CubePruningOptions()
   , diversity(DEFAULT_CUBE_PRUNING_DIVERSITY)
   , lazy_scoring(false)
   , deterministic_search(false)
+  , threads(1)
+  , threads_min_words(DEFAULT_CUBE_PRUNING_THREADS_MIN_WORDS)
 {}
 
 bool
@@ -23,6 +25,9 @@ init(Parameter const& param)
   param.SetParameter(diversity, "cube-pruning-diversity",
                      DEFAULT_CUBE_PRUNING_DIVERSITY);
   param.SetParameter(lazy_scoring, "cube-pruning-lazy-scoring", false);
+  param.SetParameter(threads, "cube-pruning-threads", size_t(1));
+  param.SetParameter(threads_min_words, "cube-pruning-threads-min-words",
+                     DEFAULT_CUBE_PRUNING_THREADS_MIN_WORDS);
   //param.SetParameter(deterministic_search, "cube-pruning-deterministic-search", false);
   return true;
 }
@@ -12,6 +12,8 @@ struct
   size_t  diversity;
   bool lazy_scoring;
   bool deterministic_search;
+  size_t  threads; // per sentence. 1 = search in the decoding thread only
+  size_t  threads_min_words; // shorter sentences are searched in one thread
 
   bool init(Parameter const& param);
   CubePruningOptions(Parameter const& param);
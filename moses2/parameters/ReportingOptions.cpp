@@ -21,6 +21,7 @@ ReportingOptions()
   , ReportHypoScore(false)
   , PrintID(false)
   , PrintPassThrough(false)
+  , ReportLookupStats(false)
   , include_lhs_in_search_graph(false)
   , lattice_sample_size(0)
 {
@@ -76,6 +77,7 @@ init(Parameter const& param)
   param.SetParameter(ReportHypoScore, "output-hypo-score",false);
   param.SetParameter(PrintID, "print-id",false);
   param.SetParameter(PrintPassThrough, "print-passthrough",false);
+  param.SetParameter(ReportLookupStats, "report-lookup-stats", false);
   param.SetParameter(detailed_all_transrep_filepath,
                      "translation-all-details", e);
   param.SetParameter(detailed_transrep_filepath, "translation-details", e);
@@ -40,6 +40,8 @@ struct
   bool PrintID;
   bool PrintPassThrough;
 
+  bool ReportLookupStats; // spans probed/skipped/matched in each phrase table, per sentence
+
   // transrep = translation reporting
   std::string detailed_transrep_filepath;
   std::string detailed_tree_transrep_filepath;
@@ -46,6 +46,8 @@ ServerOptions()
   , keepaliveTimeout(15)
   , keepaliveMaxConn(30)
   , timeout(15)
+  , protocol("xmlrpc")
+  , cacheSize(0)
 { }
 
 ServerOptions::
@@ -63,6 +65,8 @@ init(Parameter const& P)
   P.SetParameter(this->is_serial, "serial", false);
   P.SetParameter(this->logfile, "server-log", std::string("/dev/null"));
   P.SetParameter(this->numThreads, "threads", uint32_t(15));
+  P.SetParameter(this->protocol, "server-protocol", std::string("xmlrpc"));
+  P.SetParameter(this->cacheSize, "server-cache-size", size_t(0));
 
   // defaults reflect recommended defaults (according to Hieu)
   // -> http://xmlrpc-c.sourceforge.net/doc/libxmlrpc_server_abyss.html#max_conn
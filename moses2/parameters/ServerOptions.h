@@ -27,6 +27,9 @@ struct
   int keepaliveMaxConn;  // this is for the abyss server
   int timeout;           // this is for the abyss server
 
+  std::string protocol;  // xmlrpc (abyss server) or binary (EventServer)
+  size_t cacheSize;      // bytes of translations kept across requests. 0 = no cache
+
   bool init(Parameter const& param);
   ServerOptions(Parameter const& param);
   ServerOptions();
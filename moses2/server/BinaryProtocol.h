@@ -0,0 +1,98 @@
+/*
+ * Framing for the event-driven moses2 server (server-protocol binary).
+ *
+ * A request is a batch of segments, a response is their translations in
+ * the same order. Both use the same frame:
+ *
+ *   uint32 N                       number of strings
+ *   N x (uint32 len, len bytes)    UTF-8 text, no terminator
+ *
+ * Integers are in network byte order. A client may send any number of
+ * requests without waiting; responses on a connection come back in the
+ * order the requests were sent.
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+#include <arpa/inet.h>
+
+namespace Moses2
+{
+namespace BinaryProtocol
+{
+
+// limits on what a peer can make us buffer
+const uint32_t MAX_SEGMENTS = 1 << 20;
+const uint32_t MAX_SEGMENT_LENGTH = 1 << 24;
+
+inline void AppendUInt32(std::string &buf, uint32_t val)
+{
+  val = htonl(val);
+  buf.append((const char*) &val, sizeof(val));
+}
+
+inline bool ReadUInt32(const std::string &buf, size_t &pos, uint32_t &val)
+{
+  if (pos + sizeof(val) > buf.size()) {
+    return false;
+  }
+  memcpy(&val, buf.data() + pos, sizeof(val));
+  val = ntohl(val);
+  pos += sizeof(val);
+  return true;
+}
+
+inline void AppendFrame(std::string &buf, const std::vector<std::string> &strs)
+{
+  AppendUInt32(buf, strs.size());
+  for (size_t i = 0; i < strs.size(); ++i) {
+    AppendUInt32(buf, strs[i].size());
+    buf.append(strs[i]);
+  }
+}
+
+enum ParseResult {
+  Incomplete,
+  Complete,
+  Invalid
+};
+
+/** Parse one frame starting at buf[pos]. On Complete, pos is moved past the
+ *  frame; otherwise it is unchanged.
+ */
+inline ParseResult ParseFrame(const std::string &buf, size_t &pos, std::vector<std::string> &strs)
+{
+  size_t curr = pos;
+  uint32_t num;
+  if (!ReadUInt32(buf, curr, num)) {
+    return Incomplete;
+  }
+  if (num > MAX_SEGMENTS) {
+    return Invalid;
+  }
+
+  strs.resize(num);
+  for (size_t i = 0; i < num; ++i) {
+    uint32_t len;
+    if (!ReadUInt32(buf, curr, len)) {
+      return Incomplete;
+    }
+    if (len > MAX_SEGMENT_LENGTH) {
+      return Invalid;
+    }
+    if (curr + len > buf.size()) {
+      return Incomplete;
+    }
+    strs[i].assign(buf.data() + curr, len);
+    curr += len;
+  }
+
+  pos = curr;
+  return Complete;
+}
+
+}
+}
+
@@ -0,0 +1,432 @@
+/*
+ * EventServer.cpp
+ */
+#ifdef __linux
+#include <iostream>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include "EventServer.h"
+#include "BinaryProtocol.h"
+#include "../ManagerBase.h"
+#include "../System.h"
+#include "../legacy/ThreadPool.h"
+#include "../parameters/ServerOptions.h"
+#include "util/exception.hh"
+
+using namespace std;
+
+namespace Moses2
+{
+
+namespace
+{
+// epoll ids of the non-connection fds. Connections are numbered from FIRST_CONN_ID
+const long LISTEN_ID = 0;
+const long WAKE_ID = 1;
+const long FIRST_CONN_ID = 2;
+
+const size_t READ_SIZE = 64 * 1024;
+
+void SetNonBlocking(int fd)
+{
+  int flags = fcntl(fd, F_GETFL, 0);
+  UTIL_THROW_IF(flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1,
+                util::ErrnoException, "Could not make fd " << fd << " non-blocking");
+}
+}
+
+BatchRequest::BatchRequest(EventServer &server, long connId, size_t numSegments)
+  :m_server(server)
+  ,m_connId(connId)
+  ,m_outputs(numSegments)
+  ,m_numLeft(numSegments)
+{
+}
+
+void BatchRequest::SetOutput(size_t ind, const std::string &out)
+{
+  bool done;
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_outputs[ind] = out;
+    --m_numLeft;
+    done = m_numLeft == 0;
+  }
+  if (done) {
+    m_server.Completed(m_connId);
+  }
+}
+
+bool BatchRequest::IsDone() const
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  return m_numLeft == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+SegmentTask::SegmentTask(EventServer &server, System &system, const std::string &line, long translationId,
+                         boost::shared_ptr<BatchRequest> request, size_t ind,
+                         TranslationCache &cache)
+  :TranslationTask(system, line, translationId)
+  ,m_server(server)
+  ,m_request(request)
+  ,m_ind(ind)
+  ,m_cache(cache)
+  ,m_source(line)
+{
+}
+
+void SegmentTask::Run()
+{
+  m_mgr->Decode();
+  string out = m_mgr->OutputBest();
+  delete m_mgr;
+
+  m_cache.Add(m_source, out);
+  m_request->SetOutput(m_ind, out);
+
+  // there is room in the pool again
+  m_server.Wake();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+EventServer::EventServer(ServerOptions &server_options, System &system, ThreadPool &pool)
+  :m_server_options(server_options)
+  ,m_system(system)
+  ,m_pool(pool)
+  ,m_cache(server_options.cacheSize)
+  ,m_paused(false)
+  ,m_listenFd(-1)
+  ,m_wakeFd(-1)
+  ,m_epollFd(-1)
+  ,m_nextConnId(FIRST_CONN_ID)
+  ,m_translationId(0)
+  ,m_numRequests(0)
+  ,m_numSegments(0)
+{
+}
+
+EventServer::~EventServer()
+{
+  while (!m_conns.empty()) {
+    Close(m_conns.begin()->first);
+  }
+  if (m_epollFd != -1) close(m_epollFd);
+  if (m_wakeFd != -1) close(m_wakeFd);
+  if (m_listenFd != -1) close(m_listenFd);
+}
+
+void EventServer::Listen()
+{
+  m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  UTIL_THROW_IF(m_listenFd == -1, util::ErrnoException, "Could not create socket");
+
+  int on = 1;
+  setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(m_server_options.port);
+  UTIL_THROW_IF(bind(m_listenFd, (sockaddr*) &addr, sizeof(addr)) == -1,
+                util::ErrnoException, "Could not bind to port " << m_server_options.port);
+  UTIL_THROW_IF(listen(m_listenFd, m_server_options.maxConnBacklog) == -1,
+                util::ErrnoException, "Could not listen on port " << m_server_options.port);
+  SetNonBlocking(m_listenFd);
+
+  m_wakeFd = eventfd(0, EFD_NONBLOCK);
+  UTIL_THROW_IF(m_wakeFd == -1, util::ErrnoException, "Could not create eventfd");
+
+  m_epollFd = epoll_create1(0);
+  UTIL_THROW_IF(m_epollFd == -1, util::ErrnoException, "Could not create epoll fd");
+
+  epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u64 = LISTEN_ID;
+  UTIL_THROW_IF(epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &ev) == -1,
+                util::ErrnoException, "epoll_ctl failed");
+  ev.data.u64 = WAKE_ID;
+  UTIL_THROW_IF(epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev) == -1,
+                util::ErrnoException, "epoll_ctl failed");
+}
+
+void EventServer::run()
+{
+  Listen();
+  cerr << "Listening on port " << m_server_options.port << " (binary protocol)" << endl;
+
+  const int MAX_EVENTS = 64;
+  epoll_event events[MAX_EVENTS];
+  while (true) {
+    int num = epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+    if (num == -1) {
+      UTIL_THROW_IF(errno != EINTR, util::ErrnoException, "epoll_wait failed");
+      continue;
+    }
+
+    for (int i = 0; i < num; ++i) {
+      long id = events[i].data.u64;
+      if (id == LISTEN_ID) {
+        Accept();
+      } else if (id == WAKE_ID) {
+        uint64_t count;
+        while (read(m_wakeFd, &count, sizeof(count)) > 0) {
+        }
+
+        vector<long> completed;
+        {
+          boost::mutex::scoped_lock lock(m_completedMutex);
+          completed.swap(m_completed);
+        }
+        for (size_t j = 0; j < completed.size(); ++j) {
+          std::map<long, Connection*>::iterator iter = m_conns.find(completed[j]);
+          if (iter != m_conns.end()) {
+            // client may have gone away in the meantime
+            Flush(iter->first, *iter->second);
+          }
+        }
+        SubmitBacklog();
+      } else {
+        std::map<long, Connection*>::iterator iter = m_conns.find(id);
+        if (iter == m_conns.end()) {
+          continue;
+        }
+        Connection &conn = *iter->second;
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+          // nothing can be sent back, but take what arrived before giving up
+          Read(id, conn);
+          Close(id);
+          continue;
+        }
+        if (events[i].events & EPOLLOUT) {
+          Flush(id, conn);
+          if (m_conns.find(id) == m_conns.end()) {
+            continue;
+          }
+        }
+        if (events[i].events & EPOLLIN) {
+          Read(id, conn);
+        }
+      }
+    }
+  }
+}
+
+void EventServer::Accept()
+{
+  while (true) {
+    int fd = accept(m_listenFd, NULL, NULL);
+    if (fd == -1) {
+      // EAGAIN: no more pending connections. Anything else: try again on the next event
+      return;
+    }
+    SetNonBlocking(fd);
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    long id = m_nextConnId++;
+    Connection *conn = new Connection();
+    conn->fd = fd;
+    conn->events = m_paused ? 0 : EPOLLIN;
+    conn->readClosed = false;
+    m_conns[id] = conn;
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = conn->events;
+    ev.data.u64 = id;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+      Close(id);
+    }
+  }
+}
+
+void EventServer::Read(long connId, Connection &conn)
+{
+  char buf[READ_SIZE];
+  while (true) {
+    ssize_t got = read(conn.fd, buf, READ_SIZE);
+    if (got > 0) {
+      conn.inBuf.append(buf, got);
+    } else if (got == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else if (got == -1 && errno == EINTR) {
+      continue;
+    } else if (got == 0) {
+      // half-close. Answer what has already arrived before closing
+      conn.readClosed = true;
+      break;
+    } else {
+      Close(connId);
+      return;
+    }
+  }
+
+  size_t pos = 0;
+  vector<string> segments;
+  while (true) {
+    BinaryProtocol::ParseResult result = BinaryProtocol::ParseFrame(conn.inBuf, pos, segments);
+    if (result == BinaryProtocol::Incomplete) {
+      break;
+    } else if (result == BinaryProtocol::Invalid) {
+      cerr << "Invalid request, closing connection " << connId << endl;
+      Close(connId);
+      return;
+    }
+
+    boost::shared_ptr<BatchRequest> request(new BatchRequest(*this, connId, segments.size()));
+    conn.pending.push_back(request);
+    ++m_numRequests;
+    m_numSegments += segments.size();
+
+    for (size_t i = 0; i < segments.size(); ++i) {
+      string out;
+      if (m_cache.Find(segments[i], out)) {
+        request->SetOutput(i, out);
+      } else {
+        Segment segment;
+        segment.source = segments[i];
+        segment.request = request;
+        segment.ind = i;
+        m_backlog.push_back(segment);
+      }
+    }
+  }
+  conn.inBuf.erase(0, pos);
+  SubmitBacklog();
+
+  // empty requests are answered straight away
+  Flush(connId, conn);
+}
+
+void EventServer::Flush(long connId, Connection &conn)
+{
+  while (!conn.pending.empty() && conn.pending.front()->IsDone()) {
+    BinaryProtocol::AppendFrame(conn.outBuf, conn.pending.front()->GetOutputs());
+    conn.pending.pop_front();
+  }
+
+  size_t written = 0;
+  while (written < conn.outBuf.size()) {
+    // no SIGPIPE if the client has gone away. It would kill the server
+    ssize_t ret = send(conn.fd, conn.outBuf.data() + written, conn.outBuf.size() - written, MSG_NOSIGNAL);
+    if (ret > 0) {
+      written += ret;
+    } else if (ret == -1 && errno == EINTR) {
+      continue;
+    } else if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else {
+      Close(connId);
+      return;
+    }
+  }
+  conn.outBuf.erase(0, written);
+
+  if (conn.readClosed && conn.pending.empty() && conn.outBuf.empty()) {
+    Close(connId);
+    return;
+  }
+  Watch(connId, conn, !conn.outBuf.empty());
+}
+
+void EventServer::Watch(long connId, Connection &conn, bool wantWrite)
+{
+  // once the client has shut down, EPOLLIN would fire on every wait
+  uint32_t events = (conn.readClosed || m_paused ? 0 : EPOLLIN) | (wantWrite ? EPOLLOUT : 0);
+  if (conn.events == events) {
+    return;
+  }
+  epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = events;
+  ev.data.u64 = connId;
+  epoll_ctl(m_epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+  conn.events = events;
+}
+
+void EventServer::SubmitBacklog()
+{
+  // the event loop is the only thread that submits, so Submit() won't block
+  while (!m_backlog.empty() && !m_pool.IsFull()) {
+    const Segment &segment = m_backlog.front();
+    boost::shared_ptr<Task> task(new SegmentTask(*this, m_system, segment.source, m_translationId++,
+                                 segment.request, segment.ind, m_cache));
+    m_pool.Submit(task);
+    m_backlog.pop_front();
+  }
+  Pause(!m_backlog.empty());
+}
+
+void EventServer::Pause(bool paused)
+{
+  if (m_paused == paused) {
+    return;
+  }
+  m_paused = paused;
+  for (std::map<long, Connection*>::iterator iter = m_conns.begin(); iter != m_conns.end(); ++iter) {
+    Watch(iter->first, *iter->second, !iter->second->outBuf.empty());
+  }
+}
+
+void EventServer::Close(long connId)
+{
+  std::map<long, Connection*>::iterator iter = m_conns.find(connId);
+  if (iter == m_conns.end()) {
+    return;
+  }
+  Connection *conn = iter->second;
+  epoll_ctl(m_epollFd, EPOLL_CTL_DEL, conn->fd, NULL);
+  close(conn->fd);
+
+  // no point decoding segments nobody will receive
+  for (std::deque<Segment>::iterator seg = m_backlog.begin(); seg != m_backlog.end(); ) {
+    if (seg->request->GetConnId() == connId) {
+      seg = m_backlog.erase(seg);
+    } else {
+      ++seg;
+    }
+  }
+
+  // unfinished requests are still referenced by their tasks. Their results are dropped
+  delete conn;
+  m_conns.erase(iter);
+  Pause(!m_backlog.empty());
+
+  cerr << "Closed connection " << connId << ". Served "
+       << m_numRequests << " requests, " << m_numSegments << " segments in total" << endl;
+  if (m_cache.IsEnabled()) {
+    TranslationCache::Stats stats = m_cache.GetStats();
+    cerr << "Cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+         << stats.evictions << " evictions, " << stats.entries << " entries, "
+         << stats.bytes << " bytes" << endl;
+  }
+}
+
+void EventServer::Completed(long connId)
+{
+  {
+    boost::mutex::scoped_lock lock(m_completedMutex);
+    m_completed.push_back(connId);
+  }
+  Wake();
+}
+
+void EventServer::Wake()
+{
+  uint64_t one = 1;
+  ssize_t ret = write(m_wakeFd, &one, sizeof(one));
+  (void) ret;
+}
+
+}
+
+#endif
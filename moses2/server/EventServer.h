@@ -0,0 +1,135 @@
+/*
+ * EventServer.h
+ *
+ * Single-threaded epoll front-end for the moses2 server. Speaks the
+ * length-prefixed protocol in BinaryProtocol.h instead of XML-RPC and hands
+ * every segment to the decoder's ThreadPool. Linux only.
+ */
+#pragma once
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "../TranslationTask.h"
+#include "TranslationCache.h"
+
+namespace Moses2
+{
+class System;
+class ServerOptions;
+class ThreadPool;
+class EventServer;
+
+/** All segments of one request frame. Answered when the last one is done */
+class BatchRequest
+{
+public:
+  BatchRequest(EventServer &server, long connId, size_t numSegments);
+
+  //! called by decoding threads
+  void SetOutput(size_t ind, const std::string &out);
+
+  bool IsDone() const;
+
+  long GetConnId() const {
+    return m_connId;
+  }
+
+  const std::vector<std::string> &GetOutputs() const {
+    return m_outputs;
+  }
+
+protected:
+  EventServer &m_server;
+  long m_connId;
+  std::vector<std::string> m_outputs;
+  size_t m_numLeft;
+  mutable boost::mutex m_mutex;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+class SegmentTask: public TranslationTask
+{
+public:
+  SegmentTask(EventServer &server, System &system, const std::string &line, long translationId,
+              boost::shared_ptr<BatchRequest> request, size_t ind,
+              TranslationCache &cache);
+  virtual void Run();
+
+protected:
+  EventServer &m_server;
+  boost::shared_ptr<BatchRequest> m_request;
+  size_t m_ind;
+  TranslationCache &m_cache;
+  std::string m_source;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+class EventServer
+{
+public:
+  EventServer(ServerOptions &server_options, System &system, ThreadPool &pool);
+  virtual ~EventServer();
+
+  void run();
+
+  //! thread safe. Wakes the event loop to send finished requests on connection connId
+  void Completed(long connId);
+
+  //! thread safe. Wakes the event loop to hand more segments to the pool
+  void Wake();
+
+protected:
+  struct Connection {
+    int fd;
+    std::string inBuf, outBuf;
+    uint32_t events; // currently registered with epoll
+
+    // client has shut down its side. Closed once the answers are all sent
+    bool readClosed;
+
+    // requests in the order they arrived. Only the front can be answered
+    std::deque<boost::shared_ptr<BatchRequest> > pending;
+  };
+
+  ServerOptions &m_server_options;
+  System &m_system;
+  ThreadPool &m_pool;
+  TranslationCache m_cache;
+
+  //! segments read but not yet handed to the pool, which only queues a few per thread
+  struct Segment {
+    std::string source;
+    boost::shared_ptr<BatchRequest> request;
+    size_t ind;
+  };
+  std::deque<Segment> m_backlog;
+
+  // no connection is read from while there is a backlog
+  bool m_paused;
+
+  int m_listenFd, m_wakeFd, m_epollFd;
+  std::map<long, Connection*> m_conns;
+  long m_nextConnId;
+  long m_translationId;
+
+  boost::mutex m_completedMutex;
+  std::vector<long> m_completed;
+
+  // counters, reported when a connection closes
+  size_t m_numRequests, m_numSegments;
+
+  void Listen();
+  void Accept();
+  void Read(long connId, Connection &conn);
+  void Flush(long connId, Connection &conn);
+  void Close(long connId);
+  void Watch(long connId, Connection &conn, bool wantWrite);
+  void SubmitBacklog();
+  void Pause(bool paused);
+};
+
+}
+
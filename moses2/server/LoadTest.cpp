@@ -0,0 +1,175 @@
+/*
+ * LoadTest.cpp
+ *
+ * Load-test client for moses2 --server --server-protocol binary.
+ * Sends an input file as batches over several pipelined connections,
+ * writes the translations to stdout in input order and reports
+ * throughput and request latency on stderr.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include "BinaryProtocol.h"
+#include "util/exception.hh"
+#include "util/usage.hh"
+
+using namespace std;
+using namespace Moses2;
+
+namespace
+{
+
+struct Batch {
+  vector<string> segments, translations;
+  double sent, latency;
+};
+
+int Connect(const string &host, const string &port)
+{
+  addrinfo hints, *res;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  int err = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+  UTIL_THROW_IF2(err, "Could not resolve " << host << ":" << port << ": " << gai_strerror(err));
+
+  int fd = -1;
+  for (addrinfo *curr = res; curr; curr = curr->ai_next) {
+    fd = socket(curr->ai_family, curr->ai_socktype, curr->ai_protocol);
+    if (fd == -1) continue;
+    if (connect(fd, curr->ai_addr, curr->ai_addrlen) == 0) break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+  UTIL_THROW_IF(fd == -1, util::ErrnoException, "Could not connect to " << host << ":" << port);
+  return fd;
+}
+
+void WriteAll(int fd, const string &buf)
+{
+  size_t done = 0;
+  while (done < buf.size()) {
+    ssize_t ret = write(fd, buf.data() + done, buf.size() - done);
+    if (ret == -1 && errno == EINTR) continue;
+    UTIL_THROW_IF(ret <= 0, util::ErrnoException, "write failed");
+    done += ret;
+  }
+}
+
+void ReadFrame(int fd, string &buf, vector<string> &strs)
+{
+  char data[65536];
+  while (true) {
+    size_t pos = 0;
+    BinaryProtocol::ParseResult result = BinaryProtocol::ParseFrame(buf, pos, strs);
+    UTIL_THROW_IF2(result == BinaryProtocol::Invalid, "Invalid response from server");
+    if (result == BinaryProtocol::Complete) {
+      buf.erase(0, pos);
+      return;
+    }
+
+    ssize_t got = read(fd, data, sizeof(data));
+    if (got == -1 && errno == EINTR) continue;
+    UTIL_THROW_IF(got <= 0, util::ErrnoException, "Server closed connection");
+    buf.append(data, got);
+  }
+}
+
+// one connection. Keeps up to 'depth' requests outstanding
+void RunConnection(const string &host, const string &port,
+                   vector<Batch> &batches, size_t first, size_t step, size_t depth)
+{
+  int fd = Connect(host, port);
+  string inBuf;
+  size_t toSend = first, toReceive = first;
+  while (toReceive < batches.size()) {
+    while (toSend < batches.size() && (toSend - toReceive) / step < depth) {
+      string frame;
+      BinaryProtocol::AppendFrame(frame, batches[toSend].segments);
+      batches[toSend].sent = util::WallTime();
+      WriteAll(fd, frame);
+      toSend += step;
+    }
+
+    Batch &batch = batches[toReceive];
+    ReadFrame(fd, inBuf, batch.translations);
+    batch.latency = util::WallTime() - batch.sent;
+    UTIL_THROW_IF2(batch.translations.size() != batch.segments.size(),
+                   "Expected " << batch.segments.size() << " translations, got " << batch.translations.size());
+    toReceive += step;
+  }
+  close(fd);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 4) {
+    cerr << "Usage: " << argv[0] << " host port input-file [connections=4] [batch-size=8] [pipeline-depth=4]" << endl;
+    return EXIT_FAILURE;
+  }
+  string host = argv[1], port = argv[2];
+  size_t numConns = argc > 4 ? atoi(argv[4]) : 4;
+  size_t batchSize = argc > 5 ? atoi(argv[5]) : 8;
+  size_t depth = argc > 6 ? atoi(argv[6]) : 4;
+  UTIL_THROW_IF2(numConns == 0 || batchSize == 0 || depth == 0, "Arguments must be positive");
+
+  vector<Batch> batches;
+  ifstream in(argv[3]);
+  UTIL_THROW_IF2(!in, "Could not open " << argv[3]);
+  string line;
+  size_t numSegments = 0;
+  while (getline(in, line)) {
+    if (numSegments % batchSize == 0) {
+      batches.push_back(Batch());
+    }
+    batches.back().segments.push_back(line);
+    ++numSegments;
+  }
+
+  double start = util::WallTime();
+  boost::thread_group threads;
+  for (size_t i = 0; i < numConns && i < batches.size(); ++i) {
+    threads.create_thread(boost::bind(&RunConnection, host, port, boost::ref(batches), i, numConns, depth));
+  }
+  threads.join_all();
+  double elapsed = util::WallTime() - start;
+
+  vector<double> latencies;
+  for (size_t i = 0; i < batches.size(); ++i) {
+    const Batch &batch = batches[i];
+    for (size_t j = 0; j < batch.translations.size(); ++j) {
+      cout << batch.translations[j] << "\n";
+    }
+    latencies.push_back(batch.latency);
+  }
+  cout << flush;
+
+  cerr << numSegments << " segments in " << batches.size() << " requests over "
+       << numConns << " connections, " << elapsed << "s, "
+       << numSegments / elapsed << " segments/s" << endl;
+  if (!latencies.empty()) {
+    sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (size_t i = 0; i < latencies.size(); ++i) {
+      total += latencies[i];
+    }
+    cerr << "Request latency: mean " << total / latencies.size()
+         << "s, p50 " << latencies[latencies.size() / 2]
+         << "s, p99 " << latencies[latencies.size() * 99 / 100]
+         << "s, max " << latencies.back() << "s" << endl;
+  }
+  return EXIT_SUCCESS;
+}
+
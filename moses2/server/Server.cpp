@@ -15,11 +15,43 @@ using namespace std;
 namespace Moses2
 {
 
+namespace
+{
+// cache_stats: hit/miss/eviction counters of the translation cache
+class CacheStats : public xmlrpc_c::method
+{
+public:
+  CacheStats(TranslationCache &cache)
+    :m_cache(cache) {
+    this->_signature = "S:";
+    this->_help = "Returns translation cache statistics";
+  }
+
+  void execute(xmlrpc_c::paramList const& paramList,
+               xmlrpc_c::value *const retvalP) {
+    TranslationCache::Stats stats = m_cache.GetStats();
+    std::map<std::string, xmlrpc_c::value> ret;
+    ret["hits"] = xmlrpc_c::value_int(stats.hits);
+    ret["misses"] = xmlrpc_c::value_int(stats.misses);
+    ret["insertions"] = xmlrpc_c::value_int(stats.insertions);
+    ret["evictions"] = xmlrpc_c::value_int(stats.evictions);
+    ret["entries"] = xmlrpc_c::value_int(stats.entries);
+    ret["bytes"] = xmlrpc_c::value_int(stats.bytes);
+    *retvalP = xmlrpc_c::value_struct(ret);
+  }
+
+protected:
+  TranslationCache &m_cache;
+};
+}
+
 Server::Server(ServerOptions &server_options, System &system)
   :m_server_options(server_options)
+  ,m_cache(server_options.cacheSize)
   ,m_translator(new Translator(*this, system))
 {
   m_registry.addMethod("translate", m_translator);
+  m_registry.addMethod("cache_stats", xmlrpc_c::methodPtr(new CacheStats(m_cache)));
 }
 
 Server::~Server()
@@ -9,6 +9,7 @@
 #include <xmlrpc-c/base.hpp>
 #include <xmlrpc-c/registry.hpp>
 #include <xmlrpc-c/server_abyss.hpp>
+#include "TranslationCache.h"
 
 namespace Moses2
 {
@@ -27,8 +28,13 @@ public:
   ServerOptions const&
   options() const;
 
+  TranslationCache &GetCache() {
+    return m_cache;
+  }
+
 protected:
   ServerOptions &m_server_options;
+  TranslationCache m_cache;
   std::string m_pidfile;
   xmlrpc_c::registry m_registry;
   xmlrpc_c::methodPtr const m_translator;
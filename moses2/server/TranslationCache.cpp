@@ -0,0 +1,131 @@
+/*
+ * TranslationCache.cpp
+ */
+#include <boost/functional/hash.hpp>
+#include "TranslationCache.h"
+
+using namespace std;
+
+namespace Moses2
+{
+
+TranslationCache::TranslationCache(size_t maxBytes, size_t numShards)
+  :m_maxBytes(maxBytes)
+  ,m_maxBytesPerShard(maxBytes / numShards)
+  ,m_shards(numShards)
+{
+  for (size_t i = 0; i < numShards; ++i) {
+    m_shards[i] = new Shard();
+  }
+}
+
+TranslationCache::~TranslationCache()
+{
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    delete m_shards[i];
+  }
+}
+
+std::string TranslationCache::Normalize(const std::string &source)
+{
+  string ret;
+  ret.reserve(source.size());
+  bool space = false;
+  for (size_t i = 0; i < source.size(); ++i) {
+    char c = source[i];
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      space = !ret.empty();
+    } else {
+      if (space) {
+        ret += ' ';
+        space = false;
+      }
+      ret += c;
+    }
+  }
+  return ret;
+}
+
+TranslationCache::Shard &TranslationCache::GetShard(const std::string &key)
+{
+  size_t hash = boost::hash<std::string>()(key);
+  return *m_shards[hash % m_shards.size()];
+}
+
+void TranslationCache::Erase(Shard &shard, Map::iterator iter)
+{
+  shard.bytes -= Size(*iter->second);
+  shard.lru.erase(iter->second);
+  shard.map.erase(iter);
+}
+
+bool TranslationCache::Find(const std::string &source, std::string &translation)
+{
+  if (!IsEnabled()) {
+    return false;
+  }
+  string key = Normalize(source);
+
+  Shard &shard = GetShard(key);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  Map::iterator iter = shard.map.find(key);
+  if (iter == shard.map.end()) {
+    ++shard.stats.misses;
+    return false;
+  }
+
+  List::iterator entry = iter->second;
+  shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+  translation = entry->translation;
+  ++shard.stats.hits;
+  return true;
+}
+
+void TranslationCache::Add(const std::string &source, const std::string &translation)
+{
+  if (!IsEnabled()) {
+    return;
+  }
+  Entry entry;
+  entry.source = Normalize(source);
+  entry.translation = translation;
+  if (Size(entry) > m_maxBytesPerShard) {
+    return;
+  }
+
+  Shard &shard = GetShard(entry.source);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  Map::iterator iter = shard.map.find(entry.source);
+  if (iter != shard.map.end()) {
+    // another request translated it at the same time
+    Erase(shard, iter);
+  }
+
+  shard.bytes += Size(entry);
+  shard.lru.push_front(entry);
+  shard.map[entry.source] = shard.lru.begin();
+  ++shard.stats.insertions;
+
+  while (shard.bytes > m_maxBytesPerShard) {
+    Erase(shard, shard.map.find(shard.lru.back().source));
+    ++shard.stats.evictions;
+  }
+}
+
+TranslationCache::Stats TranslationCache::GetStats() const
+{
+  Stats ret;
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    const Shard &shard = *m_shards[i];
+    boost::mutex::scoped_lock lock(shard.mutex);
+    ret.hits += shard.stats.hits;
+    ret.misses += shard.stats.misses;
+    ret.insertions += shard.stats.insertions;
+    ret.evictions += shard.stats.evictions;
+    ret.entries += shard.map.size();
+    ret.bytes += shard.bytes;
+  }
+  return ret;
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * TranslationCache.h
+ *
+ * Translations of previously seen segments, shared by all server requests.
+ * Split into independently locked shards, each an LRU list bounded by the
+ * bytes of text it holds. Weights are fixed once the System is loaded, so
+ * entries stay valid for as long as the server runs.
+ */
+#pragma once
+#include <list>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace Moses2
+{
+
+class TranslationCache
+{
+public:
+  struct Stats {
+    size_t hits, misses, insertions, evictions, entries, bytes;
+
+    Stats()
+      :hits(0), misses(0), insertions(0), evictions(0), entries(0), bytes(0) {
+    }
+  };
+
+  //! maxBytes == 0 disables the cache
+  TranslationCache(size_t maxBytes, size_t numShards = 16);
+  ~TranslationCache();
+
+  bool IsEnabled() const {
+    return m_maxBytes;
+  }
+
+  //! keyed on the normalized source
+  bool Find(const std::string &source, std::string &translation);
+  void Add(const std::string &source, const std::string &translation);
+
+  Stats GetStats() const;
+
+  //! collapse runs of whitespace, as the decoder does when it tokenizes input
+  static std::string Normalize(const std::string &source);
+
+protected:
+  struct Entry {
+    std::string source, translation;
+  };
+  typedef std::list<Entry> List;
+  typedef boost::unordered_map<std::string, List::iterator> Map;
+
+  struct Shard {
+    mutable boost::mutex mutex;
+    List lru; // most recently used first
+    Map map;
+    size_t bytes;
+    Stats stats;
+
+    Shard() : bytes(0) {
+    }
+  };
+
+  size_t m_maxBytes, m_maxBytesPerShard;
+  std::vector<Shard*> m_shards;
+
+  Shard &GetShard(const std::string &key);
+  void Erase(Shard &shard, Map::iterator iter);
+
+  static size_t Size(const Entry &entry) {
+    return entry.source.size() + entry.translation.size() + sizeof(Entry);
+  }
+
+private:
+  TranslationCache(const TranslationCache &);
+  TranslationCache &operator=(const TranslationCache &);
+};
+
+}
+
@@ -45,6 +45,17 @@ void Translator::execute(xmlrpc_c::paramList const& paramList,
   }
 
   string line = xmlrpc_c::value_string(si->second);
+
+  // repeated segment
+  TranslationCache &cache = m_server.GetCache();
+  string out;
+  if (cache.Find(line, out)) {
+    std::map<std::string, xmlrpc_c::value> retData;
+    retData["text"] = xmlrpc_c::value_string(out);
+    *retvalP = xmlrpc_c::value_struct(retData);
+    return;
+  }
+
   long translationId;
 
   // get unique id. Thread safe
@@ -62,7 +73,9 @@ void Translator::execute(xmlrpc_c::paramList const& paramList,
   while (!task->IsDone()) {
     cond.wait(lock);
   }
-  *retvalP = xmlrpc_c::value_struct(task->GetRetData());
+  std::map<std::string, xmlrpc_c::value> const &retData = task->GetRetData();
+  cache.Add(line, xmlrpc_c::value_string(retData.find("text")->second));
+  *retvalP = xmlrpc_c::value_struct(retData);
 }
 
 } /* namespace Moses2 */
@@ -21,19 +21,57 @@
 
 #include "InputFileStream.h"
 #include "gzfilebuf.h"
+#include "util/file.hh"
+#include "util/read_compressed.hh"
+#include "util/write_compressed.hh"
 #include <iostream>
 
 using namespace std;
 
 namespace Moses
 {
+
+namespace
+{
+/** Reads anything util::ReadCompressed can, for the formats zlib's gzread
+ * can't.
+ */
+class ReadCompressedBuf : public std::streambuf
+{
+public:
+  explicit ReadCompressedBuf(const char *filename)
+    : m_in(util::OpenReadOrThrow(filename)) {
+    setg(m_buff, m_buff, m_buff);
+  }
+
+protected:
+  virtual int_type underflow() {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    std::size_t got = m_in.Read(m_buff, sizeof(m_buff));
+    if (!got) {
+      return traits_type::eof();
+    }
+    setg(m_buff, m_buff, m_buff + got);
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  util::ReadCompressed m_in;
+  char m_buff[65536];
+};
+}
+
 InputFileStream::InputFileStream(const std::string &filePath)
   : std::istream(NULL)
   , m_streambuf(NULL)
 {
-  if (filePath.size() > 3 &&
-      filePath.substr(filePath.size() - 3, 3) == ".gz") {
+  util::WriteCompressed::Compression compression = util::WriteCompressed::FromExtension(filePath);
+  if (compression == util::WriteCompressed::GZIP) {
     m_streambuf = new gzfilebuf(filePath.c_str());
+  } else if (compression != util::WriteCompressed::NONE) {
+    m_streambuf = new ReadCompressedBuf(filePath.c_str());
   } else {
     std::filebuf* fb = new std::filebuf();
     fb = fb->open(filePath.c_str(), std::ios::in);
@@ -29,7 +29,8 @@
 namespace Moses
 {
 
-/** Used in place of std::istream, can read zipped files if it ends in .gz
+/** Used in place of std::istream, can read zipped files if it ends in .gz,
+ * .zst or .lz4
  */
 class InputFileStream : public std::istream
 {
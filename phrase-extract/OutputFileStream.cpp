@@ -30,6 +30,30 @@ using namespace boost::algorithm;
 
 namespace Moses
 {
+
+namespace
+{
+//! boost::iostreams sink for util::WriteCompressed, which is shared because sinks are copied.
+class WriteCompressedSink
+{
+public:
+  typedef char char_type;
+  typedef boost::iostreams::sink_tag category;
+
+  explicit WriteCompressedSink(const boost::shared_ptr<util::WriteCompressed> &to)
+    :m_to(to) {
+  }
+
+  std::streamsize write(const char *s, std::streamsize n) {
+    m_to->Write(s, n);
+    return n;
+  }
+
+private:
+  boost::shared_ptr<util::WriteCompressed> m_to;
+};
+}
+
 OutputFileStream::OutputFileStream()
   :boost::iostreams::filtering_ostream()
   ,m_outFile(NULL)
@@ -55,6 +79,10 @@ bool OutputFileStream::Open(const std::string &filePath)
   if (filePath == std::string("-")) {
     // Write to standard output.  Leave m_outFile null.
     this->push(std::cout);
+  } else if (ends_with(filePath, ".zst") || ends_with(filePath, ".lz4")) {
+    m_compressedFile.reset(util::CreateOrThrow(filePath.c_str()));
+    m_compressed.reset(new util::WriteCompressed(m_compressedFile.get(), util::WriteCompressed::FromExtension(filePath)));
+    this->push(WriteCompressedSink(m_compressed));
   } else {
     m_outFile = new ofstream(filePath.c_str(), ios_base::out | ios_base::binary);
     if (m_outFile->fail()) {
@@ -81,6 +109,12 @@ void OutputFileStream::Close()
     m_outFile->close();
     delete m_outFile;
     m_outFile = NULL;
+  } else if (m_compressed) {
+    this->pop(); // sink
+
+    m_compressed->Finish();
+    m_compressed.reset();
+    m_compressedFile.reset();
   }
   m_open = false;
 }
@@ -26,6 +26,9 @@
 #include <string>
 #include <iostream>
 #include <boost/iostreams/filtering_stream.hpp>
+#include <boost/shared_ptr.hpp>
+#include "util/file.hh"
+#include "util/write_compressed.hh"
 
 namespace Moses
 {
@@ -33,8 +36,8 @@ namespace Moses
 /** Version of std::ostream with transparent compression.
  *
  * Transparently compresses output when writing to a file whose name ends in
- * ".gz".  Or, writes to stdout instead of a file when given a filename
- * consisting of just a dash ("-").
+ * ".gz", ".zst" or ".lz4".  Or, writes to stdout instead of a file when given
+ * a filename consisting of just a dash ("-").
  */
 class OutputFileStream : public boost::iostreams::filtering_ostream
 {
@@ -45,6 +48,10 @@ private:
    */
   std::ofstream *m_outFile;
 
+  /// Files ending in .zst or .lz4 are written through this instead of m_outFile.
+  util::scoped_fd m_compressedFile;
+  boost::shared_ptr<util::WriteCompressed> m_compressed;
+
   /// Is this stream open?
   bool m_open;
 
@@ -64,7 +71,8 @@ public:
    *
    * If filePath is "-" (just a dash), this opens the stream for writing to
    * standard output.  Otherwise, it opens the given file.  If the filename
-   * has the ".gz" suffix, output will be transparently compressed.
+   * has the ".gz", ".zst" or ".lz4" suffix, output will be transparently
+   * compressed.
    *
    * Call Close() to close the file.
    *
@@ -0,0 +1,2 @@
+#!/bin/sh
+./bjam -j8 --without-tcmalloc util lm lm/builder probingpt
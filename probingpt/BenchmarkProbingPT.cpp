@@ -0,0 +1,163 @@
+// Times QueryEngine::query() on every span of every input sentence, one key
+// at a time, against query_batch() with all spans of a sentence at once.
+// For lazy loading, run each --method in a fresh process with a cold page
+// cache, otherwise the first run warms the table for the second.
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <boost/unordered_map.hpp>
+#include "util/usage.hh"
+#include "querying.h"
+
+using namespace std;
+
+namespace
+{
+typedef vector<uint64_t> Keys;
+
+struct Result {
+  size_t found;
+  uint64_t offsets; // checksum, so both methods can be compared
+};
+
+Result Single(const probingpt::QueryEngine &engine, const vector<Keys> &sentences)
+{
+  Result ret = {0, 0};
+  for (size_t i = 0; i < sentences.size(); ++i) {
+    const Keys &keys = sentences[i];
+    for (size_t j = 0; j < keys.size(); ++j) {
+      std::pair<bool, uint64_t> result = engine.query(keys[j]);
+      if (result.first) {
+        ++ret.found;
+        ret.offsets += result.second;
+      }
+    }
+  }
+  return ret;
+}
+
+Result Batch(const probingpt::QueryEngine &engine, const vector<Keys> &sentences)
+{
+  Result ret = {0, 0};
+  vector<std::pair<bool, uint64_t> > results;
+  for (size_t i = 0; i < sentences.size(); ++i) {
+    const Keys &keys = sentences[i];
+    if (keys.empty()) {
+      continue;
+    }
+    results.resize(keys.size());
+    engine.query_batch(&keys[0], keys.size(), &results[0]);
+    for (size_t j = 0; j < results.size(); ++j) {
+      if (results[j].first) {
+        ++ret.found;
+        ret.offsets += results[j].second;
+      }
+    }
+  }
+  return ret;
+}
+
+void Report(const string &name, const Result &result, size_t numKeys, double time)
+{
+  cout << name << ": " << numKeys << " keys, " << result.found << " found, "
+       << time << "s, " << numKeys / time << " keys/s, checksum " << result.offsets << endl;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  string ptPath, inPath, load, method;
+  size_t maxLength;
+
+  namespace po = boost::program_options;
+  po::options_description desc("Options");
+  desc.add_options()
+  ("help", "Print help messages")
+  ("pt", po::value<string>(&ptPath)->required(), "Binary pt directory, from CreateProbingPT")
+  ("input", po::value<string>(&inPath)->required(), "Tokenized source sentences")
+  ("load", po::value<string>(&load)->default_value("populate"), "populate, lazy, read, huge_read or background")
+  ("method", po::value<string>(&method)->default_value("both"), "single, batch or both")
+  ("max-phrase-length", po::value<size_t>(&maxLength)->default_value(5), "Longest span looked up")
+  ;
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  } catch(po::error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+    std::cerr << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  util::LoadMethod loadMethod;
+  if (load == "populate") {
+    loadMethod = util::POPULATE_OR_READ;
+  } else if (load == "lazy") {
+    loadMethod = util::LAZY;
+  } else if (load == "read") {
+    loadMethod = util::READ;
+  } else if (load == "huge_read") {
+    loadMethod = util::HUGE_READ;
+  } else if (load == "background") {
+    loadMethod = util::BACKGROUND_POPULATE;
+  } else {
+    std::cerr << "Unknown load method " << load << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  double start = util::WallTime();
+  probingpt::QueryEngine engine(ptPath.c_str(), loadMethod);
+  cout << "Loaded in " << util::WallTime() - start << "s" << endl;
+
+  boost::unordered_map<string, uint64_t> vocab;
+  const std::map<uint64_t, std::string> &sourceVocab = engine.getSourceVocab();
+  for (std::map<uint64_t, std::string>::const_iterator iter = sourceVocab.begin();
+       iter != sourceVocab.end(); ++iter) {
+    vocab[iter->second] = iter->first;
+  }
+
+  // keys of all spans of each sentence, as the decoder would look them up
+  vector<Keys> sentences;
+  size_t numKeys = 0;
+  std::ifstream in(inPath.c_str());
+  string line;
+  while (getline(in, line)) {
+    vector<string> toks = Moses2::Tokenize(line);
+    vector<uint64_t> ids(toks.size());
+    vector<bool> known(toks.size());
+    for (size_t i = 0; i < toks.size(); ++i) {
+      boost::unordered_map<string, uint64_t>::const_iterator iter = vocab.find(toks[i]);
+      known[i] = iter != vocab.end();
+      ids[i] = known[i] ? iter->second : 0;
+    }
+
+    sentences.push_back(Keys());
+    Keys &keys = sentences.back();
+    for (size_t begin = 0; begin < toks.size(); ++begin) {
+      for (size_t end = begin; end < toks.size() && end - begin < maxLength && known[end]; ++end) {
+        keys.push_back(engine.getKey(&ids[begin], end - begin + 1));
+      }
+    }
+    numKeys += keys.size();
+  }
+
+  if (method == "single" || method == "both") {
+    start = util::WallTime();
+    Result result = Single(engine, sentences);
+    Report("single", result, numKeys, util::WallTime() - start);
+  }
+  if (method == "batch" || method == "both") {
+    start = util::WallTime();
+    Result result = Batch(engine, sentences);
+    Report("batch", result, numKeys, util::WallTime() - start);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -18,6 +18,7 @@ int main(int argc, char* argv[])
   bool log_prob = false;
   bool scfg = false;
   int max_cache_size = 50000;
+  unsigned prefix_filter_bits = 10;
 
   namespace po = boost::program_options;
   po::options_description desc("Options");
@@ -30,6 +31,7 @@ int main(int argc, char* argv[])
   ("log-prob", "log (and floor) probabilities before storing")
   ("max-cache-size", po::value<int>()->default_value(max_cache_size), "Maximum number of high-count source lines to write to cache file. 0=no cache, negative=no limit")
   ("scfg", "Rules are SCFG in Moses format (ie. with non-terms and LHS")
+  ("prefix-filter-bits", po::value<unsigned>()->default_value(prefix_filter_bits), "Bits per source phrase in the filter of source prefixes, which lets the decoder skip spans that can't match. 0=no filter")
 
   ;
 
@@ -58,6 +60,7 @@ int main(int argc, char* argv[])
   if (vm.count("num-scores")) num_scores = vm["num-scores"].as<int>();
   if (vm.count("num-lex-scores")) num_lex_scores = vm["num-lex-scores"].as<int>();
   if (vm.count("max-cache-size")) max_cache_size = vm["max-cache-size"].as<int>();
+  if (vm.count("prefix-filter-bits")) prefix_filter_bits = vm["prefix-filter-bits"].as<unsigned>();
   if (vm.count("log-prob")) log_prob = true;
   if (vm.count("scfg")) scfg = true;
 
@@ -66,7 +69,8 @@ int main(int argc, char* argv[])
     inPath = ReformatSCFGFile(inPath);
   }
 
-  probingpt::createProbingPT(inPath, outPath, num_scores, num_lex_scores, log_prob, max_cache_size, scfg);
+  probingpt::createProbingPT(inPath, outPath, num_scores, num_lex_scores, log_prob, max_cache_size, scfg,
+                             prefix_filter_bits);
 
   //util::PrintUsage(std::cout);
   return 0;
@@ -0,0 +1,60 @@
+#include <cstring>
+#include "prefix_filter.h"
+#include "util/exception.hh"
+#include "util/file.hh"
+
+namespace probingpt
+{
+
+namespace
+{
+const char MAGIC[8] = { 'P', 'r', 'e', 'f', 'i', 'x', 'F', '1' };
+}
+
+PrefixFilter::PrefixFilter()
+  :m_numBlocks(0)
+{
+}
+
+void PrefixFilter::Init(uint64_t numPrefixes, unsigned bitsPerPrefix)
+{
+  uint64_t bits = numPrefixes * bitsPerPrefix;
+  m_numBlocks = (bits + WORDS_PER_BLOCK * 64 - 1) / (WORDS_PER_BLOCK * 64);
+  if (m_numBlocks == 0) {
+    m_numBlocks = 1;
+  }
+  m_bits.assign(m_numBlocks * WORDS_PER_BLOCK, 0);
+}
+
+void PrefixFilter::Save(const std::string &path) const
+{
+  util::scoped_fd file(util::CreateOrThrow(path.c_str()));
+  util::WriteOrThrow(file.get(), MAGIC, sizeof(MAGIC));
+  util::WriteOrThrow(file.get(), &m_numBlocks, sizeof(m_numBlocks));
+  if (m_numBlocks) {
+    util::WriteOrThrow(file.get(), &m_bits[0], m_bits.size() * sizeof(uint64_t));
+  }
+}
+
+void PrefixFilter::Load(const std::string &path)
+{
+  util::scoped_fd file(util::OpenReadOrThrow(path.c_str()));
+  char magic[sizeof(MAGIC)];
+  util::ReadOrThrow(file.get(), magic, sizeof(magic));
+  UTIL_THROW_IF2(memcmp(magic, MAGIC, sizeof(MAGIC)), path << " is not a prefix filter");
+
+  uint64_t numBlocks;
+  util::ReadOrThrow(file.get(), &numBlocks, sizeof(numBlocks));
+  uint64_t size = util::SizeFile(file.get());
+  UTIL_THROW_IF2(size != sizeof(MAGIC) + sizeof(numBlocks) + numBlocks * WORDS_PER_BLOCK * sizeof(uint64_t),
+                 path << " has the wrong size for " << numBlocks << " blocks");
+
+  m_numBlocks = numBlocks;
+  m_bits.resize(m_numBlocks * WORDS_PER_BLOCK);
+  if (m_numBlocks) {
+    util::ReadOrThrow(file.get(), &m_bits[0], m_bits.size() * sizeof(uint64_t));
+  }
+}
+
+}
+
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace probingpt
+{
+
+/** Approximate set of the prefixes of the source phrases in a phrase table,
+ *  by their getKey(). A lookup can skip a span that no source phrase starts
+ *  with, and every longer span from the same position.
+ *
+ *  This is a blocked Bloom filter. The bits of a key are all in one 64-byte
+ *  block, so a test costs at most one cache miss. There are no false
+ *  negatives. With 10 bits per prefix, about 1% of the absent keys pass.
+ */
+class PrefixFilter
+{
+public:
+  //! contains everything until Init() or Load()
+  PrefixFilter();
+
+  void Init(uint64_t numPrefixes, unsigned bitsPerPrefix);
+
+  bool Empty() const {
+    return m_numBlocks == 0;
+  }
+
+  void Add(uint64_t key) {
+    const uint64_t hash = Mix(key);
+    uint64_t *block = &m_bits[BlockOf(hash) * WORDS_PER_BLOCK];
+    uint64_t bits = Mix(hash);
+    for (unsigned i = 0; i < NUM_HASHES; ++i, bits >>= 9) {
+      block[(bits >> 6) & (WORDS_PER_BLOCK - 1)] |= uint64_t(1) << (bits & 63);
+    }
+  }
+
+  bool MayContain(uint64_t key) const {
+    if (m_numBlocks == 0) {
+      return true;
+    }
+    const uint64_t hash = Mix(key);
+    const uint64_t *block = &m_bits[BlockOf(hash) * WORDS_PER_BLOCK];
+    uint64_t bits = Mix(hash);
+    for (unsigned i = 0; i < NUM_HASHES; ++i, bits >>= 9) {
+      if (!(block[(bits >> 6) & (WORDS_PER_BLOCK - 1)] & (uint64_t(1) << (bits & 63)))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void Save(const std::string &path) const;
+
+  //! throws if the file isn't a prefix filter
+  void Load(const std::string &path);
+
+private:
+  static const unsigned WORDS_PER_BLOCK = 8;
+  static const unsigned NUM_HASHES = 6; // 9 bits each, to pick 1 of 512
+
+  uint64_t m_numBlocks;
+  std::vector<uint64_t> m_bits;
+
+  // getKey() is a plain sum, so spread it out first
+  static uint64_t Mix(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  uint64_t BlockOf(uint64_t hash) const {
+    return ((hash >> 32) * m_numBlocks) >> 32;
+  }
+};
+
+}
+
@@ -7,7 +7,7 @@ using namespace std;
 namespace probingpt
 {
 
-QueryEngine::QueryEngine(const char * filepath, util::LoadMethod load_method)
+QueryEngine::QueryEngine(const char * filepath, util::LoadMethod load_method, bool loadVocab)
 {
 
   //Create filepaths
@@ -19,11 +19,13 @@ QueryEngine::QueryEngine(const char * filepath, util::LoadMethod load_method)
 
   file_exits(basepath);
 
-  ///Source phrase vocabids
-  read_map(source_vocabids, path_to_source_vocabid.c_str());
+  if (loadVocab) {
+    ///Source phrase vocabids
+    read_map(source_vocabids, path_to_source_vocabid.c_str());
 
-  // alignments
-  read_alignments(alignPath);
+    // alignments
+    read_alignments(alignPath);
+  }
 
   // target phrase
   string targetCollPath = basepath + "/TargetColl.dat";
@@ -89,6 +91,13 @@ QueryEngine::QueryEngine(const char * filepath, util::LoadMethod load_method)
   Table table_init(mem, table_filesize);
   table = table_init;
 
+  // tables made before there were prefix filters don't have one
+  std::string path_to_prefix_filter = basepath + "/prefix_filter.dat";
+  struct stat prefixFilterStat;
+  if (stat(path_to_prefix_filter.c_str(), &prefixFilterStat) == 0) {
+    prefixFilter.Load(path_to_prefix_filter);
+  }
+
   std::cerr << "Initialized successfully! " << std::endl;
 }
 
@@ -106,7 +115,7 @@ uint64_t QueryEngine::getKey(uint64_t source_phrase[], size_t size) const
   return probingpt::getKey(source_phrase, size);
 }
 
-std::pair<bool, uint64_t> QueryEngine::query(uint64_t key)
+std::pair<bool, uint64_t> QueryEngine::query(uint64_t key) const
 {
   std::pair<bool, uint64_t> ret;
 
@@ -118,6 +127,17 @@ std::pair<bool, uint64_t> QueryEngine::query(uint64_t key)
   return ret;
 }
 
+void QueryEngine::query_batch(const uint64_t keys[], size_t num,
+                              std::pair<bool, uint64_t> results[]) const
+{
+  for (size_t i = 0; i < num; ++i) {
+    table.Prefetch(keys[i]);
+  }
+  for (size_t i = 0; i < num; ++i) {
+    results[i] = query(keys[i]);
+  }
+}
+
 void QueryEngine::read_alignments(const std::string &alignPath)
 {
   std::ifstream strm(alignPath.c_str());
@@ -7,6 +7,7 @@
 #include <deque>
 #include "vocabid.h"
 #include "probing_hash_utils.h"
+#include "prefix_filter.h"
 #include "hash.h" //Includes line splitter
 #include "line_splitter.h"
 #include "util.h"
@@ -37,6 +38,8 @@ class QueryEngine
   util::scoped_fd fileTPS_;
   util::scoped_memory memoryTPS_;
 
+  PrefixFilter prefixFilter; // contains everything for tables without one
+
   void read_alignments(const std::string &alignPath);
   void file_exits(const std::string &basePath);
 
@@ -46,10 +49,17 @@ public:
   bool logProb;
   const char *memTPS;
 
-  QueryEngine(const char *, util::LoadMethod load_method);
+  //! without the source vocab and alignments, for a caller that has its own copy of them
+  QueryEngine(const char *, util::LoadMethod load_method, bool loadVocab = true);
   ~QueryEngine();
 
-  std::pair<bool, uint64_t> query(uint64_t key);
+  std::pair<bool, uint64_t> query(uint64_t key) const;
+
+  /** Look up num keys at once, eg. every span of a sentence. Prefetches all
+   *  their buckets before probing any, so the cache misses overlap.
+   *  results[i] is what query(keys[i]) returns
+   */
+  void query_batch(const uint64_t keys[], size_t num, std::pair<bool, uint64_t> results[]) const;
 
   const std::map<uint64_t, std::string> &getSourceVocab() const {
     return source_vocabids;
@@ -61,6 +71,11 @@ public:
 
   uint64_t getKey(uint64_t source_phrase[], size_t size) const;
 
+  //! false if no source phrase starts with the phrase of this key
+  bool mayBePrefix(uint64_t key) const {
+    return prefixFilter.MayContain(key);
+  }
+
   template<typename T>
   inline bool Get(const boost::unordered_map<std::string, std::string> &keyValue, const std::string &sought, T &found) const {
     boost::unordered_map<std::string, std::string>::const_iterator iter = keyValue.find(sought);
@@ -65,7 +65,8 @@ void Node::Write(Table &table)
 ///////////////////////////////////////////////////////////////////////
 void createProbingPT(const std::string &phrasetable_path,
                      const std::string &basepath, int num_scores, int num_lex_scores,
-                     bool log_prob, int max_cache_size, bool scfg)
+                     bool log_prob, int max_cache_size, bool scfg,
+                     unsigned prefix_filter_bits)
 {
 #if defined(_WIN32) || defined(_WIN64)
   std::cerr << "Create not implemented for Windows" << std::endl;
@@ -92,6 +93,13 @@ void createProbingPT(const std::string &phrasetable_path,
   memset(mem, 0, size);
   Table sourceEntries(mem, size);
 
+  // SCFG tables store prefixes as entries of their own, for the chart lookups
+  PrefixFilter prefixFilter;
+  if (prefix_filter_bits && !scfg) {
+    // most prefixes of a source phrase are source phrases too
+    prefixFilter.Init(uniq_entries, prefix_filter_bits);
+  }
+
   std::priority_queue<CacheItem*, std::vector<CacheItem*>, CacheItemOrderer> cache;
   float totalSourceCount = 0;
 
@@ -147,6 +155,8 @@ void createProbingPT(const std::string &phrasetable_path,
         if (scfg) {
           // storing prefixes?
           sourcePhrases.Add(sourceEntries, vocabid_source);
+        } else if (!prefixFilter.Empty()) {
+          addPrefixes(prefixFilter, vocabid_source);
         }
         sourceEntry.key = getKey(vocabid_source);
 
@@ -205,6 +215,9 @@ void createProbingPT(const std::string &phrasetable_path,
       //The key is the sum of hashes of individual words. Probably not entirerly correct, but fast
       std::vector<uint64_t> vocabid_source = getVocabIDs(prevSource);
       sourceEntry.key = getKey(vocabid_source);
+      if (!prefixFilter.Empty()) {
+        addPrefixes(prefixFilter, vocabid_source);
+      }
 
       //Put into table
       sourceEntries.Insert(sourceEntry);
@@ -219,6 +232,10 @@ void createProbingPT(const std::string &phrasetable_path,
 
   serialize_table(mem, size, (basepath + "/probing_hash.dat"));
 
+  if (!prefixFilter.Empty()) {
+    prefixFilter.Save(basepath + "/prefix_filter.dat");
+  }
+
   sourceVocab.Save();
 
   serialize_cache(cache, (basepath + "/cache"), totalSourceCount);
@@ -287,6 +304,16 @@ uint64_t getKey(const std::vector<uint64_t> &vocabid_source)
   return probingpt::getKey(vocabid_source.data(), vocabid_source.size());
 }
 
+void addPrefixes(PrefixFilter &filter, const std::vector<uint64_t> &vocabid_source)
+{
+  // getKey() of each prefix, one word at a time
+  uint64_t key = 0;
+  for (size_t i = 0; i < vocabid_source.size(); ++i) {
+    key += (vocabid_source[i] << i);
+    filter.Add(key);
+  }
+}
+
 std::vector<uint64_t> CreatePrefix(const std::vector<uint64_t> &vocabid_source, size_t endPos)
 {
   assert(endPos < vocabid_source.size());
@@ -12,6 +12,7 @@
 
 #include "hash.h" //Includes line_splitter
 #include "probing_hash_utils.h"
+#include "prefix_filter.h"
 #include "vocabid.h"
 
 #include "util/file_piece.hh"
@@ -40,11 +41,16 @@ public:
 };
 
 
+//! prefix_filter_bits: bits per source phrase in the prefix filter. 0 = no filter
 void createProbingPT(const std::string &phrasetable_path,
                      const std::string &basepath, int num_scores, int num_lex_scores,
-                     bool log_prob, int max_cache_size, bool scfg);
+                     bool log_prob, int max_cache_size, bool scfg,
+                     unsigned prefix_filter_bits = 10);
 uint64_t getKey(const std::vector<uint64_t> &source_phrase);
 
+//! add the keys of source_phrase and of all its prefixes
+void addPrefixes(PrefixFilter &filter, const std::vector<uint64_t> &source_phrase);
+
 std::vector<uint64_t> CreatePrefix(const std::vector<uint64_t> &vocabid_source, size_t endPos);
 
 template<typename T>
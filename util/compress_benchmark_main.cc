@@ -0,0 +1,112 @@
+#include "util/file.hh"
+#include "util/file_piece.hh"
+#include "util/read_compressed.hh"
+#include "util/usage.hh"
+#include "util/write_compressed.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace util {
+namespace {
+
+const std::size_t kChunk = 1 << 20;
+
+std::string ReadAll(const char *name) {
+  ReadCompressed in(OpenReadOrThrow(name));
+  std::string ret;
+  std::size_t got;
+  do {
+    std::size_t old = ret.size();
+    ret.resize(old + kChunk);
+    got = in.ReadOrEOF(&ret[old], kChunk);
+    ret.resize(old + got);
+  } while (got);
+  return ret;
+}
+
+double MBPerSecond(std::size_t bytes, double seconds) {
+  return static_cast<double>(bytes) / seconds / 1048576.0;
+}
+
+void Benchmark(const std::string &original, int level) {
+  std::cout << "#compression\tratio\tcompress MB/s\tdecompress MB/s\tFilePiece lines MB/s\n";
+  const WriteCompressed::Compression compressions[] = {WriteCompressed::NONE, WriteCompressed::GZIP, WriteCompressed::ZSTD, WriteCompressed::LZ4};
+  for (std::size_t c = 0; c < sizeof(compressions) / sizeof(WriteCompressed::Compression); ++c) {
+    const WriteCompressed::Compression compression = compressions[c];
+    if (!WriteCompressed::Available(compression)) {
+      std::cout << WriteCompressed::Name(compression) << "\tnot compiled in" << std::endl;
+      continue;
+    }
+    scoped_fd file(MakeTemp("compress_benchmark"));
+
+    double start = WallTime();
+    {
+      WriteCompressed out(file.get(), compression, level);
+      for (std::size_t i = 0; i < original.size(); i += kChunk) {
+        out.Write(original.data() + i, std::min(kChunk, original.size() - i));
+      }
+      out.Finish();
+    }
+    const double compress_time = WallTime() - start;
+    const uint64_t compressed_size = SizeOrThrow(file.get());
+
+    SeekOrThrow(file.get(), 0);
+    std::string back(original.size() + 1, 0);
+    start = WallTime();
+    std::size_t got;
+    {
+      ReadCompressed in(DupOrThrow(file.get()));
+      got = in.ReadOrEOF(&back[0], back.size());
+    }
+    const double decompress_time = WallTime() - start;
+    if (got != original.size() || memcmp(back.data(), original.data(), got)) {
+      std::cerr << WriteCompressed::Name(compression) << " did not round trip" << std::endl;
+      abort();
+    }
+
+    // How extract is consumed: a line at a time.
+    SeekOrThrow(file.get(), 0);
+    start = WallTime();
+    uint64_t lines = 0;
+    {
+      FilePiece in(DupOrThrow(file.get()), WriteCompressed::Name(compression));
+      try {
+        while (true) {
+          in.ReadLine();
+          ++lines;
+        }
+      } catch (const EndOfFileException &e) {}
+    }
+    const double line_time = WallTime() - start;
+
+    std::cout << WriteCompressed::Name(compression) << '\t'
+      << (static_cast<double>(original.size()) / static_cast<double>(compressed_size)) << '\t'
+      << MBPerSecond(original.size(), compress_time) << '\t'
+      << MBPerSecond(original.size(), decompress_time) << '\t'
+      << MBPerSecond(original.size(), line_time) << std::endl;
+  }
+}
+
+} // namespace
+} // namespace util
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " file [level]\n"
+      "Compresses file, eg. an extract file, with each compression compiled in, then\n"
+      "reads it back as a block and with FilePiece line by line.  Speeds are MB of\n"
+      "uncompressed text per second.  level 0 is each library's default.\n";
+    return 1;
+  }
+  int level = argc > 2 ? std::atoi(argv[2]) : 0;
+  try {
+    util::Benchmark(util::ReadAll(argv[1]), level);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
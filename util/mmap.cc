@@ -25,6 +25,11 @@
 #include <unistd.h>
 #endif
 
+// Linux 6.1 and later.  Older kernels reject it with EINVAL.
+#if defined(__linux__) && !defined(MADV_COLLAPSE)
+#define MADV_COLLAPSE 25
+#endif
+
 namespace util {
 
 std::size_t SizePage() {
@@ -320,6 +325,21 @@ void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scope
       HugeMalloc(size, false, out);
       ParallelRead(fd, out.get(), size, offset);
       break;
+    case HUGE_READ:
+      HugeMalloc(size, false, out);
+      ParallelRead(fd, out.get(), size, offset);
+#ifdef __linux__
+      // Huge pages may have been refused when the read faulted the memory in.
+      // Failure just leaves small pages.
+      if (out.source() == scoped_memory::MMAP_ROUND_UP_ALLOCATED) {
+        madvise(out.get(), RoundUpPow2(size, SizePage()), MADV_COLLAPSE);
+      }
+#endif
+      break;
+    case BACKGROUND_POPULATE:
+      out.reset(MapOrThrow(size, false, kFileFlags, false, fd, offset), size, scoped_memory::MMAP_ALLOCATED);
+      BackgroundPopulate(fd, out.get(), size, offset);
+      break;
   }
 }
 
@@ -139,6 +139,14 @@ typedef enum {
   READ,
   // malloc and read in parallel (recommended for Lustre)
   PARALLEL_READ,
+  // As PARALLEL_READ, then on Linux ask for the memory to be collapsed into
+  // transparent huge pages at once rather than whenever khugepaged gets to
+  // it.  Falls back to small pages.
+  HUGE_READ,
+  // mmap with no prepopulate and return, while a background thread populates
+  // the mapping and reports its progress to stderr.  Queries can start at
+  // once; they are slower until the pages they touch are in.
+  BACKGROUND_POPULATE,
 } LoadMethod;
 
 void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scoped_memory &out);
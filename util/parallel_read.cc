@@ -1,6 +1,85 @@
 #include "util/parallel_read.hh"
 
 #include "util/file.hh"
+#include "util/scoped.hh"
+#include "util/usage.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#endif
+
+namespace util {
+namespace {
+
+// Populate amount bytes of mapped, the mapping of fd from offset.  False if
+// the mapping is gone.
+bool PopulateChunk(int fd, const void *mapped, std::size_t amount, uint64_t offset, std::vector<char> &scratch) {
+#ifdef MADV_POPULATE_READ
+  // Linux 5.14 and later: fault in the page tables too, without touching the
+  // memory, which may have been unmapped.
+  if (!madvise(const_cast<void*>(mapped), amount, MADV_POPULATE_READ)) return true;
+  if (errno == ENOMEM) return false;
+#endif
+  // Otherwise load the page cache, so faults on the mapping are minor.
+  scratch.resize(std::min<std::size_t>(amount, 1 << 20));
+  for (std::size_t done = 0; done < amount; done += scratch.size()) {
+    ErsatzPRead(fd, &scratch[0], std::min(scratch.size(), amount - done), offset + done);
+  }
+  return true;
+}
+
+class Populator {
+  public:
+    // Takes ownership of fd.
+    Populator(int fd, const void *mapped, std::size_t amount, uint64_t offset)
+      : fd_(fd), mapped_(mapped), amount_(amount), offset_(offset) {}
+
+    void operator()() {
+      scoped_fd fd(fd_);
+      try {
+        Run(fd.get());
+      } catch (const std::exception &e) {
+        std::cerr << "Populating in the background failed: " << e.what() << std::endl;
+      }
+    }
+
+  private:
+    void Run(int fd) {
+      const std::size_t kChunk = 1ULL << 26; // 64 MB
+      const std::string name(NameFromFD(fd));
+      const double start = WallTime();
+      std::vector<char> scratch;
+      unsigned reported = 0;
+      for (std::size_t done = 0; done < amount_; ) {
+        std::size_t chunk = std::min(kChunk, amount_ - done);
+        if (!PopulateChunk(fd, static_cast<const char*>(mapped_) + done, chunk, offset_ + done, scratch)) {
+          return;
+        }
+        done += chunk;
+        unsigned tenths = static_cast<unsigned>(done * 10 / amount_);
+        if (tenths > reported) {
+          reported = tenths;
+          std::ostringstream message;
+          message << "Populated " << (reported * 10) << "% of " << name << " in " << (WallTime() - start) << " s\n";
+          std::cerr << message.str() << std::flush;
+        }
+      }
+    }
+
+    int fd_;
+    const void *mapped_;
+    std::size_t amount_;
+    uint64_t offset_;
+};
+
+} // namespace
+} // namespace util
 
 #ifdef WITH_THREADS
 #include "util/thread_pool.hh"
@@ -56,6 +135,14 @@ void ParallelRead(int fd, void *to, std::size_t amount, uint64_t offset) {
   }
 }
 
+void BackgroundPopulate(int fd, const void *mapped, std::size_t amount, uint64_t offset) {
+  // Its own fd, since the caller may close theirs.
+  scoped_fd dup(DupOrThrow(fd));
+  boost::thread populate(Populator(dup.get(), mapped, amount, offset));
+  dup.release();
+  populate.detach();
+}
+
 } // namespace util
 
 #else // WITH_THREADS
@@ -64,6 +151,10 @@ namespace util {
 void ParallelRead(int fd, void *to, std::size_t amount, uint64_t offset) {
  util::ErsatzPRead(fd, to, amount, offset);
 }
+
+void BackgroundPopulate(int fd, const void *mapped, std::size_t amount, uint64_t offset) {
+  Populator(DupOrThrow(fd), mapped, amount, offset)();
+}
 } // namespace util
 
 #endif
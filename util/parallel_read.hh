@@ -11,6 +11,13 @@
 
 namespace util {
 void ParallelRead(int fd, void *to, std::size_t amount, uint64_t offset);
+
+/* Populate mapped, a read-only mapping of amount bytes of fd from offset,
+ * from a detached thread that reports its progress to stderr.  The mapping
+ * may be unmapped before it's done; the thread then stops.  Without threads,
+ * this populates before returning.
+ */
+void BackgroundPopulate(int fd, const void *mapped, std::size_t amount, uint64_t offset);
 } // namespace util
 
 #endif // UTIL_PARALLEL_READ__
@@ -0,0 +1,20 @@
+#ifndef UTIL_PREFETCH_H
+#define UTIL_PREFETCH_H
+
+namespace util {
+
+/* Hint that the cache line holding address will be read soon.  Issue these
+ * for several independent lookups before resolving any of them so their
+ * memory latency overlaps.  Does nothing on compilers without the builtin.
+ */
+inline void Prefetch(const void *address) {
+#if defined(__GNUC__)
+  __builtin_prefetch(address);
+#else
+  (void)address;
+#endif
+}
+
+} // namespace util
+
+#endif // UTIL_PREFETCH_H
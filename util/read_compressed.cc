@@ -24,6 +24,14 @@
 #include <lzma.h>
 #endif
 
+#ifdef HAVE_ZSTDLIB
+#include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4LIB
+#include <lz4frame.h>
+#endif
+
 namespace util {
 
 CompressedException::CompressedException() throw() {}
@@ -38,6 +46,12 @@ BZException::~BZException() throw() {}
 XZException::XZException() throw() {}
 XZException::~XZException() throw() {}
 
+ZStdException::ZStdException() throw() {}
+ZStdException::~ZStdException() throw() {}
+
+LZ4Exception::LZ4Exception() throw() {}
+LZ4Exception::~LZ4Exception() throw() {}
+
 class ReadBase {
   public:
     virtual ~ReadBase() {}
@@ -326,6 +340,110 @@ class XZip {
 };
 #endif // HAVE_XZLIB
 
+// zstd and lz4 take buffers rather than a stream struct, so keep one that
+// looks like z_stream for StreamCompressed.
+struct BufferStream {
+  const uint8_t *next_in;
+  std::size_t avail_in;
+  uint8_t *next_out;
+  std::size_t avail_out;
+};
+
+#ifdef HAVE_ZSTDLIB
+class ZStd {
+  public:
+    ZStd(const void *base, std::size_t amount) : context_(ZSTD_createDStream()) {
+      if (!context_) throw std::bad_alloc();
+      SetInput(base, amount);
+      SetOutput(NULL, 0);
+    }
+
+    ~ZStd() {
+      ZSTD_freeDStream(context_);
+    }
+
+    void SetOutput(void *base, std::size_t amount) {
+      stream_.next_out = static_cast<uint8_t*>(base);
+      stream_.avail_out = amount;
+    }
+
+    void SetInput(const void *base, std::size_t amount) {
+      stream_.next_in = static_cast<const uint8_t*>(base);
+      stream_.avail_in = amount;
+    }
+
+    const BufferStream &Stream() const { return stream_; }
+
+    bool Process() {
+      ZSTD_inBuffer in = { stream_.next_in, stream_.avail_in, 0 };
+      ZSTD_outBuffer out = { stream_.next_out, stream_.avail_out, 0 };
+      std::size_t ret = ZSTD_decompressStream(context_, &out, &in);
+      UTIL_THROW_IF(ZSTD_isError(ret), ZStdException, "zstd encountered " << ZSTD_getErrorName(ret));
+      stream_.next_in += in.pos;
+      stream_.avail_in -= in.pos;
+      stream_.next_out += out.pos;
+      stream_.avail_out -= out.pos;
+      // 0 means a frame is done and flushed.  Anything after it is another frame.
+      if (!ret) return false;
+      UTIL_THROW_IF(!in.size && !out.pos, ZStdException, "zstd says unexpected end of input");
+      return true;
+    }
+
+  private:
+    ZSTD_DStream *context_;
+    BufferStream stream_;
+};
+#endif // HAVE_ZSTDLIB
+
+#ifdef HAVE_LZ4LIB
+class LZ4 {
+  public:
+    LZ4(const void *base, std::size_t amount) {
+      HandleError(LZ4F_createDecompressionContext(&context_, LZ4F_VERSION));
+      SetInput(base, amount);
+      SetOutput(NULL, 0);
+    }
+
+    ~LZ4() {
+      LZ4F_freeDecompressionContext(context_);
+    }
+
+    void SetOutput(void *base, std::size_t amount) {
+      stream_.next_out = static_cast<uint8_t*>(base);
+      stream_.avail_out = amount;
+    }
+
+    void SetInput(const void *base, std::size_t amount) {
+      stream_.next_in = static_cast<const uint8_t*>(base);
+      stream_.avail_in = amount;
+    }
+
+    const BufferStream &Stream() const { return stream_; }
+
+    bool Process() {
+      std::size_t in = stream_.avail_in, out = stream_.avail_out;
+      std::size_t ret = HandleError(LZ4F_decompress(context_, stream_.next_out, &out, stream_.next_in, &in, NULL));
+      stream_.next_in += in;
+      stream_.avail_in -= in;
+      stream_.next_out += out;
+      stream_.avail_out -= out;
+      // 0 means a frame is done and flushed.  Anything after it is another frame.
+      if (!ret) return false;
+      UTIL_THROW_IF(!in && !out, LZ4Exception, "lz4 says unexpected end of input");
+      return true;
+    }
+
+  private:
+    std::size_t HandleError(std::size_t value) {
+      UTIL_THROW_IF(LZ4F_isError(value), LZ4Exception, "lz4 encountered " << LZ4F_getErrorName(value));
+      return value;
+    }
+
+    LZ4F_dctx *context_;
+    BufferStream stream_;
+};
+#endif // HAVE_LZ4LIB
+
 class IStreamReader : public ReadBase {
   public:
     explicit IStreamReader(std::istream &stream) : stream_(stream) {}
@@ -344,7 +462,7 @@ class IStreamReader : public ReadBase {
 };
 
 enum MagicResult {
-  UTIL_UNKNOWN, UTIL_GZIP, UTIL_BZIP, UTIL_XZIP
+  UTIL_UNKNOWN, UTIL_GZIP, UTIL_BZIP, UTIL_XZIP, UTIL_ZSTD, UTIL_LZ4
 };
 
 MagicResult DetectMagic(const void *from_void, std::size_t length) {
@@ -360,6 +478,14 @@ MagicResult DetectMagic(const void *from_void, std::size_t length) {
   if (length >= sizeof(kXZMagic) && !memcmp(header, kXZMagic, sizeof(kXZMagic))) {
     return UTIL_XZIP;
   }
+  const uint8_t kZStdMagic[4] = { 0x28, 0xB5, 0x2F, 0xFD };
+  if (length >= sizeof(kZStdMagic) && !memcmp(header, kZStdMagic, sizeof(kZStdMagic))) {
+    return UTIL_ZSTD;
+  }
+  const uint8_t kLZ4Magic[4] = { 0x04, 0x22, 0x4D, 0x18 };
+  if (length >= sizeof(kLZ4Magic) && !memcmp(header, kLZ4Magic, sizeof(kLZ4Magic))) {
+    return UTIL_LZ4;
+  }
   return UTIL_UNKNOWN;
 }
 
@@ -394,6 +520,18 @@ ReadBase *ReadFactory(int fd, uint64_t &raw_amount, const void *already_data, co
       return new StreamCompressed<XZip>(hold.release(), header.data(), header.size());
 #else
       UTIL_THROW(CompressedException, "This looks like an xz file, but xz support was not compiled in.");
+#endif
+    case UTIL_ZSTD:
+#ifdef HAVE_ZSTDLIB
+      return new StreamCompressed<ZStd>(hold.release(), header.data(), header.size());
+#else
+      UTIL_THROW(CompressedException, "This looks like a zstd file, but zstd support was not compiled in.");
+#endif
+    case UTIL_LZ4:
+#ifdef HAVE_LZ4LIB
+      return new StreamCompressed<LZ4>(hold.release(), header.data(), header.size());
+#else
+      UTIL_THROW(CompressedException, "This looks like an lz4 file, but lz4 support was not compiled in.");
 #endif
     default:
       UTIL_THROW_IF(require_compressed, CompressedException, "Uncompressed data detected after a compresssed file.  This could be supported but usually indicates an error.");
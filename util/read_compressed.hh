@@ -33,6 +33,18 @@ class XZException : public CompressedException {
     ~XZException() throw();
 };
 
+class ZStdException : public CompressedException {
+  public:
+    ZStdException() throw();
+    ~ZStdException() throw();
+};
+
+class LZ4Exception : public CompressedException {
+  public:
+    LZ4Exception() throw();
+    ~LZ4Exception() throw();
+};
+
 class ReadBase;
 
 class ReadCompressed {
@@ -2,6 +2,7 @@
 
 #include "util/file.hh"
 #include "util/have.hh"
+#include "util/write_compressed.hh"
 
 #define BOOST_TEST_MODULE ReadCompressedTest
 #include <boost/test/unit_test.hpp>
@@ -112,11 +113,73 @@ BOOST_AUTO_TEST_CASE(ReadXZ) {
 }
 #endif
 
+#ifdef HAVE_ZSTDLIB
+BOOST_AUTO_TEST_CASE(ReadZStd) {
+  TestRandom("zstd");
+}
+#endif
+
+#ifdef HAVE_LZ4LIB
+BOOST_AUTO_TEST_CASE(ReadLZ4) {
+  TestRandom("lz4");
+}
+#endif
+
 #ifdef HAVE_ZLIB
 BOOST_AUTO_TEST_CASE(AppendGZ) {
 }
 #endif
 
+// Writes the numbers as two compressed files one after the other, which should
+// read back as one.
+void TestWrite(WriteCompressed::Compression compression) {
+  char name[] = "tempXXXXXX";
+  scoped_fd file(mkstemp(name));
+  BOOST_REQUIRE(file.get() > 0);
+  BOOST_CHECK_EQUAL(0, unlink(name));
+  uint32_t i = 0;
+  for (unsigned int part = 0; part < 2; ++part) {
+    WriteCompressed writer(file.get(), compression);
+    for (; i < kSize4 * (part + 1) / 2; ++i) {
+      writer.Write(&i, sizeof(uint32_t));
+    }
+    writer.Finish();
+    BOOST_CHECK_EQUAL(kSize4 / 2 * sizeof(uint32_t), writer.RawAmount());
+  }
+  SeekOrThrow(file.get(), 0);
+  ReadCompressed reader(file.release());
+  VerifyRead(reader);
+}
+
+BOOST_AUTO_TEST_CASE(WriteUncompressed) {
+  TestWrite(WriteCompressed::NONE);
+}
+
+#ifdef HAVE_ZLIB
+BOOST_AUTO_TEST_CASE(WriteGZ) {
+  TestWrite(WriteCompressed::GZIP);
+}
+#endif
+
+#ifdef HAVE_ZSTDLIB
+BOOST_AUTO_TEST_CASE(WriteZStd) {
+  TestWrite(WriteCompressed::ZSTD);
+}
+#endif
+
+#ifdef HAVE_LZ4LIB
+BOOST_AUTO_TEST_CASE(WriteLZ4) {
+  TestWrite(WriteCompressed::LZ4);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(Extension) {
+  BOOST_CHECK_EQUAL(WriteCompressed::GZIP, WriteCompressed::FromExtension("extract.sorted.gz"));
+  BOOST_CHECK_EQUAL(WriteCompressed::ZSTD, WriteCompressed::FromExtension("extract.sorted.zst"));
+  BOOST_CHECK_EQUAL(WriteCompressed::LZ4, WriteCompressed::FromExtension("extract.sorted.lz4"));
+  BOOST_CHECK_EQUAL(WriteCompressed::NONE, WriteCompressed::FromExtension("extract.sorted"));
+}
+
 BOOST_AUTO_TEST_CASE(IStream) {
   std::string name(WriteRandom());
   std::fstream stream(name.c_str(), std::ios::in);
@@ -49,6 +49,9 @@ struct ChainConfig {
  */
 struct SortConfig {
 
+  /** Constructs a configuration that sorts each block on one thread. */
+  SortConfig() : buffer_size(0), total_memory(0), threads(1) {}
+
   /** Filename prefix where temporary files should be placed. */
   std::string temp_prefix;
 
@@ -57,6 +60,12 @@ struct SortConfig {
 
   /** Total memory to use when running alone. */
   std::size_t total_memory;
+
+  /**
+   * Threads to sort each block with before it is written.  With more than
+   * one, each sorter also allocates a scratch buffer the size of a block.
+   */
+  std::size_t threads;
 };
 
 }} // namespaces
@@ -1,6 +1,7 @@
 #include "util/stream/io.hh"
 
 #include "util/file.hh"
+#include "util/read_compressed.hh"
 #include "util/stream/chain.hh"
 
 #include <cstddef>
@@ -74,5 +75,30 @@ void PWriteAndRecycle::Run(const ChainPosition &position) {
   util::ResizeOrThrow(file_, offset);
 }
 
+void Compress::Run(const ChainPosition &position) {
+  WriteCompressed out(file_, compression_, level_);
+  for (Link link(position); link; ++link) {
+    out.Write(link->Get(), link->ValidSize());
+  }
+  out.Finish();
+}
+
+void Decompress::Run(const ChainPosition &position) {
+  // ReadCompressed owns what it reads.
+  ReadCompressed in(own_ ? file_ : DupOrThrow(file_));
+  const std::size_t block_size = position.GetChain().BlockSize();
+  const std::size_t entry_size = position.GetChain().EntrySize();
+  for (Link link(position); link; ++link) {
+    std::size_t got = in.ReadOrEOF(link->Get(), block_size);
+    UTIL_THROW_IF(got % entry_size, ReadSizeException, "File ended with " << got << " bytes, not a multiple of " << entry_size << ".");
+    if (got == 0) {
+      link.Poison();
+      return;
+    } else {
+      link->SetValidSize(got);
+    }
+  }
+}
+
 } // namespace stream
 } // namespace util
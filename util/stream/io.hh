@@ -3,6 +3,7 @@
 
 #include "util/exception.hh"
 #include "util/file.hh"
+#include "util/write_compressed.hh"
 
 namespace util {
 namespace stream {
@@ -59,6 +60,30 @@ class PWriteAndRecycle {
     int file_;
 };
 
+// Like Write but compresses the blocks as one stream that ReadCompressed can
+// read.  Does not take ownership of fd.
+class Compress {
+  public:
+    Compress(int fd, WriteCompressed::Compression compression, int level = 0)
+      : file_(fd), compression_(compression), level_(level) {}
+    void Run(const ChainPosition &position);
+  private:
+    int file_;
+    WriteCompressed::Compression compression_;
+    int level_;
+};
+
+// Like Read but decompresses anything ReadCompressed can.  Uncompressed files
+// work too.  Reads from the current offset of fd, shared with any copy.
+class Decompress {
+  public:
+    explicit Decompress(int fd, bool take_own = false) : file_(fd), own_(take_own) {}
+    void Run(const ChainPosition &position);
+  private:
+    int file_;
+    bool own_;
+};
+
 
 // Reuse the same file over and over again to buffer output.
 class FileBuffer {
@@ -35,4 +35,40 @@ BOOST_AUTO_TEST_CASE(CopyFile) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(CompressDecompress) {
+  std::string temps("io_test_temp");
+
+  scoped_fd in(MakeTemp(temps));
+  for (uint64_t i = 0; i < 100000; ++i) {
+    WriteOrThrow(in.get(), &i, sizeof(uint64_t));
+  }
+
+  ChainConfig config;
+  config.entry_size = 8;
+  config.total_memory = 1024;
+  config.block_count = 10;
+
+  const WriteCompressed::Compression compressions[] = {WriteCompressed::NONE, WriteCompressed::GZIP, WriteCompressed::ZSTD, WriteCompressed::LZ4};
+  for (std::size_t c = 0; c < sizeof(compressions) / sizeof(WriteCompressed::Compression); ++c) {
+    if (!WriteCompressed::Available(compressions[c])) continue;
+    scoped_fd compressed(MakeTemp(temps));
+    Chain(config) >> PRead(in.get()) >> Compress(compressed.get(), compressions[c]);
+    if (compressions[c] != WriteCompressed::NONE) {
+      BOOST_CHECK(SizeOrThrow(compressed.get()) < 100000 * sizeof(uint64_t));
+    }
+
+    SeekOrThrow(compressed.get(), 0);
+    scoped_fd out(MakeTemp(temps));
+    Chain(config) >> Decompress(compressed.get()) >> Write(out.get());
+
+    SeekOrThrow(out.get(), 0);
+    BOOST_REQUIRE_EQUAL(100000 * sizeof(uint64_t), SizeOrThrow(out.get()));
+    for (uint64_t i = 0; i < 100000; ++i) {
+      uint64_t got;
+      ReadOrThrow(out.get(), &got, sizeof(uint64_t));
+      BOOST_CHECK_EQUAL(i, got);
+    }
+  }
+}
+
 }}} // namespaces
@@ -0,0 +1,218 @@
+#ifndef UTIL_STREAM_PARALLEL_SORT_H
+#define UTIL_STREAM_PARALLEL_SORT_H
+
+#include "util/sized_iterator.hh"
+
+#include <boost/bind.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <stdint.h>
+
+namespace util {
+namespace stream {
+
+/* Sorts a block of fixed-size entries with several threads.  This is a sample
+ * sort:
+ *   1. Each thread sorts one stripe of the block.
+ *   2. Splitters sampled from the sorted stripes divide the key space into one
+ *      bucket per thread.
+ *   3. Each thread merges its bucket from every stripe into a scratch buffer,
+ *      then copies it back.
+ * Only Compare is used, so any comparator that works with std::sort works
+ * here.  The scratch buffer is as large as the largest block sorted.  Blocks
+ * too small to be worth the threads are sorted on the calling thread.
+ */
+template <class Compare> class ParallelSort {
+  public:
+    ParallelSort(std::size_t threads, const Compare &compare = Compare())
+      : threads_(std::max<std::size_t>(1, threads)), compare_(compare), sized_compare_(compare) {}
+
+    void operator()(void *begin, void *end, std::size_t entry_size) {
+      const std::size_t entries = (static_cast<uint8_t*>(end) - static_cast<uint8_t*>(begin)) / entry_size;
+      std::size_t threads = std::min(threads_, entries / kMinimumPerThread);
+      if (threads <= 1) {
+        SortRange(begin, end, entry_size);
+        return;
+      }
+      const std::size_t size = entries * entry_size;
+      if (scratch_.size() < size) scratch_.resize(size);
+      Job job(static_cast<uint8_t*>(begin), entries, entry_size, threads);
+      boost::thread_group helpers;
+      for (std::size_t i = 1; i < threads; ++i) {
+        helpers.create_thread(boost::bind(&ParallelSort<Compare>::Work, this, boost::ref(job), i));
+      }
+      Work(job, 0);
+      helpers.join_all();
+    }
+
+    std::size_t Threads() const { return threads_; }
+
+  private:
+    // Below this many entries per thread, sort on one thread.
+    static const std::size_t kMinimumPerThread = 4096;
+    // Samples taken from each stripe, per bucket.
+    static const std::size_t kOversample = 16;
+
+    struct Job {
+      Job(uint8_t *in_begin, std::size_t in_entries, std::size_t in_entry_size, std::size_t in_threads)
+        : begin(in_begin), entries(in_entries), entry_size(in_entry_size), threads(in_threads),
+          barrier(in_threads), cuts(in_threads * (in_threads + 1)) {}
+
+      // Entries [StripeBegin(s), StripeBegin(s + 1)) form stripe s.
+      std::size_t StripeBegin(std::size_t stripe) const {
+        return entries * stripe / threads;
+      }
+
+      // Bucket b of stripe s is [Cut(s, b), Cut(s, b + 1)).
+      std::size_t &Cut(std::size_t stripe, std::size_t bucket) {
+        return cuts[stripe * (threads + 1) + bucket];
+      }
+
+      uint8_t *const begin;
+      const std::size_t entries, entry_size, threads;
+      boost::barrier barrier;
+      // Sorted sample, threads - 1 splitters picked from it.
+      std::vector<uint8_t> splitters;
+      std::vector<std::size_t> cuts;
+    };
+
+    void Work(Job &job, std::size_t me) {
+      const std::size_t entry_size = job.entry_size;
+      SortRange(job.begin + job.StripeBegin(me) * entry_size, job.begin + job.StripeBegin(me + 1) * entry_size, entry_size);
+      job.barrier.wait();
+
+      if (me == 0) PickSplitters(job);
+      job.barrier.wait();
+
+      // Cut my stripe at each splitter.
+      const std::size_t stripe_begin = job.StripeBegin(me), stripe_end = job.StripeBegin(me + 1);
+      job.Cut(me, 0) = stripe_begin;
+      for (std::size_t b = 1; b < job.threads; ++b) {
+        job.Cut(me, b) = LowerBound(job, job.Cut(me, b - 1), stripe_end, &job.splitters[(b - 1) * entry_size]);
+      }
+      job.Cut(me, job.threads) = stripe_end;
+      job.barrier.wait();
+
+      // Where my bucket goes: after every smaller bucket.
+      std::size_t out = 0, count = 0;
+      for (std::size_t s = 0; s < job.threads; ++s) {
+        out += job.Cut(s, me) - job.StripeBegin(s);
+        count += job.Cut(s, me + 1) - job.Cut(s, me);
+      }
+      uint8_t *to = &scratch_[0] + out * entry_size;
+      Merge(job, me, to);
+      // The merge read the block, so wait for everybody before writing it.
+      job.barrier.wait();
+      std::memcpy(job.begin + out * entry_size, to, count * entry_size);
+    }
+
+    void PickSplitters(Job &job) {
+      const std::size_t entry_size = job.entry_size;
+      const std::size_t per_stripe = kOversample * job.threads;
+      std::vector<uint8_t> sample;
+      sample.reserve(per_stripe * job.threads * entry_size);
+      for (std::size_t s = 0; s < job.threads; ++s) {
+        const std::size_t stripe_begin = job.StripeBegin(s), stripe_size = job.StripeBegin(s + 1) - stripe_begin;
+        for (std::size_t i = 0; i < per_stripe; ++i) {
+          const uint8_t *entry = job.begin + (stripe_begin + (2 * i + 1) * stripe_size / (2 * per_stripe)) * entry_size;
+          sample.insert(sample.end(), entry, entry + entry_size);
+        }
+      }
+      const std::size_t samples = sample.size() / entry_size;
+      SortRange(&sample[0], &sample[0] + sample.size(), entry_size);
+      job.splitters.resize((job.threads - 1) * entry_size);
+      for (std::size_t b = 1; b < job.threads; ++b) {
+        std::memcpy(&job.splitters[(b - 1) * entry_size], &sample[(samples * b / job.threads) * entry_size], entry_size);
+      }
+    }
+
+    // First entry in [from, to) not less than value.
+    std::size_t LowerBound(const Job &job, std::size_t from, std::size_t to, const void *value) const {
+      while (from < to) {
+        std::size_t middle = from + (to - from) / 2;
+        if (compare_(job.begin + middle * job.entry_size, value)) {
+          from = middle + 1;
+        } else {
+          to = middle;
+        }
+      }
+      return from;
+    }
+
+    struct Head {
+      const uint8_t *current, *end;
+      std::size_t stripe;
+    };
+
+    // Inverted for a min-heap.  Ties go to the earlier stripe, which keeps the
+    // sort stable when the stripes are.
+    class HeadGreater {
+      public:
+        explicit HeadGreater(const Compare &compare) : compare_(compare) {}
+
+        bool operator()(const Head &first, const Head &second) const {
+          if (compare_(second.current, first.current)) return true;
+          if (compare_(first.current, second.current)) return false;
+          return first.stripe > second.stripe;
+        }
+
+      private:
+        const Compare &compare_;
+    };
+
+    void Merge(Job &job, std::size_t bucket, uint8_t *to) const {
+      const std::size_t entry_size = job.entry_size;
+      std::vector<Head> heap;
+      for (std::size_t s = 0; s < job.threads; ++s) {
+        Head head;
+        head.current = job.begin + job.Cut(s, bucket) * entry_size;
+        head.end = job.begin + job.Cut(s, bucket + 1) * entry_size;
+        head.stripe = s;
+        if (head.current != head.end) heap.push_back(head);
+      }
+      HeadGreater greater(compare_);
+      std::make_heap(heap.begin(), heap.end(), greater);
+      while (heap.size() > 1) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        Head &top = heap.back();
+        std::memcpy(to, top.current, entry_size);
+        to += entry_size;
+        top.current += entry_size;
+        if (top.current == top.end) {
+          heap.pop_back();
+        } else {
+          std::push_heap(heap.begin(), heap.end(), greater);
+        }
+      }
+      if (!heap.empty()) {
+        std::memcpy(to, heap.front().current, heap.front().end - heap.front().current);
+      }
+    }
+
+    void SortRange(void *begin, void *end, std::size_t entry_size) const {
+#if defined(_WIN32) || defined(_WIN64)
+      std::stable_sort
+#else
+      std::sort
+#endif
+        (SizedIt(begin, entry_size), SizedIt(end, entry_size), sized_compare_);
+    }
+
+    std::size_t threads_;
+
+    Compare compare_;
+    SizedCompare<Compare> sized_compare_;
+
+    // Copied with the worker before the first sort, so this is empty then.
+    std::vector<uint8_t> scratch_;
+};
+
+} // namespace stream
+} // namespace util
+
+#endif // UTIL_STREAM_PARALLEL_SORT_H
@@ -21,6 +21,7 @@
 #include "util/stream/chain.hh"
 #include "util/stream/config.hh"
 #include "util/stream/io.hh"
+#include "util/stream/parallel_sort.hh"
 #include "util/stream/stream.hh"
 #include "util/stream/timer.hh"
 
@@ -357,8 +358,8 @@ template <class Compare, class Combine> class OwningMergingReader : public Mergi
 // Don't use this directly.  Worker that sorts blocks.
 template <class Compare> class BlockSorter {
   public:
-    BlockSorter(Offsets &offsets, const Compare &compare) :
-      offsets_(&offsets), compare_(compare) {}
+    BlockSorter(Offsets &offsets, const Compare &compare, std::size_t threads = 1) :
+      offsets_(&offsets), sort_(threads, compare) {}
 
     void Run(const ChainPosition &position) {
       const std::size_t entry_size = position.GetChain().EntrySize();
@@ -366,21 +367,14 @@ template <class Compare> class BlockSorter {
         // Record the size of each block in a separate file.
         offsets_->Append(link->ValidSize());
         void *end = static_cast<uint8_t*>(link->Get()) + link->ValidSize();
-#if defined(_WIN32) || defined(_WIN64)
-        std::stable_sort
-#else
-        std::sort
-#endif
-          (SizedIt(link->Get(), entry_size),
-           SizedIt(end, entry_size),
-           compare_);
+        sort_(link->Get(), end, entry_size);
       }
       offsets_->FinishedAppending();
     }
 
   private:
     Offsets *offsets_;
-    SizedCompare<Compare> compare_;
+    ParallelSort<Compare> sort_;
 };
 
 class BadSortConfig : public Exception {
@@ -404,7 +398,7 @@ template <class Compare, class Combine = NeverCombine> class Sort {
       config_.buffer_size -= config_.buffer_size % entry_size_;
       UTIL_THROW_IF(!config_.buffer_size, BadSortConfig, "Sort buffer too small");
       UTIL_THROW_IF(config_.total_memory < config_.buffer_size * 4, BadSortConfig, "Sorting memory " << config_.total_memory << " is too small for four buffers (two read and two write).");
-      in >> BlockSorter<Compare>(offsets_, compare_) >> WriteAndRecycle(data_.get());
+      in >> BlockSorter<Compare>(offsets_, compare_, config_.threads) >> WriteAndRecycle(data_.get());
     }
 
     uint64_t Size() const {
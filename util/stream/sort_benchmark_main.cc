@@ -0,0 +1,107 @@
+#include "util/stream/parallel_sort.hh"
+#include "util/usage.hh"
+
+#include <boost/thread/thread.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <stdint.h>
+
+namespace util { namespace stream { namespace {
+
+// N-grams as lmplz sorts them: order words of 4 bytes then an 8-byte payload,
+// compared by their last word first like lm::SuffixOrder.
+class SuffixCompare {
+  public:
+    explicit SuffixCompare(std::size_t order) : order_(order) {}
+
+    bool operator()(const void *first_void, const void *second_void) const {
+      const uint32_t *first = static_cast<const uint32_t*>(first_void), *second = static_cast<const uint32_t*>(second_void);
+      for (std::size_t i = order_ - 1; i != static_cast<std::size_t>(-1); --i) {
+        if (first[i] != second[i]) return first[i] < second[i];
+      }
+      return false;
+    }
+
+  private:
+    std::size_t order_;
+};
+
+class XorShift {
+  public:
+    XorShift() : state_(88172645463325252ULL) {}
+
+    uint64_t Get() {
+      state_ ^= state_ << 13;
+      state_ ^= state_ >> 7;
+      state_ ^= state_ << 17;
+      return state_;
+    }
+
+  private:
+    uint64_t state_;
+};
+
+// Roughly Zipfian word ids from a vocabulary of this size, so there are
+// duplicates and popular words as in real text.
+void Fill(std::vector<uint8_t> &block, std::size_t order, uint32_t vocab) {
+  XorShift rng;
+  const std::size_t entry_size = order * 4 + 8;
+  const double log_vocab = std::log(static_cast<double>(vocab));
+  for (uint8_t *entry = &block[0]; entry + entry_size <= &block[0] + block.size(); entry += entry_size) {
+    uint32_t *words = reinterpret_cast<uint32_t*>(entry);
+    for (std::size_t i = 0; i < order; ++i) {
+      double uniform = static_cast<double>(rng.Get() >> 11) / static_cast<double>(1ULL << 53);
+      words[i] = static_cast<uint32_t>(std::exp(uniform * log_vocab)) - 1;
+    }
+    uint64_t count = rng.Get() & 0xff;
+    std::memcpy(entry + order * 4, &count, sizeof(count));
+  }
+}
+
+void Benchmark(std::size_t block_size, std::size_t max_threads) {
+  std::cout << "#order\tentry_size\tthreads\tseconds\tMB/s\tspeedup\n";
+  for (std::size_t order = 1; order <= 5; ++order) {
+    const std::size_t entry_size = order * 4 + 8;
+    const std::size_t entries = block_size / entry_size;
+    std::vector<uint8_t> original(entries * entry_size), block;
+    Fill(original, order, 1000000);
+    double single_time = 0.0;
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+      block = original;
+      ParallelSort<SuffixCompare> sort(threads, SuffixCompare(order));
+      double start = WallTime();
+      sort(&block[0], &block[0] + block.size(), entry_size);
+      double took = WallTime() - start;
+      if (threads == 1) single_time = took;
+      SuffixCompare compare(order);
+      for (const uint8_t *i = &block[entry_size]; i != &block[0] + block.size(); i += entry_size) {
+        if (compare(i, i - entry_size)) {
+          std::cerr << "Sort with " << threads << " threads is out of order" << std::endl;
+          abort();
+        }
+      }
+      std::cout << order << '\t' << entry_size << '\t' << threads << '\t' << took << '\t'
+        << (static_cast<double>(entries * entry_size) / took / 1048576.0) << '\t' << (single_time / took) << std::endl;
+    }
+  }
+}
+
+}}} // namespaces
+
+int main(int argc, char *argv[]) {
+  if (argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " [block_MB [max_threads]]\n"
+      "Sorts a block of random n-grams of each order 1 to 5 with 1, 2, 4, ...\n"
+      "threads up to max_threads, default the number of cores.\n";
+    return 1;
+  }
+  std::size_t block_mb = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 64;
+  std::size_t max_threads = argc > 2 ? std::strtoul(argv[2], NULL, 10) : boost::thread::hardware_concurrency();
+  util::stream::Benchmark(block_mb << 20, std::max<std::size_t>(1, max_threads));
+  return 0;
+}
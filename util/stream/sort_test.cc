@@ -30,7 +30,7 @@ struct Putter {
   std::vector<uint64_t> &shuffled_;
 };
 
-BOOST_AUTO_TEST_CASE(FromShuffled) {
+void SortShuffled(std::size_t chain_memory, std::size_t threads) {
   std::vector<uint64_t> shuffled;
   shuffled.reserve(kSize);
   for (uint64_t i = 0; i < kSize; ++i) {
@@ -40,13 +40,14 @@ BOOST_AUTO_TEST_CASE(FromShuffled) {
 
   ChainConfig config;
   config.entry_size = 8;
-  config.total_memory = 800;
+  config.total_memory = chain_memory;
   config.block_count = 3;
 
   SortConfig merge_config;
   merge_config.temp_prefix = "sort_test_temp";
   merge_config.buffer_size = 800;
   merge_config.total_memory = 3300;
+  merge_config.threads = threads;
 
   Chain chain(config);
   chain >> Putter(shuffled);
@@ -59,4 +60,26 @@ BOOST_AUTO_TEST_CASE(FromShuffled) {
   BOOST_CHECK(!sorted);
 }
 
+BOOST_AUTO_TEST_CASE(FromShuffled) {
+  SortShuffled(800, 1);
+}
+
+// Blocks big enough that each is sorted by four threads.
+BOOST_AUTO_TEST_CASE(FromShuffledThreads) {
+  SortShuffled(8 * 3 * 4 * 5000, 4);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDuplicates) {
+  std::vector<uint64_t> values;
+  for (uint64_t i = 0; i < kSize; ++i) {
+    values.push_back(i % 1000);
+  }
+  std::random_shuffle(values.begin(), values.end());
+  ParallelSort<CompareUInt64> sort(5);
+  sort(&values[0], &values[0] + values.size(), sizeof(uint64_t));
+  for (uint64_t i = 0; i < kSize; ++i) {
+    BOOST_REQUIRE_EQUAL(i * 1000 / kSize, values[i]);
+  }
+}
+
 }}} // namespaces
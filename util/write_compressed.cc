@@ -0,0 +1,317 @@
+#include "util/write_compressed.hh"
+
+#include "util/file.hh"
+#include "util/scoped.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTDLIB
+#include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4LIB
+#include <lz4frame.h>
+#endif
+
+namespace util {
+
+class WriteBase {
+  public:
+    virtual ~WriteBase() {}
+
+    virtual void Write(const void *data, std::size_t amount) = 0;
+
+    virtual void Finish() = 0;
+
+    uint64_t Written() const { return written_; }
+
+  protected:
+    WriteBase(int fd, std::size_t buffer_size)
+      : fd_(fd), buffer_(MallocOrThrow(buffer_size)), buffer_size_(buffer_size), written_(0) {}
+
+    uint8_t *Buffer() { return static_cast<uint8_t*>(buffer_.get()); }
+
+    std::size_t BufferSize() const { return buffer_size_; }
+
+    // Write the first amount bytes of the buffer to the file.
+    void Drain(std::size_t amount) {
+      WriteOrThrow(fd_, buffer_.get(), amount);
+      written_ += amount;
+    }
+
+    void Wrote(std::size_t amount) { written_ += amount; }
+
+    int fd_;
+
+  private:
+    scoped_malloc buffer_;
+    std::size_t buffer_size_;
+    uint64_t written_;
+};
+
+namespace {
+
+const std::size_t kOutputBuffer = 65536;
+
+class UncompressedWrite : public WriteBase {
+  public:
+    explicit UncompressedWrite(int fd) : WriteBase(fd, 1) {}
+
+    void Write(const void *data, std::size_t amount) {
+      WriteOrThrow(fd_, data, amount);
+      Wrote(amount);
+    }
+
+    void Finish() {}
+};
+
+#ifdef HAVE_ZLIB
+class GZipWrite : public WriteBase {
+  public:
+    GZipWrite(int fd, int level) : WriteBase(fd, kOutputBuffer) {
+      memset(&stream_, 0, sizeof(stream_));
+      // 16 for a gzip header rather than zlib's.  15 for maximum window size.
+      UTIL_THROW_IF(Z_OK != deflateInit2(&stream_, level ? level : Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + 15, 8, Z_DEFAULT_STRATEGY), GZException, "Failed to initialize zlib.");
+    }
+
+    ~GZipWrite() {
+      deflateEnd(&stream_);
+    }
+
+    void Write(const void *data, std::size_t amount) {
+      const Bytef *from = static_cast<const Bytef*>(data);
+      while (amount) {
+        std::size_t piece = std::min<std::size_t>(amount, std::numeric_limits<uInt>::max());
+        stream_.next_in = const_cast<Bytef*>(from);
+        stream_.avail_in = piece;
+        while (stream_.avail_in) Deflate(Z_NO_FLUSH);
+        from += piece;
+        amount -= piece;
+      }
+    }
+
+    void Finish() {
+      stream_.avail_in = 0;
+      while (Deflate(Z_FINISH) != Z_STREAM_END) {}
+    }
+
+  private:
+    int Deflate(int flush) {
+      stream_.next_out = Buffer();
+      stream_.avail_out = BufferSize();
+      int result = deflate(&stream_, flush);
+      UTIL_THROW_IF(result != Z_OK && result != Z_STREAM_END, GZException, "zlib encountered " << (stream_.msg ? stream_.msg : "an error ") << " code " << result);
+      Drain(BufferSize() - stream_.avail_out);
+      return result;
+    }
+
+    z_stream stream_;
+};
+#endif // HAVE_ZLIB
+
+#ifdef HAVE_ZSTDLIB
+class ZStdWrite : public WriteBase {
+  public:
+    ZStdWrite(int fd, int level) : WriteBase(fd, kOutputBuffer), context_(ZSTD_createCCtx()) {
+      if (!context_) throw std::bad_alloc();
+      if (level) HandleError(ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel, level));
+    }
+
+    ~ZStdWrite() {
+      ZSTD_freeCCtx(context_);
+    }
+
+    void Write(const void *data, std::size_t amount) {
+      ZSTD_inBuffer in = { data, amount, 0 };
+      while (in.pos < in.size) {
+        Compress(in, ZSTD_e_continue);
+      }
+    }
+
+    void Finish() {
+      ZSTD_inBuffer in = { NULL, 0, 0 };
+      // Returns how much is left to flush.
+      while (Compress(in, ZSTD_e_end)) {}
+    }
+
+  private:
+    std::size_t Compress(ZSTD_inBuffer &in, ZSTD_EndDirective directive) {
+      ZSTD_outBuffer out = { Buffer(), BufferSize(), 0 };
+      std::size_t ret = HandleError(ZSTD_compressStream2(context_, &out, &in, directive));
+      Drain(out.pos);
+      return ret;
+    }
+
+    std::size_t HandleError(std::size_t value) {
+      UTIL_THROW_IF(ZSTD_isError(value), ZStdException, "zstd encountered " << ZSTD_getErrorName(value));
+      return value;
+    }
+
+    ZSTD_CCtx *context_;
+};
+#endif // HAVE_ZSTDLIB
+
+#ifdef HAVE_LZ4LIB
+// LZ4F_compressUpdate needs room for the worst case, so compress this much at a time.
+const std::size_t kLZ4Chunk = 65536;
+
+LZ4F_preferences_t LZ4Preferences(int level) {
+  LZ4F_preferences_t ret;
+  memset(&ret, 0, sizeof(ret));
+  ret.compressionLevel = level;
+  return ret;
+}
+
+class LZ4Write : public WriteBase {
+  public:
+    LZ4Write(int fd, int level)
+      : WriteBase(fd, std::max<std::size_t>(LZ4F_HEADER_SIZE_MAX, LZ4F_compressBound(kLZ4Chunk, NULL))),
+        preferences_(LZ4Preferences(level)) {
+      HandleError(LZ4F_createCompressionContext(&context_, LZ4F_VERSION));
+      Drain(HandleError(LZ4F_compressBegin(context_, Buffer(), BufferSize(), &preferences_)));
+    }
+
+    ~LZ4Write() {
+      LZ4F_freeCompressionContext(context_);
+    }
+
+    void Write(const void *data, std::size_t amount) {
+      const uint8_t *from = static_cast<const uint8_t*>(data);
+      while (amount) {
+        std::size_t piece = std::min(amount, kLZ4Chunk);
+        Drain(HandleError(LZ4F_compressUpdate(context_, Buffer(), BufferSize(), from, piece, NULL)));
+        from += piece;
+        amount -= piece;
+      }
+    }
+
+    void Finish() {
+      Drain(HandleError(LZ4F_compressEnd(context_, Buffer(), BufferSize(), NULL)));
+    }
+
+  private:
+    std::size_t HandleError(std::size_t value) {
+      UTIL_THROW_IF(LZ4F_isError(value), LZ4Exception, "lz4 encountered " << LZ4F_getErrorName(value));
+      return value;
+    }
+
+    LZ4F_preferences_t preferences_;
+    LZ4F_cctx *context_;
+};
+#endif // HAVE_LZ4LIB
+
+bool EndsWith(StringPiece str, StringPiece suffix) {
+  return str.size() >= suffix.size() && str.substr(str.size() - suffix.size()) == suffix;
+}
+
+} // namespace
+
+WriteCompressed::Compression WriteCompressed::FromExtension(StringPiece name) {
+  if (EndsWith(name, ".gz")) return GZIP;
+  if (EndsWith(name, ".zst")) return ZSTD;
+  if (EndsWith(name, ".lz4")) return LZ4;
+  return NONE;
+}
+
+WriteCompressed::Compression WriteCompressed::FromName(StringPiece name) {
+  if (name == "none") return NONE;
+  if (name == "gzip") return GZIP;
+  if (name == "zstd") return ZSTD;
+  if (name == "lz4") return LZ4;
+  UTIL_THROW(CompressedException, "Unknown compression " << name << ".  Try none, gzip, zstd, or lz4.");
+}
+
+const char *WriteCompressed::Name(Compression compression) {
+  switch (compression) {
+    case GZIP: return "gzip";
+    case ZSTD: return "zstd";
+    case LZ4: return "lz4";
+    default: return "none";
+  }
+}
+
+bool WriteCompressed::Available(Compression compression) {
+  switch (compression) {
+    case NONE:
+      return true;
+    case GZIP:
+#ifdef HAVE_ZLIB
+      return true;
+#else
+      return false;
+#endif
+    case ZSTD:
+#ifdef HAVE_ZSTDLIB
+      return true;
+#else
+      return false;
+#endif
+    case LZ4:
+#ifdef HAVE_LZ4LIB
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+WriteCompressed::WriteCompressed(int fd, Compression compression, int level) : raw_amount_(0), compressed_amount_(0) {
+  UTIL_THROW_IF(!Available(compression), CompressedException, "Asked to write " << Name(compression) << " but " << Name(compression) << " support was not compiled in.");
+  switch (compression) {
+#ifdef HAVE_ZLIB
+    case GZIP:
+      internal_.reset(new GZipWrite(fd, level));
+      break;
+#endif
+#ifdef HAVE_ZSTDLIB
+    case ZSTD:
+      internal_.reset(new ZStdWrite(fd, level));
+      break;
+#endif
+#ifdef HAVE_LZ4LIB
+    case LZ4:
+      internal_.reset(new LZ4Write(fd, level));
+      break;
+#endif
+    default:
+      internal_.reset(new UncompressedWrite(fd));
+  }
+}
+
+WriteCompressed::~WriteCompressed() {
+  if (!internal_.get()) return;
+  try {
+    Finish();
+  } catch (const std::exception &e) {
+    std::cerr << "Could not finish compressed file: " << e.what() << std::endl;
+  }
+}
+
+void WriteCompressed::Write(const void *data, std::size_t amount) {
+  assert(internal_.get());
+  internal_->Write(data, amount);
+  raw_amount_ += amount;
+}
+
+void WriteCompressed::Finish() {
+  // Finish once, even if it throws.
+  scoped_ptr<WriteBase> finishing(internal_.release());
+  finishing->Finish();
+  compressed_amount_ = finishing->Written();
+}
+
+uint64_t WriteCompressed::CompressedAmount() const {
+  return internal_.get() ? internal_->Written() : compressed_amount_;
+}
+
+} // namespace util
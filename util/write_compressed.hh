@@ -0,0 +1,61 @@
+#ifndef UTIL_WRITE_COMPRESSED_H
+#define UTIL_WRITE_COMPRESSED_H
+
+#include "util/read_compressed.hh"
+#include "util/scoped.hh"
+#include "util/string_piece.hh"
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace util {
+
+class WriteBase;
+
+// Compresses to a file in a format ReadCompressed can read back.
+class WriteCompressed {
+  public:
+    enum Compression { NONE, GZIP, ZSTD, LZ4 };
+
+    // Format for a file name ending in .gz, .zst or .lz4.  NONE for anything else.
+    static Compression FromExtension(StringPiece name);
+
+    // Parses none, gzip, zstd or lz4.  Throws CompressedException if unknown.
+    static Compression FromName(StringPiece name);
+
+    static const char *Name(Compression compression);
+
+    // Was support compiled in?  NONE always is; the others depend on what was
+    // compiled in.
+    static bool Available(Compression compression);
+
+    // Does not take ownership of fd.  level 0 is the library's default.
+    // Throws CompressedException if support for compression was not compiled in.
+    WriteCompressed(int fd, Compression compression, int level = 0);
+
+    // Finishes if that hasn't been done.  Call Finish to catch errors.
+    ~WriteCompressed();
+
+    void Write(const void *data, std::size_t amount);
+
+    // End the compressed stream and write everything to the file.  Nothing
+    // more can be written.
+    void Finish();
+
+    // Bytes of input and bytes written to the file so far.
+    uint64_t RawAmount() const { return raw_amount_; }
+    uint64_t CompressedAmount() const;
+
+  private:
+    scoped_ptr<WriteBase> internal_;
+
+    uint64_t raw_amount_, compressed_amount_;
+
+    // No copying.
+    WriteCompressed(const WriteCompressed &);
+    void operator=(const WriteCompressed &);
+};
+
+} // namespace util
+
+#endif // UTIL_WRITE_COMPRESSED_H